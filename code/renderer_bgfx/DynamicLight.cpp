@@ -24,6 +24,16 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 
 namespace renderer {
 
+static vec3 ClosestPointOnBounds(const Bounds &bounds, vec3 position)
+{
+	vec3 result;
+
+	for (size_t i = 0; i < 3; i++)
+		result[i] = math::Clamped(position[i], bounds.min[i], bounds.max[i]);
+
+	return result;
+}
+
 DynamicLightManager::DynamicLightManager() : nLights_(0)
 {
 	// Calculate the smallest square POT texture size to fit the dynamic lights data.
@@ -60,29 +70,111 @@ void DynamicLightManager::add(uint32_t frameNo, const DynamicLight &light)
 	DynamicLight &l = lights_[frameNo % BGFX_NUM_BUFFER_FRAMES][nLights_++];
 	l = light;
 	l.color_radius.w *= g_cvars.dynamicLightScale.getFloat();
+	queryGrid_.built = false;
+}
+
+void DynamicLightManager::benchmark(size_t nLights, int nIterations, vec3 cameraPosition, const mat3 &cameraRotation, vec2 cameraFov) const
+{
+	assert(world::IsLoaded());
+	assert(nLights <= UINT16_MAX);
+
+	// Synthetic stress scene: lights scattered over the world bounds, every fourth light is a capsule.
+	const Bounds bounds = world::GetBounds();
+	std::vector<DynamicLight> lights(nLights);
+
+	for (size_t i = 0; i < nLights; i++)
+	{
+		DynamicLight &dl = lights[i];
+		const vec3 position(math::RandomFloat(bounds.min.x, bounds.max.x), math::RandomFloat(bounds.min.y, bounds.max.y), math::RandomFloat(bounds.min.z, bounds.max.z));
+		dl.color_radius = vec4(1, 1, 1, math::RandomFloat(100, 400));
+		dl.position_type = vec4(position, (i % 4) == 3 ? DynamicLight::Capsule : DynamicLight::Point);
+
+		if (dl.position_type.w == DynamicLight::Capsule)
+		{
+			vec3 dir(math::RandomFloat(-1, 1), math::RandomFloat(-1, 1), math::RandomFloat(-1, 1));
+			dir.normalize();
+			dl.capsuleEnd = vec4(position + dir * 256.0f, 0);
+		}
+	}
+
+	const ClusterCamera camera = createClusterCamera(cameraPosition, cameraRotation, cameraFov);
+	std::vector<uint32_t> assignedLights;
+	assignedLights.reserve(UINT16_MAX);
+	int64_t gridTime = 0, clustersTime = 0;
+	size_t nGridAssigned = 0, nClustersAssigned = 0;
+
+	for (int i = 0; i < nIterations; i++)
+	{
+		int64_t start = bx::getHPCounter();
+		assignedLights.clear();
+		assignLightsToGrid(lights.data(), nLights, &assignedLights);
+		std::sort(assignedLights.begin(), assignedLights.end());
+		gridTime += bx::getHPCounter() - start;
+		nGridAssigned = assignedLights.size();
+
+		start = bx::getHPCounter();
+		assignedLights.clear();
+		assignLightsToClusters(camera, lights.data(), nLights, &assignedLights);
+		std::sort(assignedLights.begin(), assignedLights.end());
+		clustersTime += bx::getHPCounter() - start;
+		nClustersAssigned = assignedLights.size();
+	}
+
+	const double msPerTick = 1000.0 / bx::getHPFrequency() / nIterations;
+	const size_t nClusters = DLIGHT_CLUSTER_TILES_X * DLIGHT_CLUSTER_TILES_Y * DLIGHT_CLUSTER_SLICES;
+	interface::Printf("%u lights, %d iteration(s)\n", (uint32_t)nLights, nIterations);
+	interface::Printf("world grid: %.3fms, %u assigned, %.2f lights per cell (%ux%ux%u cells)\n", gridTime * msPerTick, (uint32_t)nGridAssigned, nGridAssigned / (float)nGridCells_, gridSize_.x, gridSize_.y, gridSize_.z);
+	interface::Printf("clusters:   %.3fms, %u assigned, %.2f lights per cluster (%ux%ux%u clusters)\n", clustersTime * msPerTick, (uint32_t)nClustersAssigned, nClustersAssigned / (float)nClusters, DLIGHT_CLUSTER_TILES_X, DLIGHT_CLUSTER_TILES_Y, DLIGHT_CLUSTER_SLICES);
+
+	if (nGridAssigned + nClustersAssigned > size_t(UINT16_MAX - 2))
+	{
+		interface::PrintWarningf("Too many assigned lights to fit in the indices texture.\n");
+	}
 }
 
 void DynamicLightManager::clear()
 {
 	nLights_ = 0;
+	queryGrid_.built = false;
 }
 
 void DynamicLightManager::contribute(uint32_t frameNo, vec3 position, vec3 *color, vec3 *direction) const
 {
-	assert(color);
-	assert(direction);
-	const float DLIGHT_AT_RADIUS = 16; // at the edge of a dlight's influence, this amount of light will be added
-	const float DLIGHT_MINIMUM_RADIUS = 16; // never calculate a range less than this to prevent huge light numbers
+	contribute(frameNo, &position, 1, color, direction);
+}
+
+void DynamicLightManager::contribute(uint32_t frameNo, const vec3 *positions, size_t nPositions, vec3 *colors, vec3 *directions) const
+{
+	assert(positions || nPositions == 0);
+	assert(colors);
+	assert(directions);
 
-	for (uint8_t i = 0; i < nLights_; i++)
+	if (nLights_ == 0)
+		return;
+
+	const DynamicLight *lights = lights_[frameNo % BGFX_NUM_BUFFER_FRAMES];
+
+	if (!isQueryGridValid(frameNo))
 	{
-		const DynamicLight &dl = lights_[frameNo % BGFX_NUM_BUFFER_FRAMES][i];
-		vec3 dir = dl.position_type.xyz() - position;
-		float d = dir.normalize();
-		float power = std::min(DLIGHT_AT_RADIUS * (dl.color_radius.a * dl.color_radius.a), DLIGHT_MINIMUM_RADIUS);
-		d = power / (d * d);
-		*color += util::ToGamma(dl.color_radius).rgb() * d;
-		*direction += dir * d;
+		for (size_t i = 0; i < nPositions; i++)
+		{
+			for (uint16_t j = 0; j < nLights_; j++)
+				contributeLight(lights[j], positions[i], &colors[i], &directions[i]);
+		}
+
+		return;
+	}
+
+	// Only visit the lights in each position's cell.
+	for (size_t i = 0; i < nPositions; i++)
+	{
+		if (!queryGrid_.bounds.intersectPoint(positions[i]))
+			continue;
+
+		const size_t cellIndex = queryCellIndex(queryCellFromPosition(positions[i]));
+
+		for (uint32_t j = queryGrid_.cellOffsets[cellIndex]; j < queryGrid_.cellOffsets[cellIndex + 1]; j++)
+			contributeLight(lights[queryGrid_.lightIndices[j]], positions[i], &colors[i], &directions[i]);
 	}
 }
 
@@ -101,9 +193,11 @@ void DynamicLightManager::initializeGrid()
 
 	interface::Printf("dlight grid size is %ux%ux%u\n", gridSize_.x, gridSize_.y, gridSize_.z);
 	gridOffset_ = vec3::empty - world::GetBounds().min;
+	nGridCells_ = (size_t)gridSize_.x * (size_t)gridSize_.y * (size_t)gridSize_.z;
 
-	// Cells texture.
-	cellsTextureSize_ = util::CalculateSmallestPowerOfTwoTextureSize((int)gridSize_.x * (int)gridSize_.y * (int)gridSize_.z);
+	// Cells texture. The view space clusters are stored after the world grid cells.
+	const size_t nClusterCells = DLIGHT_CLUSTER_TILES_X * DLIGHT_CLUSTER_TILES_Y * DLIGHT_CLUSTER_SLICES;
+	cellsTextureSize_ = util::CalculateSmallestPowerOfTwoTextureSize(int(nGridCells_ + nClusterCells));
 	interface::Printf("dlight cells texture size is %ux%u\n", cellsTextureSize_, cellsTextureSize_);
 	cellsTexture_ = bgfx::createTexture2D(cellsTextureSize_, cellsTextureSize_, false, 1, bgfx::TextureFormat::R16U, BGFX_SAMPLER_U_CLAMP | BGFX_SAMPLER_V_CLAMP | BGFX_SAMPLER_MIN_POINT | BGFX_SAMPLER_MAG_POINT);
 
@@ -112,10 +206,10 @@ void DynamicLightManager::initializeGrid()
 		cellsTextureData_[i].resize(cellsTextureSize_ * cellsTextureSize_);
 	}
 
-	// Indices textures.
-	indicesTextureSize_ = 512;
+	// Indices textures. Cells store 16-bit offsets, so anything past 256x256 can't be addressed.
+	indicesTextureSize_ = 256;
 	interface::Printf("dlight indices texture size is %ux%u\n", indicesTextureSize_, indicesTextureSize_);
-	indicesTexture_ = bgfx::createTexture2D(indicesTextureSize_, indicesTextureSize_, false, 1, bgfx::TextureFormat::R8U, BGFX_SAMPLER_U_CLAMP | BGFX_SAMPLER_V_CLAMP | BGFX_SAMPLER_MIN_POINT | BGFX_SAMPLER_MAG_POINT);
+	indicesTexture_ = bgfx::createTexture2D(indicesTextureSize_, indicesTextureSize_, false, 1, bgfx::TextureFormat::R16U, BGFX_SAMPLER_U_CLAMP | BGFX_SAMPLER_V_CLAMP | BGFX_SAMPLER_MIN_POINT | BGFX_SAMPLER_MAG_POINT);
 
 	for (int i = 0; i < BGFX_NUM_BUFFER_FRAMES; i++)
 	{
@@ -125,7 +219,125 @@ void DynamicLightManager::initializeGrid()
 	assignedLights_.reserve(512); // Arbitrary initial size.
 }
 
-void DynamicLightManager::updateTextures(uint32_t frameNo)
+bool DynamicLightManager::touchesBounds(uint32_t frameNo, const Bounds &bounds) const
+{
+	return anyLight(frameNo, bounds, [&](const DynamicLight &dl)
+	{
+		// Capsule lights use the closest point on the segment, refined once against the bounds.
+		vec3 comparePosition = dl.position_type.xyz();
+
+		if (dl.position_type.w == DynamicLight::Capsule)
+		{
+			comparePosition = math::ClosestPointOnLineSegment(dl.position_type.xyz(), dl.capsuleEnd.xyz(), bounds.midpoint());
+			comparePosition = math::ClosestPointOnLineSegment(dl.position_type.xyz(), dl.capsuleEnd.xyz(), ClosestPointOnBounds(bounds, comparePosition));
+		}
+
+		return (comparePosition - ClosestPointOnBounds(bounds, comparePosition)).lengthSquared() <= dl.color_radius.w * dl.color_radius.w;
+	});
+}
+
+bool DynamicLightManager::touchesSphere(uint32_t frameNo, vec3 position, float radius) const
+{
+	return anyLight(frameNo, Bounds(position, radius), [&](const DynamicLight &dl)
+	{
+		vec3 comparePosition = dl.position_type.xyz();
+
+		if (dl.position_type.w == DynamicLight::Capsule)
+		{
+			comparePosition = math::ClosestPointOnLineSegment(dl.position_type.xyz(), dl.capsuleEnd.xyz(), position);
+		}
+
+		return vec3::distance(position, comparePosition) <= radius + dl.color_radius.w;
+	});
+}
+
+void DynamicLightManager::updateQueryGrid(uint32_t frameNo)
+{
+	PROFILE_SCOPED(DynamicLightManager::updateQueryGrid)
+	const DynamicLight *lights = lights_[frameNo % BGFX_NUM_BUFFER_FRAMES];
+	QueryGrid &grid = queryGrid_;
+	grid.built = true;
+	grid.frameNo = frameNo;
+
+	if (nLights_ == 0)
+		return;
+
+	// The sphere AABB of each light. For capsules, use the start and end positions.
+	auto calculateLightBounds = [](const DynamicLight &dl)
+	{
+		Bounds bounds(dl.position_type.xyz(), dl.color_radius.w);
+
+		if (dl.position_type.w == DynamicLight::Capsule)
+		{
+			bounds = Bounds::merge(bounds, Bounds(dl.capsuleEnd.xyz(), dl.color_radius.w));
+		}
+
+		return bounds;
+	};
+
+	grid.bounds.setupForAddingPoints();
+
+	for (uint16_t i = 0; i < nLights_; i++)
+	{
+		grid.bounds.addPoints(calculateLightBounds(lights[i]));
+	}
+
+	// Cells are at least minCellSize units, with at most maxGridSize cells on each axis.
+	const float minCellSize = 128;
+	const int maxGridSize = 16;
+	const vec3 size = grid.bounds.toSize();
+
+	for (size_t i = 0; i < 3; i++)
+	{
+		grid.size[i] = math::Clamped((int)std::ceil(size[i] / minCellSize), 1, maxGridSize);
+		grid.cellSize[i] = std::max(1.0f, size[i] / grid.size[i]);
+	}
+
+	// Count the lights in each cell, turn the counts into offsets, then write the light indices.
+	const size_t nCells = (size_t)grid.size.x * (size_t)grid.size.y * (size_t)grid.size.z;
+	grid.cellOffsets.assign(nCells + 1, 0);
+
+	for (int pass = 0; pass < 2; pass++)
+	{
+		for (uint16_t i = 0; i < nLights_; i++)
+		{
+			const Bounds bounds = calculateLightBounds(lights[i]);
+			const vec3i min = queryCellFromPosition(bounds.min);
+			const vec3i max = queryCellFromPosition(bounds.max);
+
+			for (int z = min.z; z <= max.z; z++)
+			{
+				for (int y = min.y; y <= max.y; y++)
+				{
+					for (int x = min.x; x <= max.x; x++)
+					{
+						const size_t cellIndex = queryCellIndex(vec3i(x, y, z));
+
+						if (pass == 0)
+						{
+							grid.cellOffsets[cellIndex + 1]++;
+						}
+						else
+						{
+							grid.lightIndices[grid.cellCursors[cellIndex]++] = i;
+						}
+					}
+				}
+			}
+		}
+
+		if (pass == 0)
+		{
+			for (size_t i = 1; i <= nCells; i++)
+				grid.cellOffsets[i] += grid.cellOffsets[i - 1];
+
+			grid.lightIndices.resize(grid.cellOffsets[nCells]);
+			grid.cellCursors.assign(grid.cellOffsets.begin(), grid.cellOffsets.end() - 1);
+		}
+	}
+}
+
+void DynamicLightManager::updateTextures(uint32_t frameNo, vec3 cameraPosition, const mat3 &cameraRotation, vec2 cameraFov)
 {
 	assert(world::IsLoaded());
 	PROFILE_SCOPED(DynamicLightManager::updateTextures)
@@ -134,11 +346,110 @@ void DynamicLightManager::updateTextures(uint32_t frameNo)
 	// Assign lights to cells.
 	PROFILE_BEGIN(AssignLights)
 	assignedLights_.clear();
+	assignLightsToGrid(lights_[buffer], nLights_, &assignedLights_);
+	clustersEnabled_ = g_cvars.dynamicLightClusters.getBool();
+
+	if (clustersEnabled_)
+	{
+		clusterCamera_ = createClusterCamera(cameraPosition, cameraRotation, cameraFov);
+		assignLightsToClusters(clusterCamera_, lights_[buffer], nLights_, &assignedLights_);
+	}
+	PROFILE_END // AssignLights
+
+	// Sort the assigned lights.
+	std::sort(assignedLights_.begin(), assignedLights_.end());
+
+	// Fill cells and indices texture data.
+	// Make sure the first index uses num 0, so all empty cells can use it.
+	memset(cellsTextureData_[buffer].data(), 0, cellsTextureData_[buffer].size() * sizeof(uint16_t));
+	uint16_t indicesOffset = 0;
+	indicesTextureData_[buffer][indicesOffset++] = 0; // Empty cells will point here.
+	size_t currentCellIndex = 0;
+	uint16_t indicesNumLightsOffset = 0;
+
+	for (size_t i = 0; i < assignedLights_.size(); i++)
+	{
+		size_t cellIndex;
+		uint16_t lightIndex;
+		decodeAssignedLight(assignedLights_[i], &cellIndex, &lightIndex);
+
+		// First cell, or cell index has changed?
+		if (i == 0 || cellIndex != currentCellIndex)
+		{
+			currentCellIndex = cellIndex;
+
+			// Point the cell to the indices.
+			cellsTextureData_[buffer][cellIndex] = indicesOffset;
+
+			// Store the offset in the indices texture where we want to write number of lights to.
+			indicesNumLightsOffset = indicesOffset;
+
+			// Initialize num lights to 0.
+			indicesTextureData_[buffer][indicesNumLightsOffset] = 0;
+			indicesOffset++;
+		}
+
+		// Increment num lights.
+		indicesTextureData_[buffer][indicesNumLightsOffset]++;
+
+		// Write the light index.
+		indicesTextureData_[buffer][indicesOffset++] = lightIndex;
+
+		if (indicesOffset > uint16_t(UINT16_MAX - 2))
+		{
+			interface::PrintWarningf("Too many assigned lights.\n");
+			break;
+		}
+	}
+
+	// Update the cells texture.
+	bgfx::updateTexture2D(cellsTexture_, 0, 0, 0, 0, cellsTextureSize_, cellsTextureSize_, bgfx::makeRef(cellsTextureData_[buffer].data(), uint32_t(cellsTextureData_[buffer].size() * sizeof(uint16_t))));
+
+	// Update the indices texture.
+	if (nLights_ > 0 && indicesOffset > 0)
+	{
+		assert(indicesOffset < indicesTextureSize_ * indicesTextureSize_);
+		const uint16_t width = std::min(indicesOffset, indicesTextureSize_);
+		const uint16_t height = (uint16_t)std::ceil(indicesOffset / (float)indicesTextureSize_);
+		bgfx::updateTexture2D(indicesTexture_, 0, 0, 0, 0, width, height, bgfx::makeRef(indicesTextureData_[buffer].data(), uint32_t(width * height * sizeof(uint16_t))));
+	}
+
+	// Update the lights texture.
+	if (nLights_ > 0)
+	{
+		const uint32_t size = nLights_ * sizeof(DynamicLight);
+		const uint32_t texelSize = sizeof(float) * 4; // RGBA32F
+		const uint16_t nTexels = uint16_t(size / texelSize);
+		const uint16_t width = std::min(nTexels, lightsTextureSize_);
+		const uint16_t height = (uint16_t)std::ceil(nTexels / (float)lightsTextureSize_);
+		bgfx::updateTexture2D(lightsTexture_, 0, 0, 0, 0, width, height, bgfx::makeRef(lights_[buffer], size));
+	}
+}
+
+void DynamicLightManager::updateUniforms(Uniforms *uniforms, bool useClusters)
+{
+	assert(uniforms);
+	uniforms->dynamicLightCellSize.set(vec4((float)cellSize_.x, (float)cellSize_.y, (float)cellSize_.z, (float)cellsTextureSize_));
+	uniforms->dynamicLightGridOffset.set(gridOffset_);
+	uniforms->dynamicLightGridSize.set(vec4((float)gridSize_.x, (float)gridSize_.y, (float)gridSize_.z, 0));
+	uniforms->dynamicLight_Num_Intensity.set(vec4((float)nLights_, g_cvars.dynamicLightIntensity.getFloat(), 0, 0));
+	uniforms->dynamicLightTextureSizes_Cells_Indices_Lights.set(vec4((float)cellsTextureSize_, (float)indicesTextureSize_, (float)lightsTextureSize_, 0));
+	const ClusterCamera &c = clusterCamera_;
+	uniforms->dynamicLightClusterForward_Offset.set(vec4(c.forward, useClusters && clustersEnabled_ ? (float)nGridCells_ : 0.0f));
+	uniforms->dynamicLightClusterLeft_SliceScale.set(vec4(c.left / c.tanHalfFov.x, c.sliceScale));
+	uniforms->dynamicLightClusterOrigin_Near.set(vec4(c.position, c.zNear));
+	uniforms->dynamicLightClusterUp.set(vec4(c.up / c.tanHalfFov.y, 0));
+}
+
+void DynamicLightManager::assignLightsToGrid(const DynamicLight *lights, size_t nLights, std::vector<uint32_t> *assignedLights) const
+{
+	assert(lights || nLights == 0);
+	assert(assignedLights);
 	const float cellRadius = vec3::distance(vec3::empty, vec3((float)cellSize_.x, (float)cellSize_.y, (float)cellSize_.z)) / 2.0f;
 
-	for (uint8_t i = 0; i < nLights_; i++)
+	for (size_t i = 0; i < nLights; i++)
 	{
-		const DynamicLight &dl = lights_[buffer][i];
+		const DynamicLight &dl = lights[i];
 		vec3b min(gridSize_.x, gridSize_.y, gridSize_.z);
 		vec3b max;
 
@@ -203,107 +514,159 @@ void DynamicLightManager::updateTextures(uint32_t frameNo)
 					if (vec3::distance(cellCenter, comparePosition) > cellRadius + dl.color_radius.w)
 						continue;
 
-					assignedLights_.push_back(encodeAssignedLight(vec3b(x, y, z), i));
+					assignedLights->push_back(encodeAssignedLight(cellIndexFromCellPosition(vec3b(x, y, z)), uint16_t(i)));
 				}
 			}
 		}
 	}
-	PROFILE_END // AssignLights
-
-	// Sort the assigned lights.
-	std::sort(assignedLights_.begin(), assignedLights_.end());
+}
 
-	// Fill cells and indices texture data.
-	// Make sure the first index uses num 0, so all empty cells can use it.
-	memset(cellsTextureData_[buffer].data(), 0, cellsTextureData_[buffer].size() * sizeof(uint16_t));
-	uint16_t indicesOffset = 0;
-	indicesTextureData_[buffer][indicesOffset++] = 0; // Empty cells will point here.
-	size_t currentCellIndex = 0;
-	uint16_t indicesNumLightsOffset = 0;
+void DynamicLightManager::assignLightsToClusters(const ClusterCamera &camera, const DynamicLight *lights, size_t nLights, std::vector<uint32_t> *assignedLights) const
+{
+	assert(lights || nLights == 0);
+	assert(assignedLights);
 
-	for (size_t i = 0; i < assignedLights_.size(); i++)
+	for (size_t i = 0; i < nLights; i++)
 	{
-		vec3b cellPosition;
-		uint8_t lightIndex;
-		decodeAssignedLight(assignedLights_[i], &cellPosition, &lightIndex);
-		const size_t cellIndex = cellIndexFromCellPosition(cellPosition);
+		const DynamicLight &dl = lights[i];
+		const float radius = dl.color_radius.w;
 
-		// First cell, or cell index has changed?
-		if (i == 0 || cellIndex != currentCellIndex)
+		// Transform the light segment to view space. Point lights are a zero length segment.
+		vec3 segment[2];
+
+		for (int j = 0; j < 2; j++)
 		{
-			currentCellIndex = cellIndex;
+			const vec3 d = (j == 1 && dl.position_type.w == DynamicLight::Capsule ? dl.capsuleEnd.xyz() : dl.position_type.xyz()) - camera.position;
+			segment[j] = vec3(vec3::dotProduct(d, camera.left), vec3::dotProduct(d, camera.up), vec3::dotProduct(d, camera.forward));
+		}
 
-			// Point the cell to the indices.
-			cellsTextureData_[buffer][cellIndex] = indicesOffset;
+		Bounds bounds;
+		bounds.setupForAddingPoints();
+		bounds.addPoints(segment, 2);
+		bounds.expand(radius);
 
-			// Store the offset in the indices texture where we want to write number of lights to.
-			indicesNumLightsOffset = indicesOffset;
+		// Cull lights behind the camera or beyond the last slice.
+		if (bounds.max.z <= 0 || bounds.min.z > camera.zFar)
+			continue;
 
-			// Initialize num lights to 0.
-			indicesTextureData_[buffer][indicesNumLightsOffset] = 0;
-			indicesOffset++;
-		}
+		// Coarse culling.
+		// Slices are found from the depth range. Tiles are found by projecting the view space AABB.
+		const int minSlice = clusterSliceFromDepth(camera, bounds.min.z);
+		const int maxSlice = clusterSliceFromDepth(camera, bounds.max.z);
+		int minTile[2] = { 0, 0 };
+		int maxTile[2] = { DLIGHT_CLUSTER_TILES_X - 1, DLIGHT_CLUSTER_TILES_Y - 1 };
+
+		// Lights crossing the camera plane can touch any tile.
+		if (bounds.min.z > 1.0f)
+		{
+			bool outside = false;
 
-		// Increment num lights.
-		indicesTextureData_[buffer][indicesNumLightsOffset]++;
+			for (int j = 0; j < 2; j++)
+			{
+				const int nTiles = j == 0 ? DLIGHT_CLUSTER_TILES_X : DLIGHT_CLUSTER_TILES_Y;
+				float ndcMin = FLT_MAX, ndcMax = -FLT_MAX;
 
-		// Write the light index.
-		indicesTextureData_[buffer][indicesOffset++] = lightIndex;
+				for (float v : { bounds.min[j], bounds.max[j] })
+				{
+					for (float z : { bounds.min.z, bounds.max.z })
+					{
+						const float ndc = v / (z * camera.tanHalfFov[j]);
+						ndcMin = std::min(ndcMin, ndc);
+						ndcMax = std::max(ndcMax, ndc);
+					}
+				}
 
-		if (indicesOffset > uint16_t(UINT16_MAX - 2))
-		{
-			interface::PrintWarningf("Too many assigned lights.\n");
-			break;
+				if (ndcMax < -1 || ndcMin > 1)
+				{
+					outside = true;
+					break;
+				}
+
+				minTile[j] = math::Clamped(int((ndcMin * 0.5f + 0.5f) * nTiles), 0, nTiles - 1);
+				maxTile[j] = math::Clamped(int((ndcMax * 0.5f + 0.5f) * nTiles), 0, nTiles - 1);
+			}
+
+			if (outside)
+				continue;
 		}
-	}
 
-	// Update the cells texture.
-	bgfx::updateTexture2D(cellsTexture_, 0, 0, 0, 0, cellsTextureSize_, cellsTextureSize_, bgfx::makeRef(cellsTextureData_[buffer].data(), uint32_t(cellsTextureData_[buffer].size() * sizeof(uint16_t))));
+		for (int slice = minSlice; slice <= maxSlice; slice++)
+		{
+			for (int y = minTile[1]; y <= maxTile[1]; y++)
+			{
+				for (int x = minTile[0]; x <= maxTile[0]; x++)
+				{
+					// Finer grained culling.
+					// Point lights test the sphere against the cluster AABB.
+					// Capsule lights use the closest point on the segment, refined once against the AABB.
+					const Bounds clusterBounds = calculateClusterBounds(camera, x, y, slice);
+					vec3 comparePosition = segment[0];
 
-	// Update the indices texture.
-	if (nLights_ > 0 && indicesOffset > 0)
-	{
-		assert(indicesOffset < indicesTextureSize_ * indicesTextureSize_);
-		const uint16_t width = std::min(indicesOffset, indicesTextureSize_);
-		const uint16_t height = (uint16_t)std::ceil(indicesOffset / (float)indicesTextureSize_);
-		bgfx::updateTexture2D(indicesTexture_, 0, 0, 0, 0, width, height, bgfx::makeRef(indicesTextureData_[buffer].data(), indicesOffset));
+					if (dl.position_type.w == DynamicLight::Capsule)
+					{
+						comparePosition = math::ClosestPointOnLineSegment(segment[0], segment[1], clusterBounds.midpoint());
+						comparePosition = math::ClosestPointOnLineSegment(segment[0], segment[1], ClosestPointOnBounds(clusterBounds, comparePosition));
+					}
+
+					if ((comparePosition - ClosestPointOnBounds(clusterBounds, comparePosition)).lengthSquared() > radius * radius)
+						continue;
+
+					const size_t clusterIndex = x + y * DLIGHT_CLUSTER_TILES_X + slice * DLIGHT_CLUSTER_TILES_X * DLIGHT_CLUSTER_TILES_Y;
+					assignedLights->push_back(encodeAssignedLight(nGridCells_ + clusterIndex, uint16_t(i)));
+				}
+			}
+		}
 	}
+}
 
-	// Update the lights texture.
-	if (nLights_ > 0)
+Bounds DynamicLightManager::calculateClusterBounds(const ClusterCamera &camera, int tileX, int tileY, int slice) const
+{
+	// The first slice extends to the camera, the last slice extends to z far.
+	const float z[2] = { slice == 0 ? 0.0f : camera.zNear * std::exp(slice / camera.sliceScale), slice == DLIGHT_CLUSTER_SLICES - 1 ? camera.zFar : camera.zNear * std::exp((slice + 1) / camera.sliceScale) };
+	const int tile[2] = { tileX, tileY };
+	const int nTiles[2] = { DLIGHT_CLUSTER_TILES_X, DLIGHT_CLUSTER_TILES_Y };
+	Bounds bounds;
+	bounds.min.z = z[0];
+	bounds.max.z = z[1];
+
+	// The view space extents are linear in depth, so the AABB is found at the near and far depths.
+	for (int i = 0; i < 2; i++)
 	{
-		const uint32_t size = nLights_ * sizeof(DynamicLight);
-		const uint32_t texelSize = sizeof(float) * 4; // RGBA32F
-		const uint16_t nTexels = uint16_t(size / texelSize);
-		const uint16_t width = std::min(nTexels, lightsTextureSize_);
-		const uint16_t height = (uint16_t)std::ceil(nTexels / (float)lightsTextureSize_);
-		bgfx::updateTexture2D(lightsTexture_, 0, 0, 0, 0, width, height, bgfx::makeRef(lights_[buffer], size));
+		const float ndcMin = -1.0f + 2.0f * tile[i] / nTiles[i];
+		const float ndcMax = -1.0f + 2.0f * (tile[i] + 1) / nTiles[i];
+		bounds.min[i] = std::min(ndcMin * z[0], ndcMin * z[1]) * camera.tanHalfFov[i];
+		bounds.max[i] = std::max(ndcMax * z[0], ndcMax * z[1]) * camera.tanHalfFov[i];
 	}
+
+	return bounds;
 }
 
-void DynamicLightManager::updateUniforms(Uniforms *uniforms)
+DynamicLightManager::ClusterCamera DynamicLightManager::createClusterCamera(vec3 position, const mat3 &rotation, vec2 fov) const
 {
-	assert(uniforms);
-	uniforms->dynamicLightCellSize.set(vec4((float)cellSize_.x, (float)cellSize_.y, (float)cellSize_.z, (float)cellsTextureSize_));
-	uniforms->dynamicLightGridOffset.set(gridOffset_);
-	uniforms->dynamicLightGridSize.set(vec4((float)gridSize_.x, (float)gridSize_.y, (float)gridSize_.z, 0));
-	uniforms->dynamicLight_Num_Intensity.set(vec4((float)nLights_, g_cvars.dynamicLightIntensity.getFloat(), 0, 0));
-	uniforms->dynamicLightTextureSizes_Cells_Indices_Lights.set(vec4((float)cellsTextureSize_, (float)indicesTextureSize_, (float)lightsTextureSize_, 0));
+	ClusterCamera camera;
+	camera.position = position;
+	camera.forward = rotation[0];
+	camera.left = rotation[1];
+	camera.up = rotation[2];
+	camera.tanHalfFov = vec2(std::tan(DEG2RAD(fov.x) / 2.0f), std::tan(DEG2RAD(fov.y) / 2.0f));
+	camera.zNear = 16; // Everything closer is in the first slice.
+	camera.zFar = std::max(camera.zNear * 2.0f, world::GetBounds().calculateFarthestCornerDistance(position));
+	camera.sliceScale = DLIGHT_CLUSTER_SLICES / std::log(camera.zFar / camera.zNear);
+	return camera;
 }
 
-void DynamicLightManager::decodeAssignedLight(uint32_t value, vec3b *cellPosition, uint8_t *lightIndex) const
+void DynamicLightManager::decodeAssignedLight(uint32_t value, size_t *cellIndex, uint16_t *lightIndex) const
 {
-	assert(cellPosition);
+	assert(cellIndex);
 	assert(lightIndex);
-	cellPosition->x = (value >> 24) & 0xff;
-	cellPosition->y = (value >> 16) & 0xff;
-	cellPosition->z = (value >> 8) & 0xff;
-	*lightIndex = value & 0xff;
+	*cellIndex = value >> 16;
+	*lightIndex = value & 0xffff;
 }
 
-uint32_t DynamicLightManager::encodeAssignedLight(vec3b cellPosition, uint8_t lightIndex) const
+uint32_t DynamicLightManager::encodeAssignedLight(size_t cellIndex, uint16_t lightIndex) const
 {
-	return (cellPosition.x << 24) + (cellPosition.y << 16) + (cellPosition.z << 8) + lightIndex;
+	assert(cellIndex <= UINT16_MAX);
+	return (uint32_t(cellIndex) << 16) + lightIndex;
 }
 
 size_t DynamicLightManager::cellIndexFromCellPosition(vec3b position) const
@@ -321,4 +684,89 @@ vec3b DynamicLightManager::cellPositionFromWorldspacePosition(vec3 position) con
 	return cellPosition;
 }
 
+int DynamicLightManager::clusterSliceFromDepth(const ClusterCamera &camera, float z) const
+{
+	return math::Clamped(int(std::log(std::max(z, camera.zNear) / camera.zNear) * camera.sliceScale), 0, DLIGHT_CLUSTER_SLICES - 1);
+}
+
+template<typename Test>
+bool DynamicLightManager::anyLight(uint32_t frameNo, const Bounds &bounds, Test test) const
+{
+	if (nLights_ == 0)
+		return false;
+
+	const DynamicLight *lights = lights_[frameNo % BGFX_NUM_BUFFER_FRAMES];
+
+	if (!isQueryGridValid(frameNo))
+	{
+		for (uint16_t i = 0; i < nLights_; i++)
+		{
+			if (test(lights[i]))
+				return true;
+		}
+
+		return false;
+	}
+
+	// Only visit the lights in the cells the bounds overlap.
+	if (!Bounds::intersect(queryGrid_.bounds, bounds))
+		return false;
+
+	const vec3i min = queryCellFromPosition(bounds.min);
+	const vec3i max = queryCellFromPosition(bounds.max);
+
+	for (int z = min.z; z <= max.z; z++)
+	{
+		for (int y = min.y; y <= max.y; y++)
+		{
+			for (int x = min.x; x <= max.x; x++)
+			{
+				const size_t cellIndex = queryCellIndex(vec3i(x, y, z));
+
+				for (uint32_t i = queryGrid_.cellOffsets[cellIndex]; i < queryGrid_.cellOffsets[cellIndex + 1]; i++)
+				{
+					if (test(lights[queryGrid_.lightIndices[i]]))
+						return true;
+				}
+			}
+		}
+	}
+
+	return false;
+}
+
+void DynamicLightManager::contributeLight(const DynamicLight &light, vec3 position, vec3 *color, vec3 *direction)
+{
+	const float DLIGHT_AT_RADIUS = 16; // at the edge of a dlight's influence, this amount of light will be added
+	const float DLIGHT_MINIMUM_RADIUS = 16; // never calculate a range less than this to prevent huge light numbers
+
+	vec3 dir = light.position_type.xyz() - position;
+	float d = dir.normalize();
+
+	// Only lights that reach the position contribute, so the result doesn't depend on the query grid.
+	if (d > light.color_radius.w)
+		return;
+
+	float power = std::min(DLIGHT_AT_RADIUS * (light.color_radius.a * light.color_radius.a), DLIGHT_MINIMUM_RADIUS);
+	d = power / (d * d);
+	*color += util::ToGamma(light.color_radius).rgb() * d;
+	*direction += dir * d;
+}
+
+bool DynamicLightManager::isQueryGridValid(uint32_t frameNo) const
+{
+	return queryGrid_.built && queryGrid_.frameNo == frameNo;
+}
+
+vec3i DynamicLightManager::queryCellFromPosition(vec3 position) const
+{
+	const vec3 local = position - queryGrid_.bounds.min;
+	vec3i cell;
+
+	for (size_t i = 0; i < 3; i++)
+		cell[i] = math::Clamped(int(local[i] / queryGrid_.cellSize[i]), 0, queryGrid_.size[i] - 1);
+
+	return cell;
+}
+
 } // namespace renderer
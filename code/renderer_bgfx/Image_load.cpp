@@ -22,6 +22,18 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 #include "Precompiled.h"
 #pragma hdrstop
 
+#include "bimg/bimg.h"
+#include "bx/hash.h"
+#include "bx/readerwriter.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define USE_SSE2_MIPMAPS 1
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define USE_NEON_MIPMAPS 1
+#include <arm_neon.h>
+#endif
+
 namespace renderer {
 
 #define STB_IMAGE_IMPLEMENTATION
@@ -35,7 +47,8 @@ static void Stbi_ReleaseImage(void *data, void *userData)
 	stbi_image_free(data);
 }
 
-static void Stbi_LoadImage(const char *filename, const uint8_t *fileBuffer, size_t fileLength, Image *image)
+/// @return nullptr on success, otherwise the reason the image failed to load.
+static const char *Stbi_LoadImage(const uint8_t *fileBuffer, size_t fileLength, Image *image)
 {
 	assert(fileBuffer);
 	assert(image);
@@ -46,21 +59,20 @@ static void Stbi_LoadImage(const char *filename, const uint8_t *fileBuffer, size
 	image->data = stbi_load_from_memory(fileBuffer, (int)fileLength, &width, &height, &nComponents, 4);
 	nComponents = 4;
 
+	// stb_image stores the failure reason in thread local storage, so this is safe to call from image load threads.
 	if (image->data == nullptr)
-	{
-		interface::Printf("Error loading image \"%s\". Reason: \"%s\"\n", filename, stbi_failure_reason());
-		return;
-	}
+		return stbi_failure_reason();
 
 	image->width = width;
 	image->height = height;
 	image->nComponents = nComponents;
 	image->release = Stbi_ReleaseImage;
+	return nullptr;
 }
 
 struct ImageHandler
 {
-	typedef void (*LoadFunction)(const char *filename, const uint8_t *fileBuffer, size_t fileLength, Image *image);
+	typedef const char *(*LoadFunction)(const uint8_t *fileBuffer, size_t fileLength, Image *image);
 
 	char extension[MAX_QPATH];
 	LoadFunction load;
@@ -97,12 +109,198 @@ static uint32_t CalculateDataSize(const Image *image)
 	return (uint32_t)memSize;
 }
 
+/// @name Mipmap generation
+/// @{
+
+/// RGBA8 2x2 box filter. Odd source dimensions drop the last row/column, and 1 pixel wide/high sources are filtered in one dimension.
+/// 
+/// bgfx::imageRgba8Downsample2x2 (bimg) was tried before, but it returns without writing anything when either source dimension is 1, leaving garbage in the smallest mips of non-square textures. It also truncates instead of rounding, which darkens each mip level.
+static void DownsampleRgba8Box(const uint8_t *src, int srcWidth, int srcHeight, uint8_t *dest)
+{
+	const int destWidth = std::max(1, srcWidth >> 1), destHeight = std::max(1, srcHeight >> 1);
+	const int srcPitch = srcWidth * 4;
+
+	for (int y = 0; y < destHeight; y++)
+	{
+		const uint8_t *row0 = &src[std::min(y * 2, srcHeight - 1) * srcPitch];
+		const uint8_t *row1 = &src[std::min(y * 2 + 1, srcHeight - 1) * srcPitch];
+		uint8_t *destRow = &dest[y * destWidth * 4];
+		int x = 0;
+
+		if (srcWidth > 1)
+		{
+#if USE_SSE2_MIPMAPS
+			// 4 source pixels -> 2 destination pixels.
+			const __m128i zero = _mm_setzero_si128();
+			const __m128i round = _mm_set1_epi16(2);
+
+			for (; x + 2 <= destWidth; x += 2)
+			{
+				const __m128i r0 = _mm_loadu_si128((const __m128i *)&row0[x * 8]);
+				const __m128i r1 = _mm_loadu_si128((const __m128i *)&row1[x * 8]);
+				const __m128i lo = _mm_add_epi16(_mm_unpacklo_epi8(r0, zero), _mm_unpacklo_epi8(r1, zero));
+				const __m128i hi = _mm_add_epi16(_mm_unpackhi_epi8(r0, zero), _mm_unpackhi_epi8(r1, zero));
+				const __m128i sum = _mm_unpacklo_epi64(_mm_add_epi16(lo, _mm_srli_si128(lo, 8)), _mm_add_epi16(hi, _mm_srli_si128(hi, 8)));
+				const __m128i avg = _mm_srli_epi16(_mm_add_epi16(sum, round), 2);
+				_mm_storel_epi64((__m128i *)&destRow[x * 4], _mm_packus_epi16(avg, avg));
+			}
+#elif USE_NEON_MIPMAPS
+			// 16 source pixels -> 8 destination pixels.
+			for (; x + 8 <= destWidth; x += 8)
+			{
+				const uint8x16x4_t r0 = vld4q_u8(&row0[x * 8]);
+				const uint8x16x4_t r1 = vld4q_u8(&row1[x * 8]);
+				uint8x8x4_t avg;
+
+				for (int c = 0; c < 4; c++)
+					avg.val[c] = vrshrn_n_u16(vaddq_u16(vpaddlq_u8(r0.val[c]), vpaddlq_u8(r1.val[c])), 2);
+
+				vst4_u8(&destRow[x * 4], avg);
+			}
+#endif
+		}
+
+		for (; x < destWidth; x++)
+		{
+			const int x0 = std::min(x * 2, srcWidth - 1) * 4, x1 = std::min(x * 2 + 1, srcWidth - 1) * 4;
+
+			for (int c = 0; c < 4; c++)
+				destRow[x * 4 + c] = uint8_t((row0[x0 + c] + row0[x1 + c] + row1[x0 + c] + row1[x1 + c] + 2) >> 2);
+		}
+	}
+}
+
+/// sRGB <-> linear conversion tables for gamma correct mipmaps. Magic statics are thread safe, so this can be used from the image load threads.
+struct GammaTables
+{
+	GammaTables()
+	{
+		for (int i = 0; i < 256; i++)
+			toLinear[i] = uint16_t(bx::round(bx::toLinear(i / 255.0f) * float(linearMax)));
+
+		for (int i = 0; i <= linearMax; i++)
+			toGamma[i] = uint8_t(bx::round(bx::toGamma(i / float(linearMax)) * 255.0f));
+	}
+
+	static const int linearMax = 4095;
+	uint16_t toLinear[256];
+	uint8_t toGamma[linearMax + 1];
+};
+
+/// As DownsampleRgba8Box, but RGB are averaged in linear space. Alpha is linear already.
+static void DownsampleRgba8BoxGamma(const uint8_t *src, int srcWidth, int srcHeight, uint8_t *dest)
+{
+	static const GammaTables tables;
+	const int destWidth = std::max(1, srcWidth >> 1), destHeight = std::max(1, srcHeight >> 1);
+	const int srcPitch = srcWidth * 4;
+
+	for (int y = 0; y < destHeight; y++)
+	{
+		const uint8_t *row0 = &src[std::min(y * 2, srcHeight - 1) * srcPitch];
+		const uint8_t *row1 = &src[std::min(y * 2 + 1, srcHeight - 1) * srcPitch];
+		uint8_t *destRow = &dest[y * destWidth * 4];
+
+		for (int x = 0; x < destWidth; x++)
+		{
+			const int x0 = std::min(x * 2, srcWidth - 1) * 4, x1 = std::min(x * 2 + 1, srcWidth - 1) * 4;
+
+			for (int c = 0; c < 3; c++)
+				destRow[x * 4 + c] = tables.toGamma[(tables.toLinear[row0[x0 + c]] + tables.toLinear[row0[x1 + c]] + tables.toLinear[row1[x0 + c]] + tables.toLinear[row1[x1 + c]] + 2) >> 2];
+
+			destRow[x * 4 + 3] = uint8_t((row0[x0 + 3] + row0[x1 + 3] + row1[x0 + 3] + row1[x1 + 3] + 2) >> 2);
+		}
+	}
+}
+
+static float CalculateAlphaCoverage(const uint8_t *data, int nPixels, float alphaRef, float alphaScale)
+{
+	int covered = 0;
+
+	for (int i = 0; i < nPixels; i++)
+	{
+		if (data[i * 4 + 3] * alphaScale > alphaRef * 255.0f)
+			covered++;
+	}
+
+	return covered / float(nPixels);
+}
+
+/// Scale the alpha of each mip so the fraction of pixels that pass the alpha test matches the top mip. Otherwise alpha tested textures (foliage, grates) get thinner and disappear in the distance.
+static void PreserveAlphaCoverage(Image *image, float alphaRef)
+{
+	const float coverage = CalculateAlphaCoverage(image->data, image->width * image->height, alphaRef, 1.0f);
+	int width = image->width, height = image->height;
+	uint8_t *mip = image->data;
+
+	for (int i = 1; i < image->nMips; i++)
+	{
+		mip += width * height * 4;
+		width = std::max(1, width >> 1);
+		height = std::max(1, height >> 1);
+
+		// Binary search for the alpha scale that gives the closest coverage.
+		float minScale = 0, maxScale = 4, scale = 1;
+
+		for (int j = 0; j < 8; j++)
+		{
+			const float mipCoverage = CalculateAlphaCoverage(mip, width * height, alphaRef, scale);
+
+			if (mipCoverage < coverage)
+				minScale = scale;
+			else if (mipCoverage > coverage)
+				maxScale = scale;
+			else
+				break;
+
+			scale = (minScale + maxScale) * 0.5f;
+		}
+
+		for (int j = 0; j < width * height; j++)
+			mip[j * 4 + 3] = uint8_t(std::min(255.0f, mip[j * 4 + 3] * scale + 0.5f));
+	}
+}
+
+static void GenerateMipmaps(Image *image, int flags)
+{
+	int width = image->width, height = image->height;
+	uint8_t *mipSource = image->data;
+
+	for (int i = 0; i < image->nMips - 1; i++)
+	{
+		uint8_t *mipDest = mipSource + (width * height * image->nComponents);
+
+		if (image->nComponents != 4 || (flags & CreateImageFlags::ResampleMipmaps))
+		{
+			stbir_resize_uint8(mipSource, width, height, 0, mipDest, std::max(1, width >> 1), std::max(1, height >> 1), 0, image->nComponents);
+		}
+		else if (flags & CreateImageFlags::GammaCorrectMipmaps)
+		{
+			DownsampleRgba8BoxGamma(mipSource, width, height, mipDest);
+		}
+		else
+		{
+			DownsampleRgba8Box(mipSource, width, height, mipDest);
+		}
+
+		mipSource = mipDest;
+		width = std::max(1, width >> 1);
+		height = std::max(1, height >> 1);
+	}
+
+	if ((flags & CreateImageFlags::PreserveAlphaCoverage) && image->nComponents == 4)
+	{
+		PreserveAlphaCoverage(image, 0.5f);
+	}
+}
+
+/// @}
+
 static void ReleaseImageData(void *data, void *userData)
 {
 	free(data);
 }
 
-static void FinalizeImage(Image *image, int flags)
+static void FinalizeImage(Image *image, int flags, int picmip)
 {
 	assert(image);
 
@@ -111,11 +309,11 @@ static void FinalizeImage(Image *image, int flags)
 		// Mipmapping: allocate new data to make rooms for the mips.
 		uint8_t *oldData = image->data;
 
-		if ((flags & CreateImageFlags::Picmip) && g_cvars.picmip.getInt() > 0)
+		if ((flags & CreateImageFlags::Picmip) && picmip > 0)
 		{
 			const int oldWidth = image->width, oldHeight = image->height;
-			image->width = std::max(1, image->width >> g_cvars.picmip.getInt());
-			image->height = std::max(1, image->height >> g_cvars.picmip.getInt());
+			image->width = std::max(1, image->width >> picmip);
+			image->height = std::max(1, image->height >> picmip);
 			image->nMips = CalculateNumMips(image->width, image->height);
 			image->dataSize = CalculateDataSize(image);
 			image->data = (uint8_t *)malloc(image->dataSize);
@@ -134,24 +332,7 @@ static void FinalizeImage(Image *image, int flags)
 			image->release(oldData, nullptr);
 		image->release = ReleaseImageData;
 
-		// Generate mips.
-		int width = image->width, height = image->height;
-		uint8_t *mipSource = image->data;
-
-		for (int i = 0; i < image->nMips - 1; i++)
-		{
-			uint8_t *mipDest = mipSource + (width * height * image->nComponents);
-
-#if 1
-			stbir_resize_uint8(mipSource, width, height, 0, mipDest, std::max(1, width >> 1), std::max(1, height >> 1), 0, image->nComponents);
-#else
-			// Causes lightshaft artifacts.
-			bgfx::imageRgba8Downsample2x2(width, height, width * image->nComponents, mipSource, mipDest);
-#endif
-			mipSource = mipDest;
-			width = std::max(1, width >> 1);
-			height = std::max(1, height >> 1);
-		}
+		GenerateMipmaps(image, flags);
 	}
 	else
 	{
@@ -167,50 +348,143 @@ Image CreateImage(int width, int height, int nComponents, uint8_t *data, int fla
 	image.height =  height;
 	image.nComponents = nComponents;
 	image.data = data;
-	FinalizeImage(&image, flags);
+	FinalizeImage(&image, flags, g_cvars.picmip.getInt());
 	return image;
 }
 
-/// Load an image from a file.
-/// 
-/// If the filename extension is supplied, but no file exists with that extension, all the other supported extensions will be tried until one exists.
-/// 
-/// If the filename extension is omitted, all supported extensions will be tried until one exists.
-/// 
-/// In either circumstance, if a file exists but the image doesn't load (e.g. the image is corrupt), other file extensions won't be tried.
-Image LoadImage(const char *filename, int flags)
+/// @name Processed image cache
+/// Decoded and mipmapped images are saved as KTX files, so they don't have to be processed again the next time they're loaded.
+/// @{
+
+static const char *imageCacheDirectory = "imagecache";
+
+/// Bump this whenever the cache file format or the mipmap generator changes, so stale cached images aren't loaded.
+/// @remarks Version 1 was unversioned, with mipmaps generated by stb_image_resize.
+static const int imageCacheVersion = 2;
+
+static int CalculateImageCachePicmip(int flags, int picmip)
 {
-	Image image;
+	return ((flags & CreateImageFlags::GenerateMipmaps) && (flags & CreateImageFlags::Picmip)) ? picmip : 0;
+}
 
-	// Calculate the filename extension to determine which image handler to try first.
-	const char *extension = util::GetExtension(filename);
+/// The cache filename is keyed by the cache version, the source filename, the source file contents, picmip and the image flags.
+static void CalculateImageCacheFilename(ImageFile *imageFile, int flags, int picmip)
+{
+	char lowerFilename[MAX_QPATH];
+	util::Strncpyz(lowerFilename, imageFile->filename, sizeof(lowerFilename));
+	util::ToLowerCase(lowerFilename);
+	const uint32_t filenameHash = bx::hash<bx::HashMurmur2A>(lowerFilename);
+	const uint32_t contentHash = bx::hash<bx::HashMurmur2A>(imageFile->data.data(), (uint32_t)imageFile->data.size());
+	util::Sprintf(imageFile->cacheFilename, sizeof(imageFile->cacheFilename), "%s/v%d_%08x%08x_%d_%d.ktx", imageCacheDirectory, imageCacheVersion, filenameHash, contentHash, CalculateImageCachePicmip(flags, picmip), flags);
+}
 
-	// Try the image handler that corresponds to the filename extension.
-	const ImageHandler *triedHandler = nullptr;
+/// @return false if the cached image is corrupt or doesn't match the image flags.
+static bool ParseCachedImage(const std::vector<uint8_t> &cacheData, int flags, Image *image)
+{
+	bimg::ImageContainer container;
+	bx::Error error;
+
+	if (!bimg::imageParse(container, cacheData.data(), (uint32_t)cacheData.size(), &error))
+		return false;
+
+	if (container.m_format != bimg::TextureFormat::RGBA8 || container.m_width == 0 || container.m_height == 0 || container.m_depth > 1 || container.m_numLayers > 1 || container.m_cubeMap)
+		return false;
+
+	const int nMips = (flags & CreateImageFlags::GenerateMipmaps) ? CalculateNumMips(container.m_width, container.m_height) : 1;
+
+	if (container.m_numMips != nMips)
+		return false;
+
+	Image cached;
+	cached.width = (int)container.m_width;
+	cached.height = (int)container.m_height;
+	cached.nComponents = 4;
+	cached.nMips = nMips;
+	cached.dataSize = CalculateDataSize(&cached);
+	std::vector<bimg::ImageMip> mips(nMips);
+	uint32_t offset = 0;
+
+	// Validate all the mips before allocating anything.
+	for (int i = 0; i < nMips; i++)
+	{
+		if (!bimg::imageGetRawData(container, 0, (uint8_t)i, cacheData.data(), (uint32_t)cacheData.size(), mips[i]))
+			return false;
+
+		const uint32_t expectedSize = std::max(1u, container.m_width >> i) * std::max(1u, container.m_height >> i) * 4;
+
+		if (mips[i].m_size != expectedSize || mips[i].m_data + mips[i].m_size > cacheData.data() + cacheData.size())
+			return false;
+
+		offset += mips[i].m_size;
+	}
+
+	if (offset != cached.dataSize)
+		return false;
+
+	cached.data = (uint8_t *)malloc(cached.dataSize);
+	cached.release = ReleaseImageData;
+	offset = 0;
+
+	for (int i = 0; i < nMips; i++)
+	{
+		memcpy(&cached.data[offset], mips[i].m_data, mips[i].m_size);
+		offset += mips[i].m_size;
+	}
+
+	*image = cached;
+	return true;
+}
+
+static void SerializeCachedImage(const Image &image, std::vector<uint8_t> *cacheData)
+{
+	// KTX header, then each mip prefixed by its size.
+	cacheData->resize(64 + image.nMips * sizeof(uint32_t) + image.dataSize);
+	bx::StaticMemoryBlockWriter writer(cacheData->data(), (uint32_t)cacheData->size());
+	bx::Error error;
+	bimg::imageWriteKtx(&writer, bimg::TextureFormat::RGBA8, false, image.width, image.height, 0, (uint8_t)image.nMips, 0, false, image.data, &error);
+
+	if (!error.isOk())
+		cacheData->clear();
+}
+
+/// @}
+
+static const ImageHandler *FindImageHandler(const char *filename)
+{
+	const char *extension = util::GetExtension(filename);
 
 	for (size_t i = 0; i < nImageHandlers; i++)
 	{
-		const ImageHandler *handler = &imageHandlers[i];
+		if (!util::Stricmp(imageHandlers[i].extension, extension))
+			return &imageHandlers[i];
+	}
 
-		if (!util::Stricmp(handler->extension, extension))
-		{
-			triedHandler = handler;
-			ReadOnlyFile file(filename);
+	return nullptr;
+}
 
-			if (!file.isValid())
-				break;
+static void CopyImageFile(const char *filename, const ReadOnlyFile &file, ImageFile *imageFile)
+{
+	util::Strncpyz(imageFile->filename, filename, sizeof(imageFile->filename));
+	imageFile->data.assign(file.getData(), file.getData() + file.getLength());
+}
 
-			handler->load(filename, file.getData(), file.getLength(), &image);
+static bool FindImageFile(const char *filename, ImageFile *imageFile)
+{
+	// Try the image handler that corresponds to the filename extension.
+	const ImageHandler *triedHandler = FindImageHandler(filename);
 
-			if (!image.data)
-				break;
-			
-			FinalizeImage(&image, flags);
-			return image;
+	if (triedHandler)
+	{
+		ReadOnlyFile file(filename);
+
+		if (file.isValid())
+		{
+			CopyImageFile(filename, file, imageFile);
+			return true;
 		}
 	}
 		
-	// If we got this far, either the extension was omitted, or the filename with the supplied extension doesn't exist. Either way, try loading using all/other supported extensions.
+	// If we got this far, either the extension was omitted, or the filename with the supplied extension doesn't exist. Either way, try all/other supported extensions.
 	char newFilename[MAX_QPATH];
 
 	for (size_t i = 0; i < nImageHandlers; i++)
@@ -223,22 +497,293 @@ Image LoadImage(const char *filename, int flags)
 
 		util::StripExtension(filename, newFilename, sizeof(newFilename));
 		util::Strcat(newFilename, sizeof(newFilename), util::VarArgs(".%s", handler->extension));
-
 		ReadOnlyFile file(newFilename);
 
 		if (!file.isValid())
 			continue;
 
-		handler->load(newFilename, file.getData(), file.getLength(), &image);
-			
-		if (!image.data)
-			continue;
+		CopyImageFile(newFilename, file, imageFile);
+		return true;
+	}
+
+	return false;
+}
+
+/// Find and read an image file.
+/// 
+/// If the filename extension is supplied, but no file exists with that extension, all the other supported extensions will be tried until one exists.
+/// 
+/// If the filename extension is omitted, all supported extensions will be tried until one exists.
+/// 
+/// If r_imageCache is enabled, the processed image cache file is read too. The flags are part of the cache key.
+/// 
+/// @remarks The file contents are copied, so the engine file system temp memory isn't held while the image is waiting to be decoded.
+bool ReadImageFile(const char *filename, int flags, ImageFile *imageFile)
+{
+	assert(imageFile);
+
+	if (!FindImageFile(filename, imageFile))
+		return false;
+
+	imageFile->cacheFilename[0] = 0;
+	imageFile->cacheData.clear();
+	imageFile->writeCache = false;
+
+	if (g_cvars.imageCache.getBool())
+	{
+		CalculateImageCacheFilename(imageFile, flags, g_cvars.picmip.getInt());
+		ReadOnlyFile cacheFile(imageFile->cacheFilename);
+
+		if (cacheFile.isValid())
+		{
+			imageFile->cacheData.assign(cacheFile.getData(), cacheFile.getData() + cacheFile.getLength());
+		}
+	}
+
+	return true;
+}
+
+/// Decode an image file read by ReadImageFile, and generate mipmaps if required.
+/// 
+/// If the processed image cache file was read and is valid, it's used instead. On a cache miss, a new cache file is serialized, ready for WriteImageCacheFile.
+/// 
+/// @remarks Doesn't touch the engine or console variables, so this can be called from any thread.
+/// @return nullptr on success, otherwise the reason the image failed to load.
+const char *DecodeImageFile(ImageFile *imageFile, int flags, int picmip, Image *image)
+{
+	assert(imageFile);
+	assert(image);
+
+	if (!imageFile->cacheData.empty())
+	{
+		const bool hit = ParseCachedImage(imageFile->cacheData, flags, image);
+		imageFile->cacheData = std::vector<uint8_t>();
+
+		if (hit)
+			return nullptr;
+
+		// Corrupt or out of date. Replace it.
+	}
+
+	const ImageHandler *handler = FindImageHandler(imageFile->filename);
+
+	if (!handler)
+		return "unsupported file extension";
+
+	const char *error = handler->load(imageFile->data.data(), imageFile->data.size(), image);
+
+	if (error)
+		return error;
+
+	FinalizeImage(image, flags, picmip);
+
+	if (imageFile->cacheFilename[0])
+	{
+		SerializeCachedImage(*image, &imageFile->cacheData);
+		imageFile->writeCache = !imageFile->cacheData.empty();
+	}
+
+	return nullptr;
+}
+
+/// Save the processed image cache file serialized by DecodeImageFile, if there is one.
+void WriteImageCacheFile(ImageFile *imageFile)
+{
+	assert(imageFile);
+
+	if (imageFile->writeCache)
+	{
+		interface::FS_WriteFile(imageFile->cacheFilename, imageFile->cacheData.data(), imageFile->cacheData.size());
+		imageFile->writeCache = false;
+	}
 
-		FinalizeImage(&image, flags);
+	imageFile->cacheData = std::vector<uint8_t>();
+}
+
+/// Load an image from a file.
+/// 
+/// See ReadImageFile for how the file is found.
+/// 
+/// If a file exists but the image doesn't load (e.g. the image is corrupt), other file extensions won't be tried.
+Image LoadImage(const char *filename, int flags)
+{
+	Image image;
+	ImageFile imageFile;
+
+	if (!ReadImageFile(filename, flags, &imageFile))
 		return image;
+
+	const char *error = DecodeImageFile(&imageFile, flags, g_cvars.picmip.getInt(), &image);
+
+	if (error)
+	{
+		interface::Printf("Error loading image \"%s\". Reason: \"%s\"\n", imageFile.filename, error);
 	}
 
+	WriteImageCacheFile(&imageFile);
 	return image;
 }
 
+/// Time mipmap generation with each filter for all the images in a directory, and compare the results to stb_image_resize.
+void BenchmarkMipmaps(const char *directory)
+{
+	struct Filter
+	{
+		const char *name;
+		int flags;
+		int64_t time;
+		uint64_t totalError;
+	};
+
+	Filter filters[] =
+	{
+		{ "stb", CreateImageFlags::ResampleMipmaps, 0, 0 },
+		{ "box", 0, 0, 0 },
+		{ "gamma", CreateImageFlags::GammaCorrectMipmaps, 0, 0 },
+		{ "box+coverage", CreateImageFlags::PreserveAlphaCoverage, 0, 0 }
+	};
+
+	const size_t nFilters = sizeof(filters) / sizeof(filters[0]);
+	int nImages = 0;
+	uint64_t nPixels = 0, nMipBytes = 0;
+	std::vector<uint8_t> reference;
+
+	for (size_t i = 0; i < nImageHandlers; i++)
+	{
+		int nFiles = 0;
+		char **files = interface::FS_ListFiles(directory, util::VarArgs(".%s", imageHandlers[i].extension), &nFiles);
+
+		for (int j = 0; j < nFiles; j++)
+		{
+			ImageFile imageFile;
+
+			if (!ReadImageFile(util::VarArgs("%s/%s", directory, files[j]), 0, &imageFile))
+				continue;
+
+			Image source;
+
+			if (imageHandlers[i].load(imageFile.data.data(), imageFile.data.size(), &source))
+				continue;
+
+			const uint32_t sourceSize = uint32_t(source.width * source.height * 4);
+
+			for (size_t k = 0; k < nFilters; k++)
+			{
+				Image image;
+				image.width = source.width;
+				image.height = source.height;
+				image.nComponents = 4;
+				image.nMips = CalculateNumMips(image.width, image.height);
+				image.dataSize = CalculateDataSize(&image);
+				std::vector<uint8_t> data(image.dataSize);
+				memcpy(data.data(), source.data, sourceSize);
+				image.data = data.data();
+				const int64_t start = bx::getHPCounter();
+				GenerateMipmaps(&image, CreateImageFlags::GenerateMipmaps | filters[k].flags);
+				filters[k].time += bx::getHPCounter() - start;
+
+				// Compare the mips to stb_image_resize.
+				if (k == 0)
+				{
+					reference = data;
+					nMipBytes += image.dataSize - sourceSize;
+				}
+				else
+				{
+					for (uint32_t l = sourceSize; l < image.dataSize; l++)
+						filters[k].totalError += std::abs(data[l] - reference[l]);
+				}
+			}
+
+			source.release(source.data, nullptr);
+			nImages++;
+			nPixels += source.width * source.height;
+		}
+
+		interface::FS_FreeListFiles(files);
+	}
+
+	if (nImages == 0)
+	{
+		interface::Printf("No images found in %s\n", directory);
+		return;
+	}
+
+	interface::Printf("%d images, %.2f megapixels\n", nImages, nPixels / 1000000.0);
+
+	for (size_t i = 0; i < nFilters; i++)
+	{
+		const double ms = filters[i].time * 1000.0 / bx::getHPFrequency();
+		interface::Printf("%-12s %8.2fms %5.2fx", filters[i].name, ms, filters[0].time / double(std::max(int64_t(1), filters[i].time)));
+
+		if (i > 0 && nMipBytes > 0)
+			interface::Printf("   mean error vs stb %.3f", filters[i].totalError / double(nMipBytes));
+
+		interface::Printf("\n");
+	}
+}
+
+static void BuildImageCacheDirectory(const char *directory, int *nImages, int *nFailed)
+{
+	for (size_t i = 0; i < nImageHandlers; i++)
+	{
+		int nFiles = 0;
+		char **files = interface::FS_ListFiles(directory, util::VarArgs(".%s", imageHandlers[i].extension), &nFiles);
+
+		for (int j = 0; j < nFiles; j++)
+		{
+			char filename[MAX_QPATH];
+			util::Sprintf(filename, sizeof(filename), "%s/%s", directory, files[j]);
+			Image image = LoadImage(filename, CreateImageFlags::GenerateMipmaps | CreateImageFlags::Picmip);
+
+			if (image.data)
+			{
+				if (image.release)
+					image.release(image.data, nullptr);
+
+				(*nImages)++;
+			}
+			else
+			{
+				(*nFailed)++;
+			}
+		}
+
+		interface::FS_FreeListFiles(files);
+	}
+
+	// An extension of "/" lists subdirectories, both on disk and inside pk3s.
+	int nDirectories = 0;
+	char **directories = interface::FS_ListFiles(directory, "/", &nDirectories);
+
+	for (int i = 0; i < nDirectories; i++)
+	{
+		if (!directories[i][0] || !strcmp(directories[i], ".") || !strcmp(directories[i], ".."))
+			continue;
+
+		char subdirectory[MAX_QPATH];
+		util::Sprintf(subdirectory, sizeof(subdirectory), "%s/%s", directory, directories[i]);
+		BuildImageCacheDirectory(subdirectory, nImages, nFailed);
+	}
+
+	interface::FS_FreeListFiles(directories);
+}
+
+/// Process all the images in a directory and its subdirectories, saving them to the processed image cache.
+/// 
+/// Images are processed with the flags most textures use - mipmaps and picmip - and the current r_picmip.
+void BuildImageCache(const char *directory)
+{
+	if (!g_cvars.imageCache.getBool())
+	{
+		interface::Printf("r_imageCache is disabled\n");
+		return;
+	}
+
+	const int startTime = interface::GetTime();
+	int nImages = 0, nFailed = 0;
+	BuildImageCacheDirectory(directory, &nImages, &nFailed);
+	interface::Printf("%d images cached, %d failed, %.2f seconds\n", nImages, nFailed, (interface::GetTime() - startTime) / 1000.0f);
+}
+
 } // namespace renderer
@@ -25,6 +25,9 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 #define STB_IMAGE_WRITE_IMPLEMENTATION
 #include "stb_image_write.h"
 
+#include "bx/file.h"
+#include "bx/hash.h"
+
 #include "Main.h"
 
 namespace renderer {
@@ -128,6 +131,363 @@ void BgfxCallback::traceVargs(const char* _filePath, uint16_t _line, const char*
 	bx::debugOutput(out);
 }
 
+/// Write to a temp file, then rename it over the destination.
+static bool WriteFileAtomic(const std::string &path, const void *data1, uint32_t size1, const void *data2, uint32_t size2)
+{
+	const std::string tempPath = path + ".tmp";
+	bx::FileWriter writer;
+	bx::Error error;
+
+	if (!bx::open(&writer, bx::FilePath(tempPath.c_str()), false, &error))
+		return false;
+
+	bx::write(&writer, data1, (int32_t)size1, &error);
+
+	if (error.isOk() && size2 > 0)
+		bx::write(&writer, data2, (int32_t)size2, &error);
+
+	bx::close(&writer);
+
+	if (!error.isOk())
+	{
+		remove(tempPath.c_str());
+		return false;
+	}
+
+	// rename doesn't replace existing files on Windows.
+	remove(path.c_str());
+
+	if (rename(tempPath.c_str(), path.c_str()) != 0)
+	{
+		remove(tempPath.c_str());
+		return false;
+	}
+
+	return true;
+}
+
+static bool ReadFile(const std::string &path, std::vector<uint8_t> *data)
+{
+	bx::FileReader reader;
+	bx::Error error;
+
+	if (!bx::open(&reader, bx::FilePath(path.c_str()), &error))
+		return false;
+
+	const int64_t size = bx::getSize(&reader);
+
+	if (size <= 0 || size > INT32_MAX)
+	{
+		bx::close(&reader);
+		return false;
+	}
+
+	data->resize((size_t)size);
+	bx::read(&reader, data->data(), (int32_t)size, &error);
+	bx::close(&reader);
+	return error.isOk();
+}
+
+void ShaderCache::initialize(const char *directory, uint64_t maxSize)
+{
+	directory_ = directory;
+	maxSize_ = maxSize;
+	entries_.clear();
+	totalSize_ = 0;
+	useCounter_ = 0;
+	bx::Error error;
+	bx::makeAll(bx::FilePath(directory), &error);
+
+	// The index is a list of entries: id, size and last used. If it's missing or corrupt, start again. Entry files are validated on their own.
+	std::vector<uint8_t> index;
+
+	if (ReadFile(directory_ + "/index", &index) && index.size() >= sizeof(uint32_t) * 2)
+	{
+		uint32_t header[2];
+		memcpy(header, index.data(), sizeof(header));
+		const size_t entrySize = sizeof(uint64_t) + sizeof(Entry);
+
+		if (header[0] == EntryHeader::currentVersion && index.size() == sizeof(header) + header[1] * entrySize)
+		{
+			const uint8_t *p = &index[sizeof(header)];
+
+			for (uint32_t i = 0; i < header[1]; i++, p += entrySize)
+			{
+				uint64_t id;
+				Entry entry;
+				memcpy(&id, p, sizeof(id));
+				memcpy(&entry, p + sizeof(id), sizeof(entry));
+				entries_[id] = entry;
+				totalSize_ += entry.size;
+				useCounter_ = std::max(useCounter_, entry.lastUsed + 1);
+			}
+		}
+	}
+
+	enabled_ = true;
+	trim();
+}
+
+void ShaderCache::flush()
+{
+	if (enabled_ && indexDirty_)
+	{
+		writeIndex();
+	}
+}
+
+void ShaderCache::printStatistics() const
+{
+	if (!enabled_)
+	{
+		interface::Printf("Shader cache disabled\n");
+		return;
+	}
+
+	interface::Printf("Shader cache: %u hits, %u misses, %u corrupt, %u writes, %u evictions\n", nHits_, nMisses_, nCorrupt_, nWrites_, nEvictions_);
+	interface::Printf("   %u entries, %.2fMB of %.2fMB\n", (uint32_t)entries_.size(), totalSize_ / (1024.0f * 1024.0f), maxSize_ / (1024.0f * 1024.0f));
+}
+
+uint32_t ShaderCache::readSize(uint64_t id)
+{
+	if (!enabled_)
+		return 0;
+
+	if (!loadEntry(id))
+	{
+		nMisses_++;
+		return 0;
+	}
+
+	return (uint32_t)loadedData_.size();
+}
+
+bool ShaderCache::read(uint64_t id, void *data, uint32_t size)
+{
+	if (!enabled_)
+		return false;
+
+	// bgfx always calls readSize first, but load the entry again if it didn't.
+	if ((loadedId_ != id || loadedData_.empty()) && !loadEntry(id))
+	{
+		nMisses_++;
+		return false;
+	}
+
+	if (size != loadedData_.size())
+	{
+		nMisses_++;
+		return false;
+	}
+
+	memcpy(data, loadedData_.data(), size);
+	loadedData_.clear();
+	touchEntry(id, size);
+	nHits_++;
+	return true;
+}
+
+void ShaderCache::write(uint64_t id, const void *data, uint32_t size)
+{
+	if (!enabled_ || size == 0 || size > maxSize_)
+		return;
+
+	EntryHeader header;
+	header.magic = EntryHeader::currentMagic;
+	header.version = EntryHeader::currentVersion;
+	header.id = id;
+	header.size = size;
+	header.hash = bx::hash<bx::HashMurmur2A>(data, size);
+
+	if (!WriteFileAtomic(getEntryPath(id), &header, sizeof(header), data, size))
+		return;
+
+	nWrites_++;
+	touchEntry(id, size);
+	trim();
+	writeIndex();
+}
+
+std::string ShaderCache::getEntryPath(uint64_t id) const
+{
+	char filename[32];
+	bx::snprintf(filename, sizeof(filename), "/%016llx.bin", (unsigned long long)id);
+	return directory_ + filename;
+}
+
+bool ShaderCache::loadEntry(uint64_t id)
+{
+	loadedId_ = id;
+	loadedData_.clear();
+	std::vector<uint8_t> file;
+
+	if (!ReadFile(getEntryPath(id), &file))
+		return false;
+
+	EntryHeader header;
+	bool valid = file.size() >= sizeof(header);
+
+	if (valid)
+	{
+		memcpy(&header, file.data(), sizeof(header));
+		valid = header.magic == EntryHeader::currentMagic && header.version == EntryHeader::currentVersion && header.id == id && header.size == file.size() - sizeof(header) && header.hash == bx::hash<bx::HashMurmur2A>(&file[sizeof(header)], header.size);
+	}
+
+	if (!valid)
+	{
+		nCorrupt_++;
+		removeEntry(id);
+		return false;
+	}
+
+	loadedData_.assign(file.begin() + sizeof(header), file.end());
+	return true;
+}
+
+void ShaderCache::removeEntry(uint64_t id)
+{
+	remove(getEntryPath(id).c_str());
+	auto it = entries_.find(id);
+
+	if (it != entries_.end())
+	{
+		totalSize_ -= it->second.size;
+		entries_.erase(it);
+		indexDirty_ = true;
+	}
+}
+
+void ShaderCache::trim()
+{
+	while (totalSize_ > maxSize_ && !entries_.empty())
+	{
+		auto lru = entries_.begin();
+
+		for (auto it = entries_.begin(); it != entries_.end(); it++)
+		{
+			if (it->second.lastUsed < lru->second.lastUsed)
+				lru = it;
+		}
+
+		removeEntry(lru->first);
+		nEvictions_++;
+	}
+}
+
+void ShaderCache::touchEntry(uint64_t id, uint32_t size)
+{
+	// Entry files may exist without being in the index, e.g. if the index was corrupt.
+	Entry &entry = entries_[id];
+	totalSize_ = totalSize_ - entry.size + size;
+	entry.size = size;
+	entry.lastUsed = useCounter_++;
+	indexDirty_ = true;
+}
+
+void ShaderCache::writeIndex()
+{
+	std::vector<uint8_t> index;
+	const uint32_t header[] = { EntryHeader::currentVersion, (uint32_t)entries_.size() };
+	index.resize(entries_.size() * (sizeof(uint64_t) + sizeof(Entry)));
+	uint8_t *p = index.data();
+
+	for (const auto &entry : entries_)
+	{
+		memcpy(p, &entry.first, sizeof(uint64_t));
+		p += sizeof(uint64_t);
+		memcpy(p, &entry.second, sizeof(Entry));
+		p += sizeof(Entry);
+	}
+
+	WriteFileAtomic(directory_ + "/index", header, sizeof(header), index.data(), (uint32_t)index.size());
+	indexDirty_ = false;
+}
+
+void ShaderCache::runTests(const char *directory)
+{
+	int nPassed = 0, nFailed = 0;
+
+	auto check = [&](bool condition, const char *description)
+	{
+		if (condition)
+		{
+			nPassed++;
+		}
+		else
+		{
+			nFailed++;
+			interface::Printf("FAILED: %s\n", description);
+		}
+	};
+
+	bx::Error error;
+	bx::removeAll(bx::FilePath(directory), &error);
+
+	// Three entries fit in the cache, four don't.
+	const uint32_t entrySize = 1000;
+	const uint64_t maxSize = entrySize * 3 + entrySize / 2;
+	std::vector<uint8_t> data(entrySize), readData(entrySize);
+
+	for (size_t i = 0; i < data.size(); i++)
+		data[i] = uint8_t(i * 7 + 3);
+
+	{
+		BgfxCallback callback;
+		callback.shaderCache.initialize(directory, maxSize);
+		check(callback.cacheReadSize(1) == 0, "miss on an empty cache");
+		callback.cacheWrite(1, data.data(), entrySize);
+		check(callback.cacheReadSize(1) == entrySize, "size of a written entry");
+		check(callback.cacheRead(1, readData.data(), entrySize) && readData == data, "hit after writing");
+		check(callback.cacheReadSize(1) == entrySize && !callback.cacheRead(1, readData.data(), entrySize - 1), "miss when bgfx asks for the wrong size");
+		callback.cacheWrite(2, data.data(), entrySize);
+		callback.cacheWrite(3, data.data(), entrySize);
+
+		// Use entry 1 so 2 is the least recently used.
+		callback.cacheReadSize(1);
+		callback.cacheRead(1, readData.data(), entrySize);
+		callback.cacheWrite(4, data.data(), entrySize);
+		check(callback.cacheReadSize(2) == 0, "least recently used entry evicted over the size limit");
+		check(callback.cacheReadSize(1) == entrySize, "recently used entry kept over the size limit");
+		check(callback.cacheReadSize(4) == entrySize, "new entry kept over the size limit");
+		check(callback.shaderCache.nEvictions_ == 1 && callback.shaderCache.totalSize_ <= maxSize, "one eviction over the size limit");
+		std::vector<uint8_t> largeData((size_t)maxSize + 1);
+		callback.cacheWrite(5, largeData.data(), (uint32_t)largeData.size());
+		check(callback.cacheReadSize(5) == 0 && callback.shaderCache.nEvictions_ == 1, "entry larger than the cache ignored");
+		callback.shaderCache.flush();
+	}
+
+	{
+		// A new cache loads the index written by the old one.
+		BgfxCallback callback;
+		callback.shaderCache.initialize(directory, maxSize);
+		check(callback.shaderCache.entries_.size() == 3 && callback.shaderCache.entries_.count(2) == 0, "index reloaded");
+		check(callback.cacheReadSize(3) == entrySize && callback.cacheRead(3, readData.data(), entrySize) && readData == data, "hit after reloading");
+
+		// Truncate entry 1 and flip a byte in entry 3.
+		std::vector<uint8_t> file;
+		const std::string truncatedPath = callback.shaderCache.getEntryPath(1);
+		const std::string corruptPath = callback.shaderCache.getEntryPath(3);
+
+		if (ReadFile(truncatedPath, &file))
+			WriteFileAtomic(truncatedPath, file.data(), (uint32_t)file.size() - entrySize / 2, nullptr, 0);
+
+		if (ReadFile(corruptPath, &file))
+		{
+			file.back() ^= 0xff;
+			WriteFileAtomic(corruptPath, file.data(), (uint32_t)file.size(), nullptr, 0);
+		}
+
+		check(callback.cacheReadSize(1) == 0 && !callback.cacheRead(1, readData.data(), entrySize), "miss on a truncated entry");
+		check(callback.cacheReadSize(3) == 0 && !callback.cacheRead(3, readData.data(), entrySize), "miss on a corrupt entry");
+		check(callback.shaderCache.nCorrupt_ >= 2 && callback.shaderCache.entries_.count(1) == 0 && callback.shaderCache.entries_.count(3) == 0, "corrupt entries removed");
+		check(!ReadFile(truncatedPath, &file) && !ReadFile(corruptPath, &file), "corrupt entry files deleted");
+		check(callback.cacheReadSize(4) == entrySize, "hit on an intact entry next to corrupt ones");
+	}
+
+	bx::removeAll(bx::FilePath(directory), &error);
+	interface::Printf("Shader cache tests: %d passed, %d failed\n", nPassed, nFailed);
+}
+
 struct ImageWriteBuffer
 {
 	std::vector<uint8_t> *data;
@@ -339,6 +699,19 @@ DebugDraw DebugDrawFromString(const char *s)
 	return DebugDraw::None;
 }
 
+/// Classify an entity against the fog volumes and dynamic lights once per scene. Cameras after the first reuse the result.
+void ClassifyEntity(Entity *entity, vec3 position, float radius)
+{
+	assert(entity);
+
+	if (entity->classified)
+		return;
+
+	entity->fogIndex = world::IsLoaded() ? world::FindFogIndex(position, radius) : -1;
+	entity->dynamicallyLit = s_main->dlightManager->touchesSphere(s_main->frameNo, position, radius);
+	entity->classified = true;
+}
+
 void DebugPrint(const char *format, ...)
 {
 	va_list args;
@@ -356,6 +729,23 @@ void DebugPrint(const char *format, ...)
 	s_main->debugTextY++;
 }
 
+void EndRegistration()
+{
+	g_textureCache->endRegistration();
+	g_materialCache->writeBinaryCache();
+}
+
+int FindMaterialShape(uint32_t key)
+{
+	for (int i = 0; i < MaterialShapeId::Num; i++)
+	{
+		if (s_materialShapeKeys[i] == key)
+			return i;
+	}
+
+	return -1;
+}
+
 const Entity *GetCurrentEntity()
 {
 	return s_main->currentEntity;
@@ -366,11 +756,22 @@ float GetFloatTime()
 	return s_main->floatTime;
 }
 
+uint32_t GetFrameNo()
+{
+	return s_main->frameNo;
+}
+
 Transform GetMainCameraTransform()
 {
 	return s_main->mainCameraTransform;
 }
 
+const char *GetMaterialShapeName(int shape)
+{
+	assert(shape >= 0 && shape < MaterialShapeId::Num);
+	return s_materialShapeNames[shape];
+}
+
 const SunLight &GetSunLight()
 {
 	return s_main->sunLight;
@@ -381,6 +782,11 @@ bool IsCameraMirrored()
 	return s_main->isCameraMirrored;
 }
 
+bool IsCollapseStagesEnabled()
+{
+	return s_main->collapseStagesEnabled;
+}
+
 bool IsLerpTextureAnimationEnabled()
 {
 	return s_main->lerpTextureAnimationEnabled;
@@ -533,6 +939,11 @@ void SetWindowGamma()
 	window::SetGamma(g_gammaTable, g_gammaTable, g_gammaTable);
 }
 
+bool TouchesDynamicLight(const Bounds &bounds)
+{
+	return s_main->dlightManager->touchesBounds(s_main->frameNo, bounds);
+}
+
 void UploadCinematic(int w, int h, int cols, int rows, const uint8_t *data, int client, bool dirty)
 {
 	Texture *scratch = g_textureCache->getScratch(size_t(client));
@@ -40,6 +40,81 @@ enum class AntiAliasing
 	SMAA
 };
 
+/// On-disk cache of shader binaries (e.g. linked GL programs) for the bgfx cache callbacks.
+/// 
+/// Entries are stored one per file, named after the 64-bit id bgfx provides. Entry files are written to a temp file and renamed so they're never half written, and are checksummed so a corrupt file is a miss instead of a bad binary.
+/// An index file tracks entry sizes and use order, and the least recently used entries are removed to stay within the size limit.
+/// 
+/// @remarks Doesn't depend on bgfx or the engine, so it can be driven directly, independent of the backend.
+class ShaderCache
+{
+public:
+	/// @param maxSize Maximum total size of all entries, in bytes.
+	void initialize(const char *directory, uint64_t maxSize);
+
+	/// Write the index if entries have been used since it was last written.
+	void flush();
+
+	void printStatistics() const;
+
+	/// Check hits, misses, corrupt entries and eviction through the bgfx::CallbackI cache functions, using a cache in the given directory.
+	/// @remarks The directory is emptied first and removed afterwards.
+	static void runTests(const char *directory);
+
+	/// @name bgfx::CallbackI
+	/// @{
+	uint32_t readSize(uint64_t id);
+	bool read(uint64_t id, void *data, uint32_t size);
+	void write(uint64_t id, const void *data, uint32_t size);
+	/// @}
+
+private:
+	struct Entry
+	{
+		uint32_t size;
+		uint32_t lastUsed;
+	};
+
+	struct EntryHeader
+	{
+		static const uint32_t currentMagic = 0x43534742; // "BGSC"
+		static const uint32_t currentVersion = 1;
+		uint32_t magic;
+		uint32_t version;
+		uint64_t id;
+		uint32_t size;
+		uint32_t hash;
+	};
+
+	std::string getEntryPath(uint64_t id) const;
+	bool loadEntry(uint64_t id);
+	void removeEntry(uint64_t id);
+	void trim();
+	void touchEntry(uint64_t id, uint32_t size);
+	void writeIndex();
+
+	bool enabled_ = false;
+	std::string directory_;
+	uint64_t maxSize_ = 0;
+	std::map<uint64_t, Entry> entries_;
+	uint64_t totalSize_ = 0;
+	uint32_t useCounter_ = 0;
+	bool indexDirty_ = false;
+
+	/// readSize loads the entry, read copies it.
+	uint64_t loadedId_ = 0;
+	std::vector<uint8_t> loadedData_;
+
+	/// @name Statistics
+	/// @{
+	uint32_t nHits_ = 0;
+	uint32_t nMisses_ = 0;
+	uint32_t nCorrupt_ = 0;
+	uint32_t nWrites_ = 0;
+	uint32_t nEvictions_ = 0;
+	/// @}
+};
+
 struct BgfxCallback : bgfx::CallbackI
 {
 	void fatal(const char* _filePath, uint16_t _line, bgfx::Fatal::Enum _code, const char* _str) override;
@@ -47,14 +122,16 @@ struct BgfxCallback : bgfx::CallbackI
 	void profilerBegin(const char* _name, uint32_t _abgr, const char* _filePath, uint16_t _line) override {};
 	void profilerBeginLiteral(const char* _name, uint32_t _abgr, const char* _filePath, uint16_t _line) override {};
 	void profilerEnd() override {};
-	uint32_t cacheReadSize(uint64_t _id) override { return 0; }
-	bool cacheRead(uint64_t _id, void* _data, uint32_t _size) override { return false; }
-	void cacheWrite(uint64_t _id, const void* _data, uint32_t _size) override {};
+	uint32_t cacheReadSize(uint64_t _id) override { return shaderCache.readSize(_id); }
+	bool cacheRead(uint64_t _id, void* _data, uint32_t _size) override { return shaderCache.read(_id, _data, _size); }
+	void cacheWrite(uint64_t _id, const void* _data, uint32_t _size) override { shaderCache.write(_id, _data, _size); }
 	void screenShot(const char* _filePath, uint32_t _width, uint32_t _height, uint32_t _pitch, const void* _data, uint32_t _size, bool _yflip) override;
 	void captureBegin(uint32_t _width, uint32_t _height, uint32_t _pitch, bgfx::TextureFormat::Enum _format, bool _yflip) override {};
 	void captureEnd() override {};
 	void captureFrame(const void* _data, uint32_t _size) override {};
 
+	ShaderCache shaderCache;
+
 private:
 	std::vector<uint8_t> screenShotDataBuffer_;
 	std::vector<uint8_t> screenShotFileBuffer_;
@@ -72,6 +149,17 @@ enum class DebugDraw
 	SMAA
 };
 
+struct CompositeShaderProgramVariant
+{
+	enum
+	{
+		None    = 0,
+		Bloom   = 1 << 0,
+		ToneMap = 1 << 1,
+		Num     = 1 << 2
+	};
+};
+
 struct DepthShaderProgramVariant
 {
 	enum
@@ -110,6 +198,28 @@ struct GenericShaderProgramVariant
 	};
 };
 
+/// @remarks Sync with generated GenericShapeFragmentShaderVariant.
+struct GenericShapeShaderProgramVariant
+{
+	enum
+	{
+		None          = 0,
+		Bloom         = 1 << 0,
+		DynamicLights = 1 << 1,
+		Num           = 1 << 2
+	};
+};
+
+struct SMAANeighborhoodBlendingShaderProgramVariant
+{
+	enum
+	{
+		None  = 0,
+		Bloom = 1 << 0,
+		Num   = 1 << 1
+	};
+};
+
 struct TextureVariationShaderProgramVariant
 {
 	enum
@@ -125,16 +235,22 @@ struct ShaderProgramId
 {
 	enum Enum
 	{
-		Bloom,
+		BloomDownsample,
+		BloomUpsample,
 		Color,
+		Composite,
+		DeferredLight = Composite + CompositeShaderProgramVariant::Num,
 		Depth,
 		Fog = Depth + DepthShaderProgramVariant::Num,
-		GaussianBlur = Fog + FogShaderProgramVariant::Num,
+		GBuffer = Fog + FogShaderProgramVariant::Num,
 		Generic,
-		SMAABlendingWeightCalculation = Generic + GenericShaderProgramVariant::Num,
+		GenericShape = Generic + GenericShaderProgramVariant::Num, // GenericShapeShaderProgramVariant::Num programs per MaterialShapeId
+		Luminance = GenericShape + MaterialShapeId::Num * GenericShapeShaderProgramVariant::Num,
+		Sharpen,
+		SMAABlendingWeightCalculation,
 		SMAAEdgeDetection,
 		SMAANeighborhoodBlending,
-		Texture,
+		Texture = SMAANeighborhoodBlending + SMAANeighborhoodBlendingShaderProgramVariant::Num,
 		TextureColor,
 		TextureDebug,
 		TextureVariation,
@@ -142,6 +258,118 @@ struct ShaderProgramId
 	};
 };
 
+/// Render targets read and written by render graph passes.
+struct RenderGraphResourceId
+{
+	enum Enum
+	{
+		Backbuffer,
+		SceneColor,
+		AdaptedLuminance,
+		Bloom,
+
+		/// Transient resources only live within a frame. The render graph creates them, sharing textures between resources with non-overlapping lifetimes.
+		GBufferAlbedo,
+		GBufferNormal,
+		GBufferDepth,
+		SceneTemp,
+		SMAAEdges,
+		SMAABlend,
+
+		/// The final color at the dynamic resolution scale, before it's upscaled to the backbuffer.
+		SceneScaled,
+
+		Num,
+		FirstTransient = GBufferAlbedo
+	};
+};
+
+/// Render graph passes, in the order they run. The G-buffer passes are drawn by RenderCamera, the rest after the world scene is rendered.
+struct RenderGraphPassId
+{
+	enum Enum
+	{
+		GBuffer,
+		DeferredLight,
+		Luminance,
+		BloomMsaaResolve,
+		Bloom,
+		Composite,
+		SMAAEdgeDetection,
+		SMAABlendingWeightCalculation,
+		SMAANeighborhoodBlending,
+		Upscale,
+		Num
+	};
+};
+
+struct RenderGraphPass
+{
+	RenderGraphPassId::Enum id;
+
+	/// Shader program, including the variant for any effects fused into the pass. Not used by passes that draw more than one quad.
+	ShaderProgramId::Enum program;
+
+	/// @remarks RenderGraphResourceId bits.
+	uint32_t reads, writes;
+
+	/// Nothing reads what the pass writes, so it isn't drawn.
+	bool culled = false;
+};
+
+struct RenderGraph
+{
+	~RenderGraph();
+	bool isLive(RenderGraphPassId::Enum id) const;
+
+	std::vector<RenderGraphPass> passes;
+
+	/// @remarks Indexed by RenderGraphResourceId. Only transient resources are used.
+	bgfx::TextureFormat::Enum formats[RenderGraphResourceId::Num];
+	bgfx::TextureHandle resourceTextures[RenderGraphResourceId::Num];
+
+	struct TransientTexture
+	{
+		bgfx::TextureHandle handle;
+		bgfx::TextureFormat::Enum format;
+	};
+
+	/// Textures shared by transient resources. Full size.
+	std::vector<TransientTexture> textures;
+};
+
+/// r_testInlineFog renders the main camera with inline fog, then with the fog pass, reads both back and compares them.
+/// @remarks Both cameras are rendered at the start of the same world scene, so time and entities match.
+struct InlineFogTest
+{
+	~InlineFogTest()
+	{
+		for (bgfx::TextureHandle texture : readTextures)
+		{
+			if (bgfx::isValid(texture))
+				bgfx::destroy(texture);
+		}
+	}
+
+	/// Render the test cameras in the next world scene.
+	bool requested = false;
+
+	/// The test cameras are being rendered. inlineFog overrides r_inlineFog.
+	bool rendering = false;
+	bool inlineFog = false;
+
+	uint32_t nInlinedDrawCalls = 0;
+
+	/// The scene rect, converted to BGRA8. Inline fog first, then the fog pass.
+	int width = 0, height = 0;
+	FrameBuffer frameBuffers[2];
+	bgfx::TextureHandle readTextures[2] = { BGFX_INVALID_HANDLE, BGFX_INVALID_HANDLE };
+	std::vector<uint8_t> data[2];
+
+	/// The frame the read back data is available. 0 if nothing is being read.
+	uint32_t readFrameNo = 0;
+};
+
 struct Main
 {
 	/// @name Camera
@@ -156,6 +384,36 @@ struct Main
 
 	/// @}
 
+	/// @name Dynamic light statistics
+	/// Draw calls in world cameras while dynamic lights are active. Skipped draw calls don't touch any light, so they use the shader variant without dynamic lights. See r_printDynamicLightStats.
+	/// @{
+
+	struct DynamicLightStats
+	{
+		uint32_t nDrawCalls = 0, nSkippedDrawCalls = 0;
+		uint64_t nTriangles = 0, nSkippedTriangles = 0;
+	};
+
+	/// Accumulated during the current frame.
+	DynamicLightStats dlightStats;
+
+	/// The last complete frame.
+	DynamicLightStats lastDlightStats;
+
+	/// @}
+
+	/// @name Dynamic resolution
+	/// The world scene and the passes after it render to the top left of the full size targets, scaled so the frame time stays under the target. See r_dynamicResolution.
+	/// @{
+
+	/// @remarks 1 if dynamic resolution is disabled.
+	float dynamicResolutionScale = 1;
+
+	/// Moving average of the frame time in milliseconds. 0 until the first frame is measured.
+	float dynamicResolutionFrameTime = 0;
+
+	/// @}
+
 	/// @name Fonts
 	/// @{
 	static const int maxFonts = 6;
@@ -183,13 +441,58 @@ struct Main
 	/// @{
 	static const FrameBuffer defaultFb;
 	FrameBuffer depthFb;
+
+	/// Albedo, normal and depth attachments for deferred lighting. Created by the render graph.
+	FrameBuffer gBufferFb;
+
 	FrameBuffer reflectionFb;
 	FrameBuffer sceneFb;
+
+	/// Created by the render graph.
+	FrameBuffer sceneScaledFb;
+
+	/// Created by the render graph.
 	FrameBuffer sceneTempFb;
+
 	uint8_t sceneBloomAttachment;
 	uint8_t sceneDepthAttachment;
-	static const size_t nBloomFrameBuffers = 2;
+
+	/// Bloom mip chain: quarter, eighth and sixteenth size. Filtered down to the smallest, then back up to the quarter size.
+	static const size_t nBloomFrameBuffers = 3;
 	FrameBuffer bloomFb[nBloomFrameBuffers];
+
+	/// @remarks BGRA8, or a float format if HDR is enabled. Used by the scene color and bloom attachments.
+	bgfx::TextureFormat::Enum sceneColorFormat = bgfx::TextureFormat::BGRA8;
+	/// @}
+
+	/// @name HDR
+	/// Scene luminance is downsampled by 4 each pass, then blended with the previous frame's adapted luminance over time.
+	/// @{
+	static const uint16_t luminanceFbSize = 64;
+	static const size_t nLuminanceFrameBuffers = 3;
+	FrameBuffer luminanceFb[nLuminanceFrameBuffers];
+
+	/// 1x1, ping-ponged so the adapt pass can read the previous frame's adapted luminance and blend in the shader with full precision.
+	FrameBuffer adaptedLuminanceFb[2];
+
+	/// The adaptedLuminanceFb written by the latest luminance pass.
+	size_t adaptedLuminanceIndex = 0;
+
+	float lastLuminanceAdaptationTime = 0;
+
+	/// Set when the adapted luminance frame buffer is created, so the first frame doesn't blend with garbage.
+	bool resetLuminanceAdaptation = true;
+	/// @}
+
+	/// @name Inline fog test
+	/// @{
+	InlineFogTest inlineFogTest;
+	/// @}
+
+	/// @name Render graph
+	/// Built when the world is loaded from the enabled effects, so disabled effects cost nothing.
+	/// @{
+	RenderGraph renderGraph;
 	/// @}
 
 	/// @name Noise
@@ -215,6 +518,9 @@ struct Main
 	std::vector<Bounds> sceneDebugBounds;
 	std::vector<Entity> sceneEntities;
 
+	/// @remarks Scratch space for batched dynamic light queries in non-world scenes, one element per scene entity.
+	std::vector<vec3> sceneLightingPositions, sceneDynamicLightColors, sceneDynamicLightDirs;
+
 	struct Polygon
 	{
 		Material *material;
@@ -249,7 +555,7 @@ struct Main
 
 	/// @name SMAA
 	/// @{
-	FrameBuffer smaaBlendFb, smaaEdgesFb;
+	FrameBuffer smaaBlendFb, smaaEdgesFb; // created by the render graph
 	bgfx::TextureHandle smaaAreaTex = BGFX_INVALID_HANDLE;
 	bgfx::TextureHandle smaaSearchTex = BGFX_INVALID_HANDLE;
 	/// @}
@@ -275,8 +581,12 @@ struct Main
 	/// @{
 	AntiAliasing aa;
 	bool bloomEnabled;
+	bool collapseStagesEnabled;
+	bool deferredLightingEnabled;
+	bool dynamicResolutionEnabled;
 	bool extraDynamicLightsEnabled;
 	bool fastPathEnabled;
+	bool hdrEnabled;
 	bool lerpTextureAnimationEnabled;
 	bool maxAnisotropyEnabled;
 	bool softSpritesEnabled;
@@ -299,9 +609,18 @@ struct Main
 extern std::unique_ptr<Main> s_main;
 
 DebugDraw DebugDrawFromString(const char *s);
+
+/// Get a shader program, creating it if this is the first time it's been used.
+bgfx::ProgramHandle GetShaderProgram(int id);
+
 bool IsMsaa(AntiAliasing aa);
+
+/// Build the render graph passes from the enabled effects, cull unused passes, and create the transient frame buffers.
+void BuildRenderGraph();
 bgfx::ViewId PushView(const FrameBuffer &frameBuffer, uint16_t clearFlags, const mat4 &viewMatrix, const mat4 &projectionMatrix, Rect rect, int flags = 0);
-void RenderScreenSpaceQuad(const char *viewName, const FrameBuffer &frameBuffer, ShaderProgramId::Enum program, uint64_t state, uint16_t clearFlags = BGFX_CLEAR_NONE, Rect rect = Rect());
+
+/// @param texCoordScale Scales the texture coordinates, to read the part of a full size texture that was rendered to at the dynamic resolution scale.
+void RenderScreenSpaceQuad(const char *viewName, const FrameBuffer &frameBuffer, ShaderProgramId::Enum program, uint64_t state, uint16_t clearFlags = BGFX_CLEAR_NONE, Rect rect = Rect(), uint32_t blendFactor = 0, vec2 texCoordScale = vec2(1, 1));
 void SetWindowGamma();
 
 } // namespace main
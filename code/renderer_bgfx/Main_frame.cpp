@@ -78,6 +78,41 @@ bgfx::ViewId PushView(const FrameBuffer &frameBuffer, uint16_t clearFlags, const
 	return viewId;
 }
 
+/// The part of the full size targets the world scene is rendered to, at the top left. All of it if dynamic resolution is disabled.
+static Rect GetSceneRect()
+{
+	const float scale = s_main->dynamicResolutionScale;
+	return Rect(0, 0, std::max(1, int(window::GetWidth() * scale + 0.5f)), std::max(1, int(window::GetHeight() * scale + 0.5f)));
+}
+
+/// Texture coordinate scale for reading the scene rect from a full size target.
+static vec2 GetSceneTexCoordScale()
+{
+	const Rect rect = GetSceneRect();
+	return vec2(rect.w / (float)window::GetWidth(), rect.h / (float)window::GetHeight());
+}
+
+/// Bounds to clamp sample coordinates to when reading a rect at the top left of a texture. xy is the minimum, zw is the maximum.
+/// @remarks Half a texel inside the rect, so bilinear taps don't read stale texels outside it. With a bottom left origin, the rect is at the top of the texture.
+static vec4 GetTexCoordClamp(Rect rect, int width, int height)
+{
+	const float maxu = (rect.w - 0.5f) / width;
+	const float maxv = (rect.h - 0.5f) / height;
+
+	if (bgfx::getCaps()->originBottomLeft)
+		return vec4(0, 1.0f - maxv, maxu, 1);
+
+	return vec4(0, 0, maxu, maxv);
+}
+
+/// Bloom levels start at quarter size, halving each level. Each level is rendered at the dynamic resolution scale, like the scene.
+static Rect GetBloomRect(size_t level, int *width, int *height)
+{
+	*width = std::max(1, window::GetWidth() >> (2 + level));
+	*height = std::max(1, window::GetHeight() >> (2 + level));
+	return Rect(0, 0, std::max(1, int(*width * s_main->dynamicResolutionScale + 0.5f)), std::max(1, int(*height * s_main->dynamicResolutionScale + 0.5f)));
+}
+
 static void FlushStretchPics()
 {
 	if (!s_main->stretchPicIndices.empty())
@@ -96,7 +131,9 @@ static void FlushStretchPics()
 			s_main->time = interface::GetTime();
 			s_main->floatTime = s_main->time * 0.001f;
 			s_main->uniforms->dynamicLight_Num_Intensity.set(vec4::empty);
+			s_main->uniforms->fogEnabled.set(vec4::empty);
 			s_main->uniforms->renderMode.set(vec4::empty);
+			s_main->uniforms->sceneScale.set(vec4(1, 1, 0, 0));
 			s_main->matUniforms->nDeforms.set(vec4(0, 0, 0, 0));
 			s_main->matUniforms->time.set(vec4(s_main->stretchPicMaterial->setTime(s_main->floatTime), 0, 0, 0));
 
@@ -124,7 +161,7 @@ static void FlushStretchPics()
 				bgfx::setState(state);
 				bgfx::setVertexBuffer(0, &tvb);
 				bgfx::setIndexBuffer(&tib);
-				bgfx::submit(s_main->stretchPicViewId, s_main->shaderPrograms[ShaderProgramId::Generic].handle);
+				bgfx::submit(s_main->stretchPicViewId, GetShaderProgram(ShaderProgramId::Generic));
 			}
 		}
 	}
@@ -223,11 +260,11 @@ void DrawStretchRaw(int x, int y, int w, int h, int cols, int rows, const uint8_
 #ifdef _DEBUG
 	bgfx::setViewName(viewId, "StretchRaw");
 #endif
-	bgfx::submit(viewId, s_main->shaderPrograms[ShaderProgramId::TextureColor].handle);
+	bgfx::submit(viewId, GetShaderProgram(ShaderProgramId::TextureColor));
 }
 
 // From bgfx screenSpaceQuad.
-void RenderScreenSpaceQuad(const char *viewName, const FrameBuffer &frameBuffer, ShaderProgramId::Enum program, uint64_t state, uint16_t clearFlags, Rect rect)
+void RenderScreenSpaceQuad(const char *viewName, const FrameBuffer &frameBuffer, ShaderProgramId::Enum program, uint64_t state, uint16_t clearFlags, Rect rect, uint32_t blendFactor, vec2 texCoordScale)
 {
 	const uint32_t nVerts = 3;
 	if (bgfx::getAvailTransientVertexBuffer(nVerts, Vertex::layout) < nVerts)
@@ -247,18 +284,19 @@ void RenderScreenSpaceQuad(const char *viewName, const FrameBuffer &frameBuffer,
 	const float maxy = height*2.0f;
 	const float texelHalfW = s_main->halfTexelOffset / rect.w;
 	const float texelHalfH = s_main->halfTexelOffset / rect.h;
-	const float minu = -1.0f + texelHalfW;
-	const float maxu =  1.0f + texelHalfW;
+	const float minu = -texCoordScale.x + texelHalfW;
+	const float maxu =  texCoordScale.x + texelHalfW;
 	float minv = texelHalfH;
-	float maxv = 2.0f + texelHalfH;
+	float maxv = texCoordScale.y * 2.0f + texelHalfH;
 
+	// With a bottom left origin, the scaled part of the texture is at the top, v from 1 - scale to 1.
 	if (bgfx::getCaps()->originBottomLeft)
 	{
 		float temp = minv;
 		minv = maxv;
 		maxv = temp;
-		minv -= 1.0f;
-		maxv -= 1.0f;
+		minv -= texCoordScale.y * 2.0f - 1.0f;
+		maxv -= texCoordScale.y * 2.0f - 1.0f;
 	}
 
 	bgfx::TransientVertexBuffer vb;
@@ -274,14 +312,14 @@ void RenderScreenSpaceQuad(const char *viewName, const FrameBuffer &frameBuffer,
 	vertices[2].setColor(vec4::white);
 	vertices[2].texCoord = vec4(maxu, maxv, 0, 0);
 	bgfx::setVertexBuffer(0, &vb);
-	bgfx::setState(state);
+	bgfx::setState(state, blendFactor);
 	const bgfx::ViewId viewId = PushView(frameBuffer, clearFlags, mat4::identity, mat4::orthographicProjection(0, 1, 0, 1, -1, 1), rect);
 #ifdef _DEBUG
 	bgfx::setViewName(viewId, viewName);
 #else
 	BX_UNUSED(viewName);
 #endif
-	bgfx::submit(viewId, s_main->shaderPrograms[program].handle);
+	bgfx::submit(viewId, GetShaderProgram(program));
 }
 
 static void Blit(const char *viewName, bgfx::TextureHandle source, bgfx::TextureHandle dest)
@@ -295,6 +333,198 @@ static void Blit(const char *viewName, bgfx::TextureHandle source, bgfx::Texture
 #endif
 }
 
+/// Average the scene luminance into a 1x1 frame buffer, adapting to changes over time like an eye.
+static void RenderLuminance()
+{
+	// Fraction of the difference to the current luminance adapted to per second.
+	const float adaptationRate = 1.5f;
+	const float dt = s_main->floatTime - s_main->lastLuminanceAdaptationTime;
+	s_main->lastLuminanceAdaptationTime = s_main->floatTime;
+
+	// Time jumps backwards on map restarts and demo seeks.
+	if (dt < 0 || dt > 1)
+	{
+		s_main->resetLuminanceAdaptation = true;
+	}
+
+	const float adaptation = s_main->resetLuminanceAdaptation ? 1.0f : 1.0f - expf(-dt * adaptationRate);
+	s_main->resetLuminanceAdaptation = false;
+	bgfx::TextureHandle source = bgfx::getTexture(s_main->sceneFb.handle);
+	const vec2 sceneTexCoordScale = GetSceneTexCoordScale();
+	const size_t previousAdaptedIndex = s_main->adaptedLuminanceIndex;
+	s_main->adaptedLuminanceIndex = 1 - previousAdaptedIndex;
+
+	for (size_t i = 0; i <= s_main->nLuminanceFrameBuffers; i++)
+	{
+		const bool adapt = i == s_main->nLuminanceFrameBuffers;
+		const FrameBuffer &dest = adapt ? s_main->adaptedLuminanceFb[s_main->adaptedLuminanceIndex] : s_main->luminanceFb[i];
+		const uint16_t destSize = s_main->luminanceFbSize >> (i * 2);
+		vec2 texCoordScale(1, 1);
+
+		if (i == 0)
+		{
+			// Sparse taps spread over each destination texel. Only an average is needed.
+			texCoordScale = sceneTexCoordScale;
+			s_main->uniforms->luminanceTapOffset_Pass.set(vec4(0.25f * texCoordScale.x / destSize, 0.25f * texCoordScale.y / destSize, LUMINANCE_PASS_SCENE, 0));
+		}
+		else
+		{
+			// One source texel, so four bilinear taps cover the 4x4 source texels of each destination texel.
+			const float offset = 1.0f / (destSize * 4);
+			s_main->uniforms->luminanceTapOffset_Pass.set(vec4(offset, offset, adapt ? LUMINANCE_PASS_ADAPT : LUMINANCE_PASS_DOWNSAMPLE, adaptation));
+		}
+
+		if (adapt)
+		{
+			// Lerp from the previous frame's adapted luminance in the shader. A constant blend factor would be quantized to 8 bits, making adaptation speed depend on frame rate.
+			bgfx::setTexture(1, s_main->uniforms->luminanceSampler.handle, bgfx::getTexture(s_main->adaptedLuminanceFb[previousAdaptedIndex].handle));
+		}
+
+		bgfx::setTexture(0, s_main->uniforms->textureSampler.handle, source);
+		RenderScreenSpaceQuad(adapt ? "LuminanceAdapt" : "Luminance", dest, ShaderProgramId::Luminance, BGFX_STATE_WRITE_R, BGFX_CLEAR_NONE, Rect(0, 0, destSize, destSize), 0, texCoordScale);
+		source = bgfx::getTexture(dest.handle);
+	}
+}
+
+/// Blur the bloom attachment with a dual filter: downsample it to quarter size and through the rest of the mip chain, then upsample back to quarter size.
+static void RenderBloom()
+{
+	int bloomWidth[Main::nBloomFrameBuffers], bloomHeight[Main::nBloomFrameBuffers];
+	Rect bloomRect[Main::nBloomFrameBuffers];
+	vec2 bloomTexCoordScale[Main::nBloomFrameBuffers];
+	const bool msaaResolve = bgfx::getRendererType() == bgfx::RendererType::OpenGL && IsMsaa(s_main->aa);
+	bgfx::TextureHandle source = msaaResolve ? bgfx::getTexture(s_main->sceneTempFb.handle) : bgfx::getTexture(s_main->sceneFb.handle, s_main->sceneBloomAttachment);
+	vec2 sourceTexelSize(1.0f / window::GetWidth(), 1.0f / window::GetHeight());
+	vec4 sourceTexCoordClamp = GetTexCoordClamp(GetSceneRect(), window::GetWidth(), window::GetHeight());
+
+	for (size_t i = 0; i < s_main->nBloomFrameBuffers; i++)
+	{
+		bloomRect[i] = GetBloomRect(i, &bloomWidth[i], &bloomHeight[i]);
+		bloomTexCoordScale[i] = vec2(bloomRect[i].w / (float)bloomWidth[i], bloomRect[i].h / (float)bloomHeight[i]);
+		s_main->uniforms->bloomTapOffset.set(vec4(sourceTexelSize.x, sourceTexelSize.y, 0, 0));
+		s_main->uniforms->texCoordClamp.set(sourceTexCoordClamp);
+		bgfx::setTexture(0, s_main->uniforms->textureSampler.handle, source);
+		RenderScreenSpaceQuad("BloomDownsample", s_main->bloomFb[i], ShaderProgramId::BloomDownsample, BGFX_STATE_WRITE_RGB, BGFX_CLEAR_NONE, bloomRect[i], 0, bloomTexCoordScale[i]);
+		source = bgfx::getTexture(s_main->bloomFb[i].handle);
+		sourceTexelSize = vec2(1.0f / bloomWidth[i], 1.0f / bloomHeight[i]);
+		sourceTexCoordClamp = GetTexCoordClamp(bloomRect[i], bloomWidth[i], bloomHeight[i]);
+	}
+
+	// Each level is overwritten, its downsampled contents have already been used.
+	for (int i = (int)s_main->nBloomFrameBuffers - 2; i >= 0; i--)
+	{
+		s_main->uniforms->bloomTapOffset.set(vec4(0.5f / bloomWidth[i + 1], 0.5f / bloomHeight[i + 1], 0, 0));
+		s_main->uniforms->texCoordClamp.set(GetTexCoordClamp(bloomRect[i + 1], bloomWidth[i + 1], bloomHeight[i + 1]));
+		bgfx::setTexture(0, s_main->uniforms->textureSampler.handle, bgfx::getTexture(s_main->bloomFb[i + 1].handle));
+		RenderScreenSpaceQuad("BloomUpsample", s_main->bloomFb[i], ShaderProgramId::BloomUpsample, BGFX_STATE_WRITE_RGB, BGFX_CLEAR_NONE, bloomRect[i], 0, bloomTexCoordScale[i]);
+	}
+}
+
+/// Set the uniforms used by passes that composite bloom and tone mapping.
+static void SetCompositeUniforms()
+{
+	// The luminance pass is culled if auto exposure is disabled.
+	const float key = s_main->renderGraph.isLive(RenderGraphPassId::Luminance) ? 0.18f : 0.0f;
+	const float bloomScale = s_main->bloomEnabled ? g_cvars.bloomScale.getFloat() : 0.0f;
+	s_main->uniforms->exposure_Key_BloomScale.set(vec4(g_cvars.hdrExposure.getFloat(), key, bloomScale, 0));
+
+	if (s_main->bloomEnabled)
+	{
+		int bloomWidth, bloomHeight;
+		const Rect bloomRect = GetBloomRect(0, &bloomWidth, &bloomHeight);
+		s_main->uniforms->bloomTexCoordClamp.set(GetTexCoordClamp(bloomRect, bloomWidth, bloomHeight));
+	}
+}
+
+/// Run the render graph passes that follow the world scene.
+/// @remarks Passes before the upscale pass read and write the scene rect, at the dynamic resolution scale. Samplers clamp to the texture edge, not the scene rect, so filter taps are clamped to the rect in the shaders with u_TexCoordClamp and u_BloomTexCoordClamp.
+static void RenderPostProcess(Rect rect)
+{
+	// Full size color read by SMAA. Replaced by the composite pass output if it runs first.
+	bgfx::TextureHandle color = bgfx::getTexture(s_main->sceneFb.handle);
+	const Rect sceneRect = GetSceneRect();
+	const vec2 texCoordScale = GetSceneTexCoordScale();
+	const vec4 sceneTexCoordClamp = GetTexCoordClamp(sceneRect, window::GetWidth(), window::GetHeight());
+
+	for (const RenderGraphPass &pass : s_main->renderGraph.passes)
+	{
+		// The G-buffer passes are drawn by RenderCamera.
+		if (pass.culled || pass.id == RenderGraphPassId::GBuffer || pass.id == RenderGraphPassId::DeferredLight)
+			continue;
+
+		if (pass.id == RenderGraphPassId::Luminance)
+		{
+			RenderLuminance();
+		}
+		else if (pass.id == RenderGraphPassId::BloomMsaaResolve)
+		{
+			Blit("BloomMsaaResolve", bgfx::getTexture(s_main->sceneFb.handle, s_main->sceneBloomAttachment), bgfx::getTexture(s_main->sceneTempFb.handle));
+		}
+		else if (pass.id == RenderGraphPassId::Bloom)
+		{
+			RenderBloom();
+		}
+		else if (pass.id == RenderGraphPassId::Composite)
+		{
+			const FrameBuffer &dest = (pass.writes & (1 << RenderGraphResourceId::SceneTemp)) ? s_main->sceneTempFb : ((pass.writes & (1 << RenderGraphResourceId::SceneScaled)) ? s_main->sceneScaledFb : s_main->defaultFb);
+			SetCompositeUniforms();
+			bgfx::setTexture(0, s_main->uniforms->textureSampler.handle, bgfx::getTexture(s_main->sceneFb.handle));
+
+			if (s_main->bloomEnabled)
+			{
+				bgfx::setTexture(1, s_main->uniforms->bloomSampler.handle, bgfx::getTexture(s_main->bloomFb[0].handle));
+			}
+
+			if (pass.reads & (1 << RenderGraphResourceId::AdaptedLuminance))
+			{
+				bgfx::setTexture(2, s_main->uniforms->luminanceSampler.handle, bgfx::getTexture(s_main->adaptedLuminanceFb[s_main->adaptedLuminanceIndex].handle));
+			}
+
+			// Writing the backbuffer upscales the scene rect to the whole backbuffer.
+			s_main->uniforms->texCoordClamp.set(sceneTexCoordClamp);
+			RenderScreenSpaceQuad("Composite", dest, pass.program, BGFX_STATE_WRITE_RGB, BGFX_CLEAR_NONE, (pass.writes & (1 << RenderGraphResourceId::Backbuffer)) ? Rect() : sceneRect, 0, texCoordScale);
+			color = bgfx::getTexture(dest.handle);
+		}
+		else if (pass.id == RenderGraphPassId::SMAAEdgeDetection)
+		{
+			s_main->uniforms->smaaMetrics.set(vec4(1.0f / rect.w, 1.0f / rect.h, (float)rect.w, (float)rect.h));
+			s_main->uniforms->texCoordClamp.set(sceneTexCoordClamp);
+			bgfx::setTexture(0, s_main->uniforms->smaaColorSampler.handle, color);
+			RenderScreenSpaceQuad("SMAAEdgeDetection", s_main->smaaEdgesFb, pass.program, BGFX_STATE_WRITE_RGB, BGFX_CLEAR_COLOR, sceneRect, 0, texCoordScale);
+		}
+		else if (pass.id == RenderGraphPassId::SMAABlendingWeightCalculation)
+		{
+			bgfx::setTexture(0, s_main->uniforms->smaaEdgesSampler.handle, bgfx::getTexture(s_main->smaaEdgesFb.handle));
+			bgfx::setTexture(1, s_main->uniforms->smaaAreaSampler.handle, s_main->smaaAreaTex);
+			bgfx::setTexture(2, s_main->uniforms->smaaSearchSampler.handle, s_main->smaaSearchTex);
+			RenderScreenSpaceQuad("SMAABlendingWeightCalculation", s_main->smaaBlendFb, pass.program, BGFX_STATE_WRITE_RGB | BGFX_STATE_WRITE_A, BGFX_CLEAR_COLOR, sceneRect, 0, texCoordScale);
+		}
+		else if (pass.id == RenderGraphPassId::SMAANeighborhoodBlending)
+		{
+			bgfx::setTexture(0, s_main->uniforms->smaaColorSampler.handle, color);
+			bgfx::setTexture(1, s_main->uniforms->smaaBlendSampler.handle, bgfx::getTexture(s_main->smaaBlendFb.handle));
+
+			// Bloom is added here when it wasn't composited before SMAA.
+			if (pass.program == ShaderProgramId::SMAANeighborhoodBlending + SMAANeighborhoodBlendingShaderProgramVariant::Bloom)
+			{
+				SetCompositeUniforms();
+				bgfx::setTexture(2, s_main->uniforms->bloomSampler.handle, bgfx::getTexture(s_main->bloomFb[0].handle));
+			}
+
+			const FrameBuffer &dest = (pass.writes & (1 << RenderGraphResourceId::SceneScaled)) ? s_main->sceneScaledFb : s_main->defaultFb;
+			RenderScreenSpaceQuad("SMAANeighborhoodBlending", dest, pass.program, BGFX_STATE_WRITE_RGB, BGFX_CLEAR_NONE, sceneRect, 0, texCoordScale);
+		}
+		else if (pass.id == RenderGraphPassId::Upscale)
+		{
+			// Bilinear filtered from the scene rect to the whole backbuffer. The shader skips the sharpen taps when the amount is 0.
+			s_main->uniforms->sharpenTexelSize_Amount.set(vec4(1.0f / window::GetWidth(), 1.0f / window::GetHeight(), g_cvars.dynamicResolutionSharpen.getFloat(), 0));
+			s_main->uniforms->texCoordClamp.set(sceneTexCoordClamp);
+			bgfx::setTexture(0, s_main->uniforms->textureSampler.handle, bgfx::getTexture(s_main->sceneScaledFb.handle));
+			RenderScreenSpaceQuad("Upscale", s_main->defaultFb, pass.program, BGFX_STATE_WRITE_RGB, BGFX_CLEAR_NONE, Rect(), 0, texCoordScale);
+		}
+	}
+}
+
 static void RenderDebugDraw(bgfx::TextureHandle texture, int x = 0, int y = 0, ShaderProgramId::Enum program = ShaderProgramId::Texture)
 {
 	bgfx::setTexture(0, s_main->uniforms->textureSampler.handle, texture);
@@ -315,22 +545,28 @@ static void ClampEntityLight(vec3 *light)
 	}
 }
 
+/// Vector lit stages sample the light grid textures per pixel instead of using the entity's light.
+static bool IsLightGridTextureEnabled()
+{
+	return s_main->isWorldCamera && g_cvars.lightGridTexture.getBool() && world::HasLightGridTextures();
+}
+
+static vec3 GetEntityLightingPosition(const Entity &entity)
+{
+	// Seperate lightOrigins are needed so an object that is sinking into the ground can still be lit, and so multi-part models can be lit identically.
+	return (entity.flags & EntityFlags::LightingPosition) ? entity.lightingPosition : entity.position;
+}
+
 static void SetupEntityLighting(Entity *entity)
 {
 	assert(entity);
 
 	// Trace a sample point down to find ambient light.
-	vec3 lightPosition;
-	
-	if (entity->flags & EntityFlags::LightingPosition)
-	{
-		// Seperate lightOrigins are needed so an object that is sinking into the ground can still be lit, and so multi-part models can be lit identically.
-		lightPosition = entity->lightingPosition;
-	}
-	else
-	{
-		lightPosition = entity->position;
-	}
+	const vec3 lightPosition = GetEntityLightingPosition(*entity);
+
+	// The shader samples the light grid and adds the minimum light itself.
+	if (IsLightGridTextureEnabled())
+		return;
 
 	// If not a world scene, only use dynamic lights (menu system, etc.)
 	if (s_main->isWorldCamera && world::HasLightGrid())
@@ -354,7 +590,8 @@ static void SetupEntityLighting(Entity *entity)
 	// Modify the light by dynamic lights.
 	if (!s_main->isWorldCamera)
 	{
-		s_main->dlightManager->contribute(s_main->frameNo, lightPosition, &entity->directedLight, &entity->lightDir);
+		entity->directedLight += entity->dynamicLightColor;
+		entity->lightDir += entity->dynamicLightDir;
 	}
 
 	ClampEntityLight(&entity->ambientLight);
@@ -395,10 +632,11 @@ static void RenderRailCore(vec3 start, vec3 end, vec3 up, float length, float sp
 	indices[0] = 0; indices[1] = 1; indices[2] = 2;
 	indices[3] = 2; indices[4] = 1; indices[5] = 3;
 
+	ClassifyEntity(entity, entity->position, entity->radius);
 	DrawCall dc;
 	dc.dynamicLighting = false;
 	dc.entity = entity;
-	dc.fogIndex = s_main->isWorldCamera ? world::FindFogIndex(entity->position, entity->radius) : -1;
+	dc.fogIndex = s_main->isWorldCamera ? entity->fogIndex : -1;
 	dc.material = mat;
 	dc.vb.type = dc.ib.type = DrawCall::BufferType::Transient;
 	dc.vb.transientHandle = tvb;
@@ -500,10 +738,11 @@ static void RenderRailRingsEntity(Entity *entity)
 		index[3] = offset + 3; index[4] = offset + 1; index[5] = offset + 2;
 	}
 
+	ClassifyEntity(entity, entity->position, entity->radius);
 	DrawCall dc;
 	dc.dynamicLighting = false;
 	dc.entity = entity;
-	dc.fogIndex = s_main->isWorldCamera ? world::FindFogIndex(entity->position, entity->radius) : -1;
+	dc.fogIndex = s_main->isWorldCamera ? entity->fogIndex : -1;
 	dc.material = s_main->materialCache->getMaterial(entity->customMaterial);
 	dc.vb.type = dc.ib.type = DrawCall::BufferType::Transient;
 	dc.vb.transientHandle = tvb;
@@ -571,10 +810,11 @@ static void RenderSpriteEntity(mat3 viewRotation, Entity *entity)
 	indices[0] = 0; indices[1] = 1; indices[2] = 3;
 	indices[3] = 3; indices[4] = 1; indices[5] = 2;
 
+	ClassifyEntity(entity, entity->position, entity->radius);
 	DrawCall dc;
 	dc.dynamicLighting = false;
 	dc.entity = entity;
-	dc.fogIndex = s_main->isWorldCamera ? world::FindFogIndex(entity->position, entity->radius) : -1;
+	dc.fogIndex = s_main->isWorldCamera ? entity->fogIndex : -1;
 	dc.material = s_main->materialCache->getMaterial(entity->customMaterial);
 	dc.softSpriteDepth = entity->radius / 2.0f;
 	dc.vb.type = dc.ib.type = DrawCall::BufferType::Transient;
@@ -810,7 +1050,7 @@ static void RenderToStencil(const bgfx::ViewId viewId)
 
 		bgfx::setState(state);
 		bgfx::setStencil(stencilWrite);
-		bgfx::submit(viewId, s_main->shaderPrograms[ShaderProgramId::Depth].handle);
+		bgfx::submit(viewId, GetShaderProgram(ShaderProgramId::Depth));
 	}
 }
 
@@ -828,6 +1068,105 @@ static vec2 CalculateDepthRange(VisibilityId visId, vec3 position)
 	return vec2(zMin, zMax);
 }
 
+/// Opaque surfaces are written to the G-buffer and lit by the deferred light pass instead of the dynamic lights shader variant.
+/// @remarks Surfaces with a depth range hack, like the view weapon, are excluded. Their depth doesn't match their world position, so the deferred light pass would light them in the wrong place.
+static bool IsDeferredLit(const Material *mat, const DrawCall &dc)
+{
+	return mat->sort == MaterialSort::Opaque && !mat->polygonOffset && mat->numUnfoggedPasses > 0 && !(dc.flags & DrawCallFlags::Sky) && dc.zOffset <= 0 && dc.zScale <= 0;
+}
+
+static void RenderGBuffer(const RenderCameraArgs &args, const mat4 &viewMatrix, const mat4 &projectionMatrix, vec2 depthRange)
+{
+	const bgfx::ViewId viewId = PushView(s_main->gBufferFb, BGFX_CLEAR_COLOR | BGFX_CLEAR_DEPTH, viewMatrix, projectionMatrix, args.rect);
+
+	// Albedo alpha is 0 where there's no opaque surface.
+	bgfx::setViewClear(viewId, BGFX_CLEAR_COLOR | BGFX_CLEAR_DEPTH, 0);
+#ifdef _DEBUG
+	bgfx::setViewName(viewId, "GBuffer");
+#endif
+	s_main->uniforms->viewOrigin.set(args.position);
+	s_main->uniforms->viewUp.set(args.rotation[2]);
+
+	for (DrawCall &dc : s_main->drawCalls)
+	{
+		// Material remapping.
+		Material *mat = dc.material->remappedShader ? dc.material->remappedShader : dc.material;
+
+		if (!IsDeferredLit(mat, dc))
+			continue;
+
+		// Albedo comes from the first stage. Later stages are usually blended over it.
+		const MaterialStage *stage = nullptr;
+
+		for (const MaterialStage &s : mat->stages)
+		{
+			if (s.active)
+			{
+				stage = &s;
+				break;
+			}
+		}
+
+		if (!stage)
+			continue;
+
+		s_main->currentEntity = dc.entity;
+		s_main->matUniforms->time.set(vec4(mat->setTime(s_main->floatTime), 0, 0, 0));
+
+		// Albedo is unfogged. Otherwise fog state left by the previous draw would tint it.
+		s_main->uniforms->fogEnabled.set(vec4::empty);
+
+		if (dc.zOffset > 0 || dc.zScale > 0)
+		{
+			s_main->uniforms->depthRangeEnabled.set(vec4(1, 0, 0, 0));
+			s_main->uniforms->depthRange.set(vec4(dc.zOffset, dc.zScale, depthRange.x, depthRange.y));
+		}
+		else
+		{
+			s_main->uniforms->depthRangeEnabled.set(vec4::empty);
+		}
+
+		mat->setDeformUniforms(s_main->matUniforms.get());
+		s_main->uniforms->localViewOrigin.set(s_main->currentEntity ? s_main->currentEntity->localViewPosition : args.position);
+		stage->setShaderUniforms(s_main->matStageUniforms.get());
+		stage->setTextureSamplers(s_main->matStageUniforms.get());
+		SetDrawCallGeometry(dc);
+		bgfx::setTransform(dc.modelMatrix.get());
+
+		// Grab the cull state. Doesn't matter which stage, since it's global to the material.
+		bgfx::setState(BGFX_STATE_WRITE_RGB | BGFX_STATE_WRITE_A | BGFX_STATE_WRITE_Z | BGFX_STATE_DEPTH_TEST_LESS | (stage->getState() & BGFX_STATE_CULL_MASK));
+		bgfx::submit(viewId, GetShaderProgram(ShaderProgramId::GBuffer));
+		s_main->currentEntity = nullptr;
+	}
+}
+
+/// Add dynamic light to the opaque surfaces in the G-buffer with a single screen space pass. Lights are looked up in the same cells and clusters as the forward path.
+/// @return A new view to draw the rest of the scene in, after the lights.
+static bgfx::ViewId RenderDeferredLights(const RenderCameraArgs &args, const mat4 &viewMatrix, const mat4 &projectionMatrix)
+{
+	const mat4 vpMatrix(projectionMatrix * viewMatrix);
+	mat4 invVpMatrix;
+	bx::mtxInverse((float *)&invVpMatrix, vpMatrix.get());
+
+	// The quad's texture coordinates only cover the scene rect, so the NDC the shader derives from them are scaled towards the top left. Undo that first.
+	const vec2 texCoordScale = GetSceneTexCoordScale();
+	const mat4 ndcMatrix = mat4::translate(vec3(1.0f / texCoordScale.x - 1.0f, 1.0f - 1.0f / texCoordScale.y, 0)) * mat4::scale(vec3(1.0f / texCoordScale.x, 1.0f / texCoordScale.y, 1));
+	s_main->uniforms->deferredInvViewProj.set(invVpMatrix * ndcMatrix);
+	s_main->dlightManager->updateUniforms(s_main->uniforms.get(), args.visId == VisibilityId::Main);
+	bgfx::setTexture(TextureUnit::Depth, s_main->matStageUniforms->depthSampler.handle, bgfx::getTexture(s_main->gBufferFb.handle, 2));
+	bgfx::setTexture(TextureUnit::GBufferAlbedo, s_main->matStageUniforms->gBufferAlbedoSampler.handle, bgfx::getTexture(s_main->gBufferFb.handle, 0));
+	bgfx::setTexture(TextureUnit::GBufferNormal, s_main->matStageUniforms->gBufferNormalSampler.handle, bgfx::getTexture(s_main->gBufferFb.handle, 1));
+	bgfx::setTexture(TextureUnit::DynamicLightCells, s_main->matStageUniforms->dynamicLightCellsSampler.handle, s_main->dlightManager->getCellsTexture());
+	bgfx::setTexture(TextureUnit::DynamicLightIndices, s_main->matStageUniforms->dynamicLightIndicesSampler.handle, s_main->dlightManager->getIndicesTexture());
+	bgfx::setTexture(TextureUnit::DynamicLights, s_main->matStageUniforms->dynamicLightsSampler.handle, s_main->dlightManager->getLightsTexture());
+	RenderScreenSpaceQuad("DeferredLights", s_main->sceneFb, ShaderProgramId::DeferredLight, BGFX_STATE_WRITE_RGB | BGFX_STATE_BLEND_ADD, BGFX_CLEAR_NONE, args.rect, 0, texCoordScale);
+	const bgfx::ViewId viewId = PushView(s_main->sceneFb, BGFX_CLEAR_NONE, viewMatrix, projectionMatrix, args.rect, PushViewFlags::Sequential);
+#ifdef _DEBUG
+	bgfx::setViewName(viewId, "SceneBlended");
+#endif
+	return viewId;
+}
+
 static void RenderCamera(const RenderCameraArgs &args)
 {
 	const float polygonDepthOffset = -0.001f;
@@ -889,9 +1228,9 @@ static void RenderCamera(const RenderCameraArgs &args)
 				RenderCamera(reflectionArgs);
 				s_main->isCameraMirrored = false;
 
-				// Blit the scene frame buffer to the reflection frame buffer.
+				// Blit the scene frame buffer to the reflection frame buffer. Only the scene rect, which is where reflective surfaces read it from.
 				bgfx::setTexture(0, s_main->uniforms->textureSampler.handle, bgfx::getTexture(s_main->sceneFb.handle));
-				RenderScreenSpaceQuad("Reflection", s_main->reflectionFb, ShaderProgramId::Texture, BGFX_STATE_WRITE_RGB, BGFX_CLEAR_NONE);
+				RenderScreenSpaceQuad("Reflection", s_main->reflectionFb, ShaderProgramId::Texture, BGFX_STATE_WRITE_RGB, BGFX_CLEAR_NONE, GetSceneRect(), 0, GetSceneTexCoordScale());
 			}
 		}
 
@@ -1022,7 +1361,7 @@ static void RenderCamera(const RenderCameraArgs &args)
 			SetDrawCallGeometry(dc);
 			bgfx::setTransform(dc.modelMatrix.get());
 			bgfx::setState(BGFX_STATE_DEPTH_TEST_LEQUAL | BGFX_STATE_WRITE_Z/* | BGFX_STATE_CULL_CW*/);
-			bgfx::submit(viewId, s_main->shaderPrograms[ShaderProgramId::Depth].handle);
+			bgfx::submit(viewId, GetShaderProgram(ShaderProgramId::Depth));
 			s_main->currentEntity = nullptr;
 		}
 
@@ -1106,11 +1445,20 @@ static void RenderCamera(const RenderCameraArgs &args)
 				bgfx::setStencil(stencilTest);
 			}
 
-			bgfx::submit(viewId, s_main->shaderPrograms[ShaderProgramId::Depth + shaderVariant].handle);
+			bgfx::submit(viewId, GetShaderProgram(ShaderProgramId::Depth + shaderVariant));
 			s_main->currentEntity = nullptr;
 		}
 	}
 
+	// Deferred lighting is only used by the main camera. Other cameras use the forward path.
+	const bool deferredLighting = s_main->deferredLightingEnabled && args.visId == VisibilityId::Main && s_main->dlightManager->getNumLights() > 0 && s_main->renderGraph.isLive(RenderGraphPassId::GBuffer);
+	bool deferredLightsRendered = false;
+
+	if (deferredLighting)
+	{
+		RenderGBuffer(args, viewMatrix, projectionMatrix, depthRange);
+	}
+
 	bgfx::ViewId mainViewId;
 	
 	if (s_main->isWorldCamera)
@@ -1128,18 +1476,24 @@ static void RenderCamera(const RenderCameraArgs &args)
 #endif
 	}
 
-	if (!s_main->drawCalls.empty())
-	{
-		int renderMode = RENDER_MODE_NONE;
+	int renderMode = RENDER_MODE_NONE;
 
-		if (args.flags & RenderCameraFlags::SkipUnlitSurfaces)
-			renderMode = RENDER_MODE_LIT;
-		else if (g_cvars.debug.getInt() == 1)
-			renderMode = RENDER_MODE_LIGHTMAP;
+	if (args.flags & RenderCameraFlags::SkipUnlitSurfaces)
+		renderMode = RENDER_MODE_LIT;
+	else if (g_cvars.debug.getInt() == 1)
+		renderMode = RENDER_MODE_LIGHTMAP;
 
+	if (!s_main->drawCalls.empty())
+	{
 		s_main->uniforms->renderMode.set(vec4((float)renderMode, 0, 0, 0));
 	}
 
+	// Material shape shaders don't have render modes.
+	const bool useMaterialShapes = g_cvars.materialShapes.getBool() && renderMode == RENDER_MODE_NONE;
+	const bool useLightGridTexture = IsLightGridTextureEnabled();
+
+	PROFILE_BEGIN(DrawCalls)
+
 	for (DrawCall &dc : s_main->drawCalls)
 	{
 		assert(dc.material);
@@ -1147,6 +1501,13 @@ static void RenderCamera(const RenderCameraArgs &args)
 		// Material remapping.
 		Material *mat = dc.material->remappedShader ? dc.material->remappedShader : dc.material;
 
+		// Draw calls are sorted, so the opaque surfaces are done. Light them before anything is blended over them.
+		if (deferredLighting && !deferredLightsRendered && dc.material->sort > MaterialSort::Opaque)
+		{
+			mainViewId = RenderDeferredLights(args, viewMatrix, projectionMatrix);
+			deferredLightsRendered = true;
+		}
+
 		// Don't render reflective geometry with the reflection camera.
 		if (args.visId == VisibilityId::Reflection && mat->reflective != MaterialReflective::None)
 			continue;
@@ -1164,14 +1525,18 @@ static void RenderCamera(const RenderCameraArgs &args)
 			s_main->uniforms->depthRangeEnabled.set(vec4(1, 0, 0, 0));
 			s_main->uniforms->depthRange.set(vec4(dc.zOffset, dc.zScale, depthRange.x, depthRange.y));
 			s_main->uniforms->dynamicLight_Num_Intensity.set(vec4::empty);
+			s_main->uniforms->fogEnabled.set(vec4::empty);
 			s_main->matUniforms->nDeforms.set(vec4(0, 0, 0, 0));
 			s_main->matStageUniforms->alphaTest.set(vec4::empty);
 			s_main->matStageUniforms->baseColor.set(vec4::white);
 			s_main->matStageUniforms->generators.set(vec4::empty);
+			s_main->matStageUniforms->layers_Num_TCGen.set(vec4::empty);
 			s_main->matStageUniforms->lightType.set(vec4::empty);
 			s_main->matStageUniforms->vertexColor.set(vec4::black);
 			const int sky_texorder[6] = { 0, 2, 1, 3, 4, 5 };
-			bgfx::setTexture(TextureUnit::Diffuse, s_main->matStageUniforms->diffuseSampler.handle, mat->sky.outerbox[sky_texorder[dc.skyboxSide]]->getHandle());
+			const Texture *skyTexture = mat->sky.outerbox[sky_texorder[dc.skyboxSide]];
+			skyTexture->setLastUsedFrame(s_main->frameNo);
+			bgfx::setTexture(TextureUnit::Diffuse, s_main->matStageUniforms->diffuseSampler.handle, skyTexture->getHandle());
 #ifdef _DEBUG
 			bgfx::setTexture(TextureUnit::Diffuse2, s_main->matStageUniforms->diffuseSampler2.handle, g_textureCache->getWhite()->getHandle());
 			bgfx::setTexture(TextureUnit::Light, s_main->matStageUniforms->lightSampler.handle, g_textureCache->getWhite()->getHandle());
@@ -1190,11 +1555,23 @@ static void RenderCamera(const RenderCameraArgs &args)
 				bgfx::setStencil(stencilTest);
 			}
 
-			bgfx::submit(mainViewId, s_main->shaderPrograms[ShaderProgramId::Generic + shaderVariant].handle);
+			bgfx::submit(mainViewId, GetShaderProgram(ShaderProgramId::Generic + shaderVariant));
 			continue;
 		}
 
-		const bool doFogPass = !dc.material->noFog && dc.fogIndex >= 0 && mat->fogPass != MaterialFogPass::None;
+		bool doFogPass = !dc.material->noFog && dc.fogIndex >= 0 && mat->fogPass != MaterialFogPass::None;
+
+		// Blend fog in the generic shader instead of drawing a fog pass if the material allows it.
+		const bool inlineFogEnabled = s_main->inlineFogTest.rendering ? s_main->inlineFogTest.inlineFog : g_cvars.inlineFog.getBool();
+		const bool inlineFog = doFogPass && inlineFogEnabled && mat->canInlineFogPass();
+
+		if (inlineFog)
+		{
+			doFogPass = false;
+
+			if (s_main->inlineFogTest.rendering)
+				s_main->inlineFogTest.nInlinedDrawCalls++;
+		}
 
 		if (mat->numUnfoggedPasses == 0 && !doFogPass)
 			continue;
@@ -1205,7 +1582,7 @@ static void RenderCamera(const RenderCameraArgs &args)
 
 		if (s_main->isWorldCamera)
 		{
-			s_main->dlightManager->updateUniforms(s_main->uniforms.get());
+			s_main->dlightManager->updateUniforms(s_main->uniforms.get(), args.visId == VisibilityId::Main);
 		}
 		else
 		{
@@ -1213,6 +1590,15 @@ static void RenderCamera(const RenderCameraArgs &args)
 			s_main->uniforms->dynamicLight_Num_Intensity.set(vec4::empty);
 		}
 
+		if (useLightGridTexture)
+		{
+			world::UpdateLightGridUniforms(s_main->uniforms.get());
+		}
+		else
+		{
+			s_main->uniforms->lightGridOrigin_Enabled.set(vec4::empty);
+		}
+
 		if (mat->polygonOffset)
 		{
 			s_main->uniforms->depthRange.set(vec4(polygonDepthOffset, 1, depthRange.x, depthRange.y));
@@ -1244,6 +1630,22 @@ static void RenderCamera(const RenderCameraArgs &args)
 			s_main->uniforms->fogDistance.set(fogDistance);
 			s_main->uniforms->fogDepth.set(fogDepth);
 			s_main->uniforms->fogEyeT.set(eyeT);
+
+			if (inlineFog)
+				s_main->uniforms->fogColor.set(fogColor);
+		}
+
+		// Count each draw call once, not once per material stage.
+		if (s_main->isWorldCamera && s_main->dlightManager->getNumLights() > 0 && !(dc.flags & DrawCallFlags::Sky))
+		{
+			s_main->dlightStats.nDrawCalls++;
+			s_main->dlightStats.nTriangles += dc.ib.nIndices / 3;
+
+			if (!dc.dynamicLighting)
+			{
+				s_main->dlightStats.nSkippedDrawCalls++;
+				s_main->dlightStats.nSkippedTriangles += dc.ib.nIndices / 3;
+			}
 		}
 
 		for (const MaterialStage &stage : mat->stages)
@@ -1268,15 +1670,13 @@ static void RenderCamera(const RenderCameraArgs &args)
 				s_main->uniforms->depthRangeEnabled.set(vec4::empty);
 			}
 
-			if (!dc.material->noFog && dc.fogIndex >= 0 && stage.adjustColorsForFog != MaterialAdjustColorsForFog::None)
+			const bool adjustColorsForFog = !dc.material->noFog && dc.fogIndex >= 0 && stage.adjustsColorsForFog();
+			s_main->uniforms->fogEnabled.set(vec4(adjustColorsForFog ? 1.0f : 0.0f, inlineFog ? 1.0f : 0.0f, 0, 0));
+
+			if (adjustColorsForFog)
 			{
-				s_main->uniforms->fogEnabled.set(vec4(1, 0, 0, 0));
 				s_main->matStageUniforms->fogColorMask.set(stage.getFogColorMask());
 			}
-			else
-			{
-				s_main->uniforms->fogEnabled.set(vec4::empty);
-			}
 
 			stage.setShaderUniforms(s_main->matStageUniforms.get());
 			stage.setTextureSamplers(s_main->matStageUniforms.get());
@@ -1313,7 +1713,7 @@ static void RenderCamera(const RenderCameraArgs &args)
 				}
 			}
 
-			if (s_main->isWorldCamera && dc.dynamicLighting && !(dc.flags & DrawCallFlags::Sky))
+			if (s_main->isWorldCamera && dc.dynamicLighting && !(dc.flags & DrawCallFlags::Sky) && !(deferredLighting && IsDeferredLit(mat, dc)))
 			{
 				shaderVariant |= GenericShaderProgramVariant::DynamicLights;
 				bgfx::setTexture(TextureUnit::DynamicLightCells, s_main->matStageUniforms->dynamicLightCellsSampler.handle, s_main->dlightManager->getCellsTexture());
@@ -1321,6 +1721,13 @@ static void RenderCamera(const RenderCameraArgs &args)
 				bgfx::setTexture(TextureUnit::DynamicLights, s_main->matStageUniforms->dynamicLightsSampler.handle, s_main->dlightManager->getLightsTexture());
 			}
 
+			if (useLightGridTexture && stage.light == MaterialLight::Vector)
+			{
+				bgfx::setTexture(TextureUnit::LightGridAmbient, s_main->matStageUniforms->lightGridAmbientSampler.handle, world::GetLightGridTexture(LightGridTexture::Ambient));
+				bgfx::setTexture(TextureUnit::LightGridDirected, s_main->matStageUniforms->lightGridDirectedSampler.handle, world::GetLightGridTexture(LightGridTexture::Directed));
+				bgfx::setTexture(TextureUnit::LightGridDirection, s_main->matStageUniforms->lightGridDirectionSampler.handle, world::GetLightGridTexture(LightGridTexture::Direction));
+			}
+
 			if (s_main->sunLightEnabled && s_main->isWorldCamera && mat->sort == MaterialSort::Opaque && !(dc.flags & DrawCallFlags::Sky))
 			{
 				shaderVariant |= GenericShaderProgramVariant::SunLight;
@@ -1349,11 +1756,27 @@ static void RenderCamera(const RenderCameraArgs &args)
 					shaderVariant |= TextureVariationShaderProgramVariant::SunLight;
 				}
 
-				bgfx::submit(mainViewId, s_main->shaderPrograms[ShaderProgramId::TextureVariation + shaderVariant].handle);
+				bgfx::submit(mainViewId, GetShaderProgram(ShaderProgramId::TextureVariation + shaderVariant));
+			}
+			else if (useMaterialShapes && stage.shape != -1 && !(shaderVariant & ~(GenericShaderProgramVariant::Bloom | GenericShaderProgramVariant::DynamicLights)))
+			{
+				int shapeShaderVariant = GenericShapeShaderProgramVariant::None;
+
+				if (shaderVariant & GenericShaderProgramVariant::Bloom)
+				{
+					shapeShaderVariant |= GenericShapeShaderProgramVariant::Bloom;
+				}
+
+				if (shaderVariant & GenericShaderProgramVariant::DynamicLights)
+				{
+					shapeShaderVariant |= GenericShapeShaderProgramVariant::DynamicLights;
+				}
+
+				bgfx::submit(mainViewId, GetShaderProgram(ShaderProgramId::GenericShape + stage.shape * GenericShapeShaderProgramVariant::Num + shapeShaderVariant));
 			}
 			else
 			{
-				bgfx::submit(mainViewId, s_main->shaderPrograms[ShaderProgramId::Generic + shaderVariant].handle);
+				bgfx::submit(mainViewId, GetShaderProgram(ShaderProgramId::Generic + shaderVariant));
 			}
 		}
 
@@ -1365,7 +1788,7 @@ static void RenderCamera(const RenderCameraArgs &args)
 			bgfx::setState(dc.state | BGFX_STATE_DEPTH_TEST_ALWAYS | BGFX_STATE_PT_LINES);
 			bgfx::setTexture(0, s_main->uniforms->textureSampler.handle, g_textureCache->getWhite()->getHandle());
 			bgfx::setTransform(dc.modelMatrix.get());
-			bgfx::submit(mainViewId, s_main->shaderPrograms[ShaderProgramId::TextureColor].handle);
+			bgfx::submit(mainViewId, GetShaderProgram(ShaderProgramId::TextureColor));
 		}
 
 		// Do fog pass.
@@ -1411,12 +1834,19 @@ static void RenderCamera(const RenderCameraArgs &args)
 				bgfx::setStencil(stencilTest);
 			}
 
-			bgfx::submit(mainViewId, s_main->shaderPrograms[ShaderProgramId::Fog + shaderVariant].handle);
+			bgfx::submit(mainViewId, GetShaderProgram(ShaderProgramId::Fog + shaderVariant));
 		}
 
 		s_main->currentEntity = nullptr;
 	}
 
+	PROFILE_END // DrawCalls
+
+	if (deferredLighting && !deferredLightsRendered)
+	{
+		mainViewId = RenderDeferredLights(args, viewMatrix, projectionMatrix);
+	}
+
 	// Draws x/y/z lines from the origin for orientation debugging
 	if (!s_main->sceneDebugAxis.empty())
 	{
@@ -1436,7 +1866,7 @@ static void RenderCamera(const RenderCameraArgs &args)
 			bgfx::setState(BGFX_STATE_DEPTH_TEST_LEQUAL | BGFX_STATE_PT_LINES | BGFX_STATE_WRITE_RGB);
 			bgfx::setTransform(mat4::translate(pos).get());
 			bgfx::setVertexBuffer(0, &tvb);
-			bgfx::submit(mainViewId, s_main->shaderPrograms[ShaderProgramId::Color].handle);
+			bgfx::submit(mainViewId, GetShaderProgram(ShaderProgramId::Color));
 		}
 	}
 
@@ -1489,10 +1919,79 @@ static void RenderCamera(const RenderCameraArgs &args)
 
 		bgfx::setState(BGFX_STATE_DEPTH_TEST_LEQUAL | BGFX_STATE_PT_LINES | BGFX_STATE_WRITE_RGB);
 		bgfx::setVertexBuffer(0, &tvb);
-		bgfx::submit(mainViewId, s_main->shaderPrograms[ShaderProgramId::Color].handle);
+		bgfx::submit(mainViewId, GetShaderProgram(ShaderProgramId::Color));
 	}
 }
 
+/// Render the main camera with inline fog, then with the fog pass, and read back both. Compared by CompareInlineFogTest when the data is available.
+static void RenderInlineFogTest(const RenderCameraArgs &args)
+{
+	InlineFogTest &test = s_main->inlineFogTest;
+	test.requested = false;
+	test.nInlinedDrawCalls = 0;
+	test.width = args.rect.w;
+	test.height = args.rect.h;
+	test.rendering = true;
+
+	for (int i = 0; i < 2; i++)
+	{
+		test.inlineFog = i == 0;
+		RenderCamera(args);
+
+		// Convert the scene rect to BGRA8, so HDR formats can be compared the same way. Blitting needs matching formats.
+		test.frameBuffers[i].handle = bgfx::createFrameBuffer(uint16_t(test.width), uint16_t(test.height), bgfx::TextureFormat::BGRA8, BGFX_TEXTURE_RT | BGFX_SAMPLER_U_CLAMP | BGFX_SAMPLER_V_CLAMP);
+		test.readTextures[i] = bgfx::createTexture2D(uint16_t(test.width), uint16_t(test.height), false, 1, bgfx::TextureFormat::BGRA8, BGFX_TEXTURE_BLIT_DST | BGFX_TEXTURE_READ_BACK);
+		bgfx::setTexture(0, s_main->uniforms->textureSampler.handle, bgfx::getTexture(s_main->sceneFb.handle));
+		RenderScreenSpaceQuad("InlineFogTest", test.frameBuffers[i], ShaderProgramId::Texture, BGFX_STATE_WRITE_RGB, BGFX_CLEAR_NONE, Rect(0, 0, test.width, test.height), 0, GetSceneTexCoordScale());
+		Blit("InlineFogTestReadBack", bgfx::getTexture(test.frameBuffers[i].handle), test.readTextures[i]);
+		test.data[i].resize(test.width * test.height * 4);
+		test.readFrameNo = bgfx::readTexture(test.readTextures[i], test.data[i].data());
+	}
+
+	test.rendering = false;
+}
+
+static void CompareInlineFogTest()
+{
+	InlineFogTest &test = s_main->inlineFogTest;
+	const size_t nPixels = size_t(test.width * test.height);
+	int maxDiff[3] = { 0, 0, 0 };
+	size_t nDifferentPixels = 0;
+
+	for (size_t i = 0; i < nPixels; i++)
+	{
+		const uint8_t *inlineColor = &test.data[0][i * 4];
+		const uint8_t *fogPassColor = &test.data[1][i * 4];
+		bool different = false;
+
+		// Alpha isn't written.
+		for (int j = 0; j < 3; j++)
+		{
+			const int diff = std::abs(int(inlineColor[j]) - int(fogPassColor[j]));
+			maxDiff[j] = std::max(maxDiff[j], diff);
+			different |= diff > 0;
+		}
+
+		if (different)
+			nDifferentPixels++;
+	}
+
+	// BGRA8.
+	interface::Printf("Inline fog test: %u draw calls inlined, %d of %d pixels different (%.2f%%)\n", test.nInlinedDrawCalls, (int)nDifferentPixels, (int)nPixels, nPixels > 0 ? nDifferentPixels * 100.0 / nPixels : 0.0);
+	interface::Printf("   max difference R %d, G %d, B %d (of 255)\n", maxDiff[2], maxDiff[1], maxDiff[0]);
+
+	for (int i = 0; i < 2; i++)
+	{
+		bgfx::destroy(test.frameBuffers[i].handle);
+		test.frameBuffers[i].handle = BGFX_INVALID_HANDLE;
+		bgfx::destroy(test.readTextures[i]);
+		test.readTextures[i] = BGFX_INVALID_HANDLE;
+		test.data[i].clear();
+	}
+
+	test.readFrameNo = 0;
+}
+
 void RenderScene(const SceneDefinition &scene)
 {
 	FlushStretchPics();
@@ -1542,131 +2041,160 @@ void RenderScene(const SceneDefinition &scene)
 		}
 
 		// Update scene dynamic lights.
+		// Texture updates are applied once per frame, so the view space clusters are built for the main camera. Reflection and portal cameras use the world grid.
+		s_main->dlightManager->updateQueryGrid(s_main->frameNo);
+
 		if (isWorldScene)
 		{
-			s_main->dlightManager->updateTextures(s_main->frameNo);
+			s_main->dlightManager->updateTextures(s_main->frameNo, scene.position, scene.rotation, scene.fov);
 		}
+		else if (!s_main->sceneEntities.empty())
+		{
+			// Non-world scenes light entities on the CPU. Query every entity at once.
+			s_main->sceneLightingPositions.resize(s_main->sceneEntities.size());
+			s_main->sceneDynamicLightColors.assign(s_main->sceneEntities.size(), vec3::empty);
+			s_main->sceneDynamicLightDirs.assign(s_main->sceneEntities.size(), vec3::empty);
 
-		// Render camera(s).
-		s_main->sceneRotation = scene.rotation;
+			for (size_t i = 0; i < s_main->sceneEntities.size(); i++)
+				s_main->sceneLightingPositions[i] = GetEntityLightingPosition(s_main->sceneEntities[i]);
 
-		if (s_main->skyboxPortalEnabled)
+			s_main->dlightManager->contribute(s_main->frameNo, s_main->sceneLightingPositions.data(), s_main->sceneLightingPositions.size(), s_main->sceneDynamicLightColors.data(), s_main->sceneDynamicLightDirs.data());
+
+			for (size_t i = 0; i < s_main->sceneEntities.size(); i++)
+			{
+				s_main->sceneEntities[i].dynamicLightColor = s_main->sceneDynamicLightColors[i];
+				s_main->sceneEntities[i].dynamicLightDir = s_main->sceneDynamicLightDirs[i];
+			}
+		}
+
+		// World scenes render to the scene rect of the scene frame buffer. Screen space lookups in materials are scaled to match.
+		Rect cameraRect = rect;
+
+		if (isWorldScene && !s_main->fastPathEnabled)
 		{
-			RenderCameraArgs args;
-			args.areaMask = s_main->skyboxPortalScene.areaMask;
-			args.flags = RenderCameraFlags::IsSkyboxPortal;
-			args.fov = s_main->skyboxPortalScene.fov;
-			args.position = s_main->skyboxPortalScene.position;
-			args.pvsPosition = s_main->skyboxPortalScene.position;
-			args.rect = rect;
-			args.rotation = s_main->skyboxPortalScene.rotation;
-			args.visId = VisibilityId::SkyboxPortal;
-			RenderCamera(args);
-			s_main->skyboxPortalEnabled = false;
+			const vec2 scale = GetSceneTexCoordScale();
+			cameraRect = Rect(int(rect.x * scale.x), int(rect.y * scale.y), std::max(1, int(rect.w * scale.x + 0.5f)), std::max(1, int(rect.h * scale.y + 0.5f)));
+			s_main->uniforms->sceneScale.set(vec4(scale.x, scale.y, 0, 0));
+		}
+		else
+		{
+			s_main->uniforms->sceneScale.set(vec4(1, 1, 0, 0));
 		}
 
+		// Render camera(s).
+		s_main->sceneRotation = scene.rotation;
 		RenderCameraArgs args;
 		args.areaMask = scene.areaMask;
 		args.fov = scene.fov;
 		args.position = scene.position;
 		args.pvsPosition = scene.position;
-		args.rect = rect;
+		args.rect = cameraRect;
 		args.rotation = s_main->sceneRotation;
 		args.visId = isWorldScene ? VisibilityId::Main : VisibilityId::None;
 
 		if (scene.flags & SceneDefinitionFlags::ContainsSkyboxPortal)
 			args.flags |= RenderCameraFlags::ContainsSkyboxPortal;
 
+		// Before the skybox portal, which the test cameras would draw over.
+		if (isWorldScene && !s_main->fastPathEnabled && s_main->inlineFogTest.requested)
+		{
+			RenderInlineFogTest(args);
+		}
+
+		if (s_main->skyboxPortalEnabled)
+		{
+			RenderCameraArgs skyboxPortalArgs;
+			skyboxPortalArgs.areaMask = s_main->skyboxPortalScene.areaMask;
+			skyboxPortalArgs.flags = RenderCameraFlags::IsSkyboxPortal;
+			skyboxPortalArgs.fov = s_main->skyboxPortalScene.fov;
+			skyboxPortalArgs.position = s_main->skyboxPortalScene.position;
+			skyboxPortalArgs.pvsPosition = s_main->skyboxPortalScene.position;
+			skyboxPortalArgs.rect = cameraRect;
+			skyboxPortalArgs.rotation = s_main->skyboxPortalScene.rotation;
+			skyboxPortalArgs.visId = VisibilityId::SkyboxPortal;
+			RenderCamera(skyboxPortalArgs);
+			s_main->skyboxPortalEnabled = false;
+		}
+
 		RenderCamera(args);
 
 		if (isWorldScene)
 		{
-			if (s_main->bloomEnabled)
-			{
-				// OpenGL resolves multisampled bloom into a temp texture.
-				const bool msaaResolve = bgfx::getRendererType() == bgfx::RendererType::OpenGL && IsMsaa(s_main->aa);
+			RenderPostProcess(rect);
+		}
+	}
 
-				if (msaaResolve)
-				{
-					Blit("BloomMsaaResolve", bgfx::getTexture(s_main->sceneFb.handle, s_main->sceneBloomAttachment), bgfx::getTexture(s_main->sceneTempFb.handle));
-				}
+	s_main->dlightManager->clear();
+	s_main->sceneDebugAxis.clear();
+	s_main->sceneDebugBounds.clear();
+	s_main->sceneEntities.clear();
+	s_main->scenePolygons.clear();
+	s_main->sortedScenePolygons.clear();
+	s_main->scenePolygonVertices.clear();
+}
 
-				// Render to quarter size framebuffer.
-				const Rect bloomRect(0, 0, window::GetWidth() / 4, window::GetHeight() / 4);
-				bgfx::setTexture(0, s_main->uniforms->textureSampler.handle, msaaResolve ? bgfx::getTexture(s_main->sceneTempFb.handle) : bgfx::getTexture(s_main->sceneFb.handle, s_main->sceneBloomAttachment));
-				RenderScreenSpaceQuad("BloomCopy", s_main->bloomFb[0], ShaderProgramId::Texture, BGFX_STATE_WRITE_RGB, BGFX_CLEAR_NONE, bloomRect);
+/// Scale the world scene and the passes after it, so the frame time stays under the target frame time.
+static void UpdateDynamicResolution()
+{
+	if (!s_main->dynamicResolutionEnabled || !world::IsLoaded())
+		return;
 
-				// Ping-pong guassian blur in quarter size framebuffers
-				for (int i = 0; i < 2; i++)
-				{
-					s_main->uniforms->guassianBlurDirection.set(i == 0 ? vec4(1, 0, 0, 0) : vec4(0, 1, 0, 0));
-					bgfx::setTexture(0, s_main->uniforms->textureSampler.handle, bgfx::getTexture(s_main->bloomFb[i].handle));
-					RenderScreenSpaceQuad("BloomBlur", s_main->bloomFb[!i], ShaderProgramId::GaussianBlur, BGFX_STATE_WRITE_RGB, BGFX_CLEAR_NONE, bloomRect);
-				}
+	// The time between frames includes waiting for com_maxfps, so use the GPU time if the backend measures it, and the render thread submit time.
+	const bgfx::Stats *stats = bgfx::getStats();
+	float frameTime = 0;
 
-				// Apply bloom. If using SMAA, we need to read color, so blit into the original bloom texture which is no longer used.
-				s_main->uniforms->bloom_Write_Scale.set(vec4(0, g_cvars.bloomScale.getFloat(), 0, 0));
-				bgfx::setTexture(0, s_main->uniforms->textureSampler.handle, bgfx::getTexture(s_main->sceneFb.handle));
-				bgfx::setTexture(1, s_main->uniforms->bloomSampler.handle, bgfx::getTexture(s_main->bloomFb[0].handle));
-				RenderScreenSpaceQuad("BloomApply", s_main->aa == AntiAliasing::SMAA ? s_main->sceneTempFb : s_main->defaultFb, ShaderProgramId::Bloom, BGFX_STATE_WRITE_RGB, BGFX_CLEAR_NONE);
-			}
+	if (stats->gpuTimerFreq > 0 && stats->gpuTimeEnd > stats->gpuTimeBegin)
+	{
+		frameTime = float((stats->gpuTimeEnd - stats->gpuTimeBegin) * 1000.0 / stats->gpuTimerFreq);
+	}
 
-			if (s_main->aa == AntiAliasing::SMAA)
-			{
-				s_main->uniforms->smaaMetrics.set(vec4(1.0f / rect.w, 1.0f / rect.h, (float)rect.w, (float)rect.h));
+	if (stats->cpuTimerFreq > 0)
+	{
+		frameTime = std::max(frameTime, float((stats->cpuTimeEnd - stats->cpuTimeBegin) * 1000.0 / stats->cpuTimerFreq));
+	}
 
-				// Edge detection.
-				if (s_main->bloomEnabled)
-				{
-					bgfx::setTexture(0, s_main->uniforms->smaaColorSampler.handle, bgfx::getTexture(s_main->sceneTempFb.handle));
-				}
-				else
-				{
-					bgfx::setTexture(0, s_main->uniforms->smaaColorSampler.handle, bgfx::getTexture(s_main->sceneFb.handle));
-				}
+	if (frameTime <= 0)
+		return;
 
-				RenderScreenSpaceQuad("SMAAEdgeDetection", s_main->smaaEdgesFb, ShaderProgramId::SMAAEdgeDetection, BGFX_STATE_WRITE_RGB, BGFX_CLEAR_COLOR);
+	// Moving average, so single frame spikes don't change the resolution.
+	float &averageFrameTime = s_main->dynamicResolutionFrameTime;
+	averageFrameTime = averageFrameTime > 0 ? averageFrameTime + (frameTime - averageFrameTime) * 0.1f : frameTime;
+	float &scale = s_main->dynamicResolutionScale;
+	int targetFps = g_cvars.dynamicResolutionTargetFps.getInt();
 
-				// Blending weight calculation.
-				bgfx::setTexture(0, s_main->uniforms->smaaEdgesSampler.handle, bgfx::getTexture(s_main->smaaEdgesFb.handle));
-				bgfx::setTexture(1, s_main->uniforms->smaaAreaSampler.handle, s_main->smaaAreaTex);
-				bgfx::setTexture(2, s_main->uniforms->smaaSearchSampler.handle, s_main->smaaSearchTex);
-				RenderScreenSpaceQuad("SMAABlendingWeightCalculation", s_main->smaaBlendFb, ShaderProgramId::SMAABlendingWeightCalculation, BGFX_STATE_WRITE_RGB | BGFX_STATE_WRITE_A, BGFX_CLEAR_COLOR);
+	if (targetFps <= 0)
+		targetFps = g_cvars.maxFps.getInt();
 
-				// Neighborhood blending.
-				if (s_main->bloomEnabled)
-				{
-					bgfx::setTexture(0, s_main->uniforms->smaaColorSampler.handle, bgfx::getTexture(s_main->sceneTempFb.handle));
-				}
-				else
-				{
-					bgfx::setTexture(0, s_main->uniforms->smaaColorSampler.handle, bgfx::getTexture(s_main->sceneFb.handle));
-				}
+	// Uncapped, with nothing to hold.
+	if (targetFps <= 0)
+	{
+		scale = 1;
+		return;
+	}
 
-				bgfx::setTexture(1, s_main->uniforms->smaaBlendSampler.handle, bgfx::getTexture(s_main->smaaBlendFb.handle));
-				RenderScreenSpaceQuad("SMAANeighborhoodBlending", s_main->defaultFb, ShaderProgramId::SMAANeighborhoodBlending, BGFX_STATE_WRITE_RGB, BGFX_CLEAR_NONE);
-			}
-			else if (!s_main->bloomEnabled && !s_main->fastPathEnabled)
-			{
-				// Render scene to backbuffer.
-				bgfx::setTexture(0, s_main->uniforms->textureSampler.handle, bgfx::getTexture(s_main->sceneFb.handle));
-				RenderScreenSpaceQuad("RenderToBackbuffer", s_main->defaultFb, ShaderProgramId::Texture, BGFX_STATE_WRITE_RGB, BGFX_CLEAR_NONE);
-			}
-		}
+	// Leave some of the frame for the game and the engine. Only react outside a band below that, so the resolution doesn't pump.
+	const float budget = 1000.0f / targetFps * 0.9f;
+
+	if (averageFrameTime > budget || averageFrameTime < budget * 0.8f)
+	{
+		// Pixel count, and most of the GPU time, goes with the square of the scale. Aim for the middle of the band, a step at a time.
+		const float maxStep = 0.02f;
+		const float desiredScale = scale * sqrtf(budget * 0.9f / averageFrameTime);
+		scale += bx::clamp(desiredScale - scale, -maxStep, maxStep);
 	}
 
-	s_main->dlightManager->clear();
-	s_main->sceneDebugAxis.clear();
-	s_main->sceneDebugBounds.clear();
-	s_main->sceneEntities.clear();
-	s_main->scenePolygons.clear();
-	s_main->sortedScenePolygons.clear();
-	s_main->scenePolygonVertices.clear();
+	scale = bx::clamp(scale, g_cvars.dynamicResolutionMinScale.getFloat(), 1.0f);
 }
 
 void EndFrame()
 {
 	FlushStretchPics();
+	s_main->lastDlightStats = s_main->dlightStats;
+	s_main->dlightStats = Main::DynamicLightStats();
+
+	// Show any textures that have finished loading since the last frame, e.g. while the loading screen is up.
+	g_textureCache->uploadLoadedImages(false);
+	g_textureCache->updateResidency(s_main->frameNo);
 
 	if (s_main->firstFreeViewId == 0)
 	{
@@ -1687,8 +2215,10 @@ void EndFrame()
 			RenderDebugDraw(bgfx::getTexture(s_main->sceneFb.handle, s_main->sceneBloomAttachment));
 		}
 
-		RenderDebugDraw(bgfx::getTexture(s_main->bloomFb[0].handle), 0, 1);
-		RenderDebugDraw(bgfx::getTexture(s_main->bloomFb[1].handle), 0, 2);
+		for (size_t i = 0; i < s_main->nBloomFrameBuffers; i++)
+		{
+			RenderDebugDraw(bgfx::getTexture(s_main->bloomFb[i].handle), 0, int(i + 1));
+		}
 	}
 	else if (s_main->debugDraw == DebugDraw::Depth && s_main->softSpritesEnabled)
 	{
@@ -1727,6 +2257,9 @@ void EndFrame()
 #if USE_PROFILER
 	PROFILE_END // Frame
 	profiler::Print();
+	int nStageCacheHits, nStageCacheMisses;
+	MaterialStage::getEvaluationCacheStats(&nStageCacheHits, &nStageCacheMisses, true);
+	main::DebugPrint("Material stage cache: %d hits, %d misses", nStageCacheHits, nStageCacheMisses);
 	profiler::BeginFrame(s_main->frameNo + 1);
 	PROFILE_BEGIN(Frame)
 #endif
@@ -1742,6 +2275,12 @@ void EndFrame()
 	bgfx::setDebug(debug);
 	s_main->frameNo = bgfx::frame(s_main->captureFrame);
 	s_main->captureFrame = false;
+	UpdateDynamicResolution();
+
+	if (s_main->inlineFogTest.readFrameNo != 0 && s_main->frameNo >= s_main->inlineFogTest.readFrameNo)
+	{
+		CompareInlineFogTest();
+	}
 
 	if (g_cvars.debugDraw.isModified())
 	{
@@ -1755,6 +2294,30 @@ void EndFrame()
 		g_cvars.gamma.clearModified();
 	}
 
+	// Without SMAA, the upscale pass is only needed for sharpening. Rebuild when sharpening is switched on or off.
+	if (g_cvars.dynamicResolutionSharpen.isModified())
+	{
+		const bool sharpen = g_cvars.dynamicResolutionSharpen.getFloat() > 0;
+
+		if (s_main->dynamicResolutionEnabled && s_main->aa != AntiAliasing::SMAA && world::IsLoaded() && sharpen != s_main->renderGraph.isLive(RenderGraphPassId::Upscale))
+		{
+			BuildRenderGraph();
+		}
+
+		g_cvars.dynamicResolutionSharpen.clearModified();
+	}
+
+	// The luminance pass is culled when auto exposure is disabled.
+	if (g_cvars.hdrAutoExposure.isModified())
+	{
+		if (s_main->hdrEnabled && world::IsLoaded())
+		{
+			BuildRenderGraph();
+		}
+
+		g_cvars.hdrAutoExposure.clearModified();
+	}
+
 	if (s_main->debugTextThisFrame)
 	{
 		bgfx::dbgTextClear();
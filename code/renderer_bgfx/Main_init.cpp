@@ -79,6 +79,8 @@ void ConsoleVariables::initialize()
 
 	bgfx_stats = interface::Cvar_Get("r_bgfx_stats", "0", ConsoleVariableFlags::Cheat);
 	bloomScale = interface::Cvar_Get("r_bloomScale", "1.0", ConsoleVariableFlags::Archive);
+	collapseStages = interface::Cvar_Get("r_collapseStages", "0", ConsoleVariableFlags::Archive | ConsoleVariableFlags::Latch);
+	collapseStages.setDescription("Blend material stages that add, modulate or alpha blend over an opaque stage in the shader, instead of drawing them as separate passes.");
 	debug = interface::Cvar_Get("r_debug", "", 0);
 	debugDraw = interface::Cvar_Get("r_debugDraw", "", 0);
 	debugDraw.setDescription(
@@ -91,21 +93,77 @@ void ConsoleVariables::initialize()
 		"shadow     Shadows\n"
 		"smaa       SMAA edges and weights\n");
 	debugDrawSize = interface::Cvar_Get("r_debugDrawSize", "256", ConsoleVariableFlags::Archive);
+	dynamicLightClusters = interface::Cvar_Get("r_dynamicLightClusters", "1", ConsoleVariableFlags::Archive);
+	dynamicLightClusters.setDescription("Assign dynamic lights to view space clusters for the main camera, instead of the world grid.");
 	dynamicLightIntensity = interface::Cvar_Get("r_dynamicLightIntensity", "1", ConsoleVariableFlags::Archive);
 	dynamicLightScale = interface::Cvar_Get("r_dynamicLightScale", "0.7", ConsoleVariableFlags::Archive);
+	dynamicResolutionMinScale = interface::Cvar_Get("r_dynamicResolutionMinScale", "0.5", ConsoleVariableFlags::Archive);
+	dynamicResolutionMinScale.setDescription("The lowest the dynamic resolution scale can go, as a fraction of the window width and height.");
+	dynamicResolutionMinScale.checkRange(0.25f, 1.0f, false);
+	dynamicResolutionSharpen = interface::Cvar_Get("r_dynamicResolutionSharpen", "0.5", ConsoleVariableFlags::Archive);
+	dynamicResolutionSharpen.setDescription("Sharpen the upscaled scene when dynamic resolution is enabled. 0 is off, 1 is the strongest.");
+	dynamicResolutionSharpen.checkRange(0.0f, 1.0f, false);
+	dynamicResolutionTargetFps = interface::Cvar_Get("r_dynamicResolutionTargetFps", "0", ConsoleVariableFlags::Archive);
+	dynamicResolutionTargetFps.setDescription("The frame rate dynamic resolution tries to hold. 0 uses com_maxfps.");
+	hdrAutoExposure = interface::Cvar_Get("r_hdrAutoExposure", "1", ConsoleVariableFlags::Archive);
+	hdrAutoExposure.setDescription("Adjust HDR exposure to the average scene luminance.");
+	hdrExposure = interface::Cvar_Get("r_hdrExposure", "1", ConsoleVariableFlags::Archive);
+	hdrExposure.setDescription("HDR exposure scale, applied on top of auto exposure.");
+	imageCache = interface::Cvar_Get("r_imageCache", "0", ConsoleVariableFlags::Archive | ConsoleVariableFlags::Latch);
+	imageCache.setDescription("Save decoded and mipmapped images to the imagecache directory, and load them from there next time.");
+	imageLoadThreads = interface::Cvar_Get("r_imageLoadThreads", "-1", ConsoleVariableFlags::Archive | ConsoleVariableFlags::Latch);
+	imageLoadThreads.setDescription(
+		"-1   One less than the number of CPU cores\n"
+		"0    Load images on the main thread\n"
+		"<n>  Load images on n threads while registering\n");
+	imageLoadThreads.checkRange(-1, 16, true);
+	inlineFog = interface::Cvar_Get("r_inlineFog", "1", ConsoleVariableFlags::Archive);
+	inlineFog.setDescription("Blend fog in the shader of materials with a single opaque stage, instead of drawing a separate fog pass.");
+	lightGridTexture = interface::Cvar_Get("r_lightGridTexture", "1", ConsoleVariableFlags::Archive);
+	lightGridTexture.setDescription("Light entities per pixel from the light grid uploaded as a 3D texture, instead of sampling it once per entity on the CPU.");
+	materialCache = interface::Cvar_Get("r_materialCache", "0", ConsoleVariableFlags::Archive | ConsoleVariableFlags::Latch);
+	materialCache.setDescription(
+		"0  Parse materials from shader files\n"
+		"1  Save parsed materials to materialcache.bin, and load them from there next time\n"
+		"2  Verify - parse materials and compare them with materialcache.bin\n");
+	materialCache.checkRange(0, 2, true);
+	materialShapes = interface::Cvar_Get("r_materialShapes", "1", ConsoleVariableFlags::Archive);
+	materialShapes.setDescription("Draw material stages that match a material shape with a generic shader specialized for it. See shaders/MaterialShapes.txt.");
+	materialStageCache = interface::Cvar_Get("r_materialStageCache", "1", ConsoleVariableFlags::Archive);
+	materialStageCache.setDescription("Reuse material stage colors and texture matrices evaluated earlier in the frame, instead of evaluating them for every draw call.");
+	mipmapFilter = interface::Cvar_Get("r_mipmapFilter", "box", ConsoleVariableFlags::Archive | ConsoleVariableFlags::Latch);
+	mipmapFilter.setDescription(
+		"box     2x2 box filter\n"
+		"gamma   Gamma correct 2x2 box filter\n"
+		"stb     stb_image_resize\n");
 	picmip = interface::Cvar_Get("r_picmip", "0", ConsoleVariableFlags::Archive | ConsoleVariableFlags::Latch);
 	picmip.checkRange(0, 16, true);
 	railWidth = interface::Cvar_Get("r_railWidth", "16", ConsoleVariableFlags::Archive);
 	railCoreWidth = interface::Cvar_Get("r_railCoreWidth", "6", ConsoleVariableFlags::Archive);
 	railSegmentLength = interface::Cvar_Get("r_railSegmentLength", "32", ConsoleVariableFlags::Archive);
 	screenshotJpegQuality = interface::Cvar_Get("r_screenshotJpegQuality", "90", ConsoleVariableFlags::Archive);
+	shaderCache = interface::Cvar_Get("r_shaderCache", "1", ConsoleVariableFlags::Archive | ConsoleVariableFlags::Latch);
+	shaderCache.setDescription("Save shader binaries created by the backend to the bgfx_shadercache directory, and load them from there next time.");
+	shaderCacheSize = interface::Cvar_Get("r_shaderCacheSize", "32", ConsoleVariableFlags::Archive | ConsoleVariableFlags::Latch);
+	shaderCacheSize.setDescription("Maximum megabytes of shader binaries to keep in the shader cache. Least recently used binaries are removed first.");
+	shaderCacheSize.checkRange(1, 1024, true);
+	shaderWarmup = interface::Cvar_Get("r_shaderWarmup", "1", ConsoleVariableFlags::Archive | ConsoleVariableFlags::Latch);
+	shaderWarmup.setDescription("Create the shader programs listed in shaderwarmup.txt at startup instead of when they're first drawn. Write the list with r_writeShaderWarmup.");
 	shadowDepthBias = interface::Cvar_Get("r_shadowDepthBias", "0", ConsoleVariableFlags::Archive);
 	shadowNormalBias = interface::Cvar_Get("r_shadowNormalBias", "1", ConsoleVariableFlags::Archive);
 	shadowSlopeScaleDepthBias = interface::Cvar_Get("r_shadowSlopeScaleDepthBias", "0", ConsoleVariableFlags::Archive);
 	sunLightIntensity = interface::Cvar_Get("r_sunLightIntensity", "1", ConsoleVariableFlags::Archive);
+	textureMemoryBudget = interface::Cvar_Get("r_textureMemoryBudget", "0", ConsoleVariableFlags::Archive);
+	textureMemoryBudget.setDescription("Maximum megabytes of texture memory. Least recently used textures drop their top mip levels to stay within the budget. 0 is unlimited.");
+	textureStreaming = interface::Cvar_Get("r_textureStreaming", "0", ConsoleVariableFlags::Archive | ConsoleVariableFlags::Latch);
+	textureUploadBudget = interface::Cvar_Get("r_textureUploadBudget", "4096", ConsoleVariableFlags::Archive);
+	textureUploadBudget.setDescription("Maximum kilobytes of streamed texture data to upload per frame. 0 is unlimited.");
 	textureVariation = interface::Cvar_Get("r_textureVariation", "0", ConsoleVariableFlags::Archive);
 	wireframe = interface::Cvar_Get("r_wireframe", "0", ConsoleVariableFlags::Cheat);
 
+	// Engine
+	maxFps = interface::Cvar_Get("com_maxfps", "85", ConsoleVariableFlags::Archive);
+
 	// Gamma
 	gamma = interface::Cvar_Get("r_gamma", "1", ConsoleVariableFlags::Archive);
 	ignoreHardwareGamma = interface::Cvar_Get("r_ignorehwgamma", "0", ConsoleVariableFlags::Archive | ConsoleVariableFlags::Latch);
@@ -200,6 +258,239 @@ static void TakeScreenshot(const char *extension)
 	bgfx::requestScreenShot(BGFX_INVALID_HANDLE, filename);
 }
 
+struct ShaderProgramIdMap
+{
+	FragmentShaderId::Enum frag;
+	VertexShaderId::Enum vert;
+};
+
+static std::array<ShaderSourceMem, FragmentShaderId::Num> s_fragmentShaderSource;
+static std::array<ShaderSourceMem, VertexShaderId::Num> s_vertexShaderSource;
+static std::array<ShaderProgramIdMap, ShaderProgramId::Num> s_shaderProgramMap;
+static const char *s_shaderWarmupFilename = "shaderwarmup.txt";
+
+static void CreateShaderProgram(int id)
+{
+	const ShaderProgramIdMap &pm = s_shaderProgramMap[id];
+	Shader &fragment = s_main->fragmentShaders[pm.frag];
+
+	if (!bgfx::isValid(fragment.handle))
+	{
+		const ShaderSourceMem &source = s_fragmentShaderSource[pm.frag];
+		fragment.handle = bgfx::createShader(bgfx::makeRef(source.mem, (uint32_t)source.size));
+
+		if (!bgfx::isValid(fragment.handle))
+			interface::Error("Error creating fragment shader");
+
+#ifdef _DEBUG
+		bgfx::setName(fragment.handle, s_fragmentShaderNames[pm.frag]);
+#endif
+	}
+
+	Shader &vertex = s_main->vertexShaders[pm.vert];
+
+	if (!bgfx::isValid(vertex.handle))
+	{
+		const ShaderSourceMem &source = s_vertexShaderSource[pm.vert];
+		vertex.handle = bgfx::createShader(bgfx::makeRef(source.mem, (uint32_t)source.size));
+
+		if (!bgfx::isValid(vertex.handle))
+			interface::Error("Error creating vertex shader");
+
+#ifdef _DEBUG
+		bgfx::setName(vertex.handle, s_vertexShaderNames[pm.vert]);
+#endif
+	}
+
+	s_main->shaderPrograms[id].handle = bgfx::createProgram(vertex.handle, fragment.handle);
+
+	if (!bgfx::isValid(s_main->shaderPrograms[id].handle))
+		interface::Error("Error creating shader program");
+}
+
+/// Shader programs are identified by the name of their fragment shader, which is unique.
+static int FindShaderProgram(const char *name)
+{
+	for (int i = 0; i < ShaderProgramId::Num; i++)
+	{
+		if (!util::Stricmp(s_fragmentShaderNames[s_shaderProgramMap[i].frag], name))
+			return i;
+	}
+
+	return -1;
+}
+
+/// The warm-up list is the names of shader programs to create at startup, one per line.
+static void ReadShaderWarmupList()
+{
+	ReadOnlyFile file(s_shaderWarmupFilename);
+
+	if (!file.isValid())
+		return;
+
+	const char *p = (const char *)file.getData();
+	const char *end = p + file.getLength();
+	int nCreated = 0;
+
+	while (p < end)
+	{
+		const char *lineEnd = p;
+
+		while (lineEnd < end && *lineEnd != '\n' && *lineEnd != '\r')
+			lineEnd++;
+
+		char name[64];
+		util::Strncpyz(name, p, (int)std::min(sizeof(name), size_t(lineEnd - p) + 1));
+		p = lineEnd + 1;
+
+		if (!name[0])
+			continue;
+
+		const int id = FindShaderProgram(name);
+
+		if (id == -1)
+		{
+			interface::PrintWarningf("Unknown shader program %s in %s\n", name, s_shaderWarmupFilename);
+			continue;
+		}
+
+		if (!bgfx::isValid(s_main->shaderPrograms[id].handle))
+		{
+			CreateShaderProgram(id);
+			nCreated++;
+		}
+	}
+
+	interface::PrintDeveloperf("Created %d shader programs from %s\n", nCreated, s_shaderWarmupFilename);
+}
+
+/// Write the resident shader programs - the ones used since startup plus the previous warm-up list - to the warm-up list.
+static void WriteShaderWarmupList()
+{
+	std::string text;
+	int nPrograms = 0;
+
+	for (int i = 0; i < ShaderProgramId::Num; i++)
+	{
+		if (!bgfx::isValid(s_main->shaderPrograms[i].handle))
+			continue;
+
+		text += s_fragmentShaderNames[s_shaderProgramMap[i].frag];
+		text += "\n";
+		nPrograms++;
+	}
+
+	interface::FS_WriteFile(s_shaderWarmupFilename, (const uint8_t *)text.data(), text.length());
+	interface::Printf("Wrote %d shader programs to %s\n", nPrograms, s_shaderWarmupFilename);
+}
+
+bgfx::ProgramHandle GetShaderProgram(int id)
+{
+	assert(id >= 0 && id < ShaderProgramId::Num);
+
+	if (!bgfx::isValid(s_main->shaderPrograms[id].handle))
+	{
+		CreateShaderProgram(id);
+	}
+
+	return s_main->shaderPrograms[id].handle;
+}
+
+/// Measure the CPU cost of setting up draw calls for every stage of every material, without submitting them.
+static void Cmd_BenchmarkMaterialStages()
+{
+	if (!g_materialCache)
+		return;
+
+	const int nIterations = interface::Cmd_Argc() > 1 ? math::Clamped(atoi(interface::Cmd_Argv(1)), 1, 100) : 10;
+
+	// Entity colorGens and texMods read the current entity.
+	Entity entity;
+	entity.materialColor = vec4(1, 1, 1, 1);
+	s_main->currentEntity = &entity;
+	size_t nStages = 0;
+	uint64_t state = 0;
+	const int64_t start = bx::getHPCounter();
+
+	for (int i = 0; i < nIterations; i++)
+	{
+		for (size_t j = 0; j < g_materialCache->getNumMaterials(); j++)
+		{
+			Material *mat = g_materialCache->getMaterial((int)j);
+			mat->setTime(s_main->floatTime);
+
+			for (size_t k = 0; k < mat->getNumStages(); k++)
+			{
+				const MaterialStage &stage = mat->stages[k];
+
+				// Don't advance videos.
+				if (stage.bundles[MaterialTextureBundleIndex::DiffuseMap].isVideoMap)
+					continue;
+
+				stage.setShaderUniforms(s_main->matStageUniforms.get());
+				stage.setTextureSamplers(s_main->matStageUniforms.get());
+				state |= stage.getState();
+				bgfx::discard();
+				nStages++;
+			}
+		}
+	}
+
+	const double elapsed = (bx::getHPCounter() - start) / (double)bx::getHPFrequency();
+	s_main->currentEntity = nullptr;
+	interface::Printf("%u material stages, %d iteration(s): %.2fms, %.3fus per stage (state %llx)\n", (uint32_t)(nStages / nIterations), nIterations, elapsed * 1000.0, nStages > 0 ? elapsed * 1000000.0 / nStages : 0.0, (unsigned long long)state);
+	interface::Printf("%u bytes per material, %u bytes per stage\n", (uint32_t)sizeof(Material), (uint32_t)sizeof(MaterialStage));
+}
+
+/// r_benchmarkDynamicLights [lights] [iterations]
+static void Cmd_BenchmarkDynamicLights()
+{
+	if (!world::IsLoaded())
+	{
+		interface::Printf("No world loaded\n");
+		return;
+	}
+
+	const int nLights = interface::Cmd_Argc() > 1 ? math::Clamped(atoi(interface::Cmd_Argv(1)), 1, (int)DynamicLightManager::maxLights) : (int)DynamicLightManager::maxLights;
+	const int nIterations = interface::Cmd_Argc() > 2 ? math::Clamped(atoi(interface::Cmd_Argv(2)), 1, 100) : 10;
+
+	// Use the last main camera with a 90 degree horizontal fov.
+	const float fovX = 90;
+	const float fovY = RAD2DEG(std::atan(std::tan(DEG2RAD(fovX) / 2.0f) * window::GetHeight() / (float)window::GetWidth()) * 2.0f);
+	s_main->dlightManager->benchmark((size_t)nLights, nIterations, s_main->mainCameraTransform.position, s_main->mainCameraTransform.rotation, vec2(fovX, fovY));
+}
+
+static void Cmd_BenchmarkMipmaps()
+{
+	BenchmarkMipmaps(interface::Cmd_Argc() > 1 ? interface::Cmd_Argv(1) : "textures");
+}
+
+static void Cmd_BenchmarkShaderIndex()
+{
+	const int nFiles = interface::Cmd_Argc() > 1 ? atoi(interface::Cmd_Argv(1)) : 2000;
+	const int nDefinitionsPerFile = interface::Cmd_Argc() > 2 ? atoi(interface::Cmd_Argv(2)) : 20;
+	BenchmarkMaterialTextIndex(std::max(1, nFiles), std::max(1, nDefinitionsPerFile));
+}
+
+static void Cmd_BuildImageCache()
+{
+	if (interface::Cmd_Argc() > 2)
+	{
+		interface::Printf("usage: r_buildImageCache [directory]\n");
+		return;
+	}
+
+	if (interface::Cmd_Argc() == 2)
+	{
+		BuildImageCache(interface::Cmd_Argv(1));
+	}
+	else
+	{
+		for (const char *directory : { "env", "gfx", "levelshots", "models", "sprites", "textures" })
+			BuildImageCache(directory);
+	}
+}
+
 static void Cmd_CaptureFrame()
 {
 	s_main->captureFrame = true;
@@ -213,12 +504,174 @@ static void Cmd_PickMaterial()
 	}
 }
 
+static void Cmd_PrintDynamicLightStats()
+{
+	// Triangles stand in for shaded pixels, which would need occlusion queries to count.
+	const Main::DynamicLightStats &stats = s_main->lastDlightStats;
+	interface::Printf("Dynamic light shader variant skipped for %u of %u draw calls (%.1f%%), %llu of %llu triangles (%.1f%%)\n", stats.nSkippedDrawCalls, stats.nDrawCalls, stats.nDrawCalls > 0 ? stats.nSkippedDrawCalls * 100.0 / stats.nDrawCalls : 0.0, (unsigned long long)stats.nSkippedTriangles, (unsigned long long)stats.nTriangles, stats.nTriangles > 0 ? stats.nSkippedTriangles * 100.0 / stats.nTriangles : 0.0);
+}
+
 static void Cmd_PrintMaterials()
 {
 	if (g_materialCache)
 		g_materialCache->printMaterials();
 }
 
+static void Cmd_PrintMaterialShapes()
+{
+	if (g_materialCache)
+		g_materialCache->printMaterialShapes();
+}
+
+static void Cmd_PrintRenderGraph()
+{
+	static const char * const passNames[] =
+	{
+		"GBuffer",
+		"DeferredLight",
+		"Luminance",
+		"BloomMsaaResolve",
+		"Bloom",
+		"Composite",
+		"SMAAEdgeDetection",
+		"SMAABlendingWeightCalculation",
+		"SMAANeighborhoodBlending",
+		"Upscale"
+	};
+
+	static const char * const resourceNames[] =
+	{
+		"Backbuffer",
+		"SceneColor",
+		"AdaptedLuminance",
+		"Bloom",
+		"GBufferAlbedo",
+		"GBufferNormal",
+		"GBufferDepth",
+		"SceneTemp",
+		"SMAAEdges",
+		"SMAABlend",
+		"SceneScaled"
+	};
+
+	BX_STATIC_ASSERT(BX_COUNTOF(passNames) == RenderGraphPassId::Num);
+	BX_STATIC_ASSERT(BX_COUNTOF(resourceNames) == RenderGraphResourceId::Num);
+	const RenderGraph &graph = s_main->renderGraph;
+	int nFullSize = 0, nReducedSize = 0;
+
+	for (const RenderGraphPass &pass : graph.passes)
+	{
+		if (pass.program != ShaderProgramId::Num)
+		{
+			interface::Printf("%s (%s)", passNames[pass.id], s_fragmentShaderNames[s_shaderProgramMap[pass.program].frag]);
+		}
+		else
+		{
+			interface::Printf("%s", passNames[pass.id]);
+		}
+
+		for (int i = 0; i < RenderGraphResourceId::Num; i++)
+		{
+			if (pass.reads & (1 << i))
+				interface::Printf(" <%s", resourceNames[i]);
+		}
+
+		for (int i = 0; i < RenderGraphResourceId::Num; i++)
+		{
+			if (pass.writes & (1 << i))
+				interface::Printf(" >%s", resourceNames[i]);
+		}
+
+		interface::Printf(pass.culled ? " CULLED\n" : "\n");
+
+		if (pass.culled)
+			continue;
+
+		// The G-buffer pass draws geometry. The others draw quads.
+		if (pass.id == RenderGraphPassId::Luminance)
+		{
+			nReducedSize += int(s_main->nLuminanceFrameBuffers + 1);
+		}
+		else if (pass.id == RenderGraphPassId::Bloom)
+		{
+			nReducedSize += int(s_main->nBloomFrameBuffers * 2 - 1);
+		}
+		else if (pass.id != RenderGraphPassId::GBuffer)
+		{
+			nFullSize++;
+		}
+	}
+
+	interface::Printf("%d full size passes, %d reduced size passes\n", nFullSize, nReducedSize);
+
+	// Transient texture memory at the current window size, and what it would be if each resource had its own texture.
+	size_t memory = 0, unaliasedMemory = 0;
+
+	for (const RenderGraph::TransientTexture &texture : graph.textures)
+	{
+		bgfx::TextureInfo info;
+		bgfx::calcTextureSize(info, window::GetWidth(), window::GetHeight(), 1, false, false, 1, texture.format);
+		memory += info.storageSize;
+	}
+
+	for (int i = RenderGraphResourceId::FirstTransient; i < RenderGraphResourceId::Num; i++)
+	{
+		if (!bgfx::isValid(graph.resourceTextures[i]))
+			continue;
+
+		bgfx::TextureInfo info;
+		bgfx::calcTextureSize(info, window::GetWidth(), window::GetHeight(), 1, false, false, 1, graph.formats[i]);
+		unaliasedMemory += info.storageSize;
+	}
+
+	interface::Printf("%d transient textures, %.2fMB (%.2fMB without aliasing)\n", (int)graph.textures.size(), memory / 1024.0 / 1024.0, unaliasedMemory / 1024.0 / 1024.0);
+
+	if (s_main->dynamicResolutionEnabled)
+	{
+		interface::Printf("Dynamic resolution scale %.2f, frame time %.2fms\n", s_main->dynamicResolutionScale, s_main->dynamicResolutionFrameTime);
+	}
+}
+
+static void Cmd_PrintShaderCache()
+{
+	bgfxCallback.shaderCache.printStatistics();
+}
+
+static void Cmd_PrintShaderPrograms()
+{
+	int nPrograms = 0;
+
+	for (int i = 0; i < ShaderProgramId::Num; i++)
+	{
+		if (!bgfx::isValid(s_main->shaderPrograms[i].handle))
+			continue;
+
+		interface::Printf("%d: %s\n", i, s_fragmentShaderNames[s_shaderProgramMap[i].frag]);
+		nPrograms++;
+	}
+
+	int nShaders = 0;
+
+	for (const Shader &shader : s_main->fragmentShaders)
+	{
+		if (bgfx::isValid(shader.handle))
+			nShaders++;
+	}
+
+	for (const Shader &shader : s_main->vertexShaders)
+	{
+		if (bgfx::isValid(shader.handle))
+			nShaders++;
+	}
+
+	interface::Printf("%d of %d shader programs resident, %d shaders\n", nPrograms, (int)ShaderProgramId::Num, nShaders);
+}
+
+static void Cmd_PrintTextureMemory()
+{
+	g_textureCache->printResidency();
+}
+
 static void Cmd_Screenshot()
 {
 	TakeScreenshot("tga");
@@ -234,11 +687,47 @@ static void Cmd_ScreenshotPNG()
 	TakeScreenshot("png");
 }
 
-struct ShaderProgramIdMap
+static void Cmd_TestInlineFog()
 {
-	FragmentShaderId::Enum frag;
-	VertexShaderId::Enum vert;
-};
+	if (!world::IsLoaded())
+	{
+		interface::Printf("No world loaded\n");
+		return;
+	}
+
+	if (s_main->fastPathEnabled)
+	{
+		interface::Printf("Not supported with r_fastPath\n");
+		return;
+	}
+
+	if ((bgfx::getCaps()->supported & BGFX_CAPS_TEXTURE_READ_BACK) == 0)
+	{
+		interface::Printf("Texture read back not supported\n");
+		return;
+	}
+
+	if (s_main->inlineFogTest.readFrameNo == 0)
+		s_main->inlineFogTest.requested = true;
+}
+
+static void Cmd_TestShaderCache()
+{
+	// Use a scratch directory so the real cache and its statistics aren't touched.
+	const std::string directory = std::string(interface::Cvar_Get("fs_homepath", "", 0).getString()) + "/bgfx_shadercache_test";
+	ShaderCache::runTests(directory.c_str());
+}
+
+static void Cmd_WriteMaterialShapes()
+{
+	if (g_materialCache)
+		g_materialCache->writeMaterialShapes();
+}
+
+static void Cmd_WriteShaderWarmup()
+{
+	WriteShaderWarmupList();
+}
 
 void Initialize()
 {
@@ -259,8 +748,33 @@ void Initialize()
 	s_main->extraDynamicLightsEnabled = extraDynamicLights.getBool();
 	ConsoleVariable fastPath = interface::Cvar_Get("r_fastPath", "0", ConsoleVariableFlags::Archive | ConsoleVariableFlags::Latch);
 	s_main->fastPathEnabled = fastPath.getBool();
+	ConsoleVariable hdr = interface::Cvar_Get("r_hdr", "0", ConsoleVariableFlags::Archive | ConsoleVariableFlags::Latch);
+	hdr.setDescription(
+		"0  Off\n"
+		"1  RG11B10F scene color, same bandwidth as off\n"
+		"2  RGBA16F scene color, twice the bandwidth of off. Keeps destination alpha\n");
+	hdr.checkRange(0, 2, true);
+	s_main->hdrEnabled = hdr.getInt() != 0;
+
+	if (hdr.getInt() == 1)
+	{
+		s_main->sceneColorFormat = bgfx::TextureFormat::RG11B10F;
+	}
+	else if (hdr.getInt() == 2)
+	{
+		s_main->sceneColorFormat = bgfx::TextureFormat::RGBA16F;
+	}
+
 	ConsoleVariable lerpTextureAnimation = interface::Cvar_Get("r_lerpTextureAnimation", "0", ConsoleVariableFlags::Archive | ConsoleVariableFlags::Latch);
 	s_main->lerpTextureAnimationEnabled = lerpTextureAnimation.getBool();
+	ConsoleVariable lighting = interface::Cvar_Get("r_lighting", "forward", ConsoleVariableFlags::Archive | ConsoleVariableFlags::Latch);
+	lighting.setDescription(
+		"forward   Dynamic lights are calculated when drawing each surface\n"
+		"deferred  Opaque surfaces are written to a G-buffer and lit by dynamic lights in a single screen space pass\n");
+	s_main->deferredLightingEnabled = util::Stricmp(lighting.getString(), "deferred") == 0;
+	ConsoleVariable dynamicResolution = interface::Cvar_Get("r_dynamicResolution", "0", ConsoleVariableFlags::Archive | ConsoleVariableFlags::Latch);
+	dynamicResolution.setDescription("Render the world scene at a lower resolution when the frame rate drops below r_dynamicResolutionTargetFps, and upscale it.");
+	s_main->dynamicResolutionEnabled = dynamicResolution.getBool();
 	ConsoleVariable maxAnisotropy = interface::Cvar_Get("r_maxAnisotropy", "0", ConsoleVariableFlags::Archive | ConsoleVariableFlags::Latch);
 	s_main->maxAnisotropyEnabled = maxAnisotropy.getBool();
 	ConsoleVariable softSprites = interface::Cvar_Get("r_softSprites", "1", ConsoleVariableFlags::Archive | ConsoleVariableFlags::Latch);
@@ -275,7 +789,11 @@ void Initialize()
 		// Fast path disables all the fancy features without messing with their cvars.
 		s_main->aa = AntiAliasing::None;
 		s_main->bloomEnabled = false;
+		s_main->deferredLightingEnabled = false;
+		s_main->dynamicResolutionEnabled = false;
 		s_main->extraDynamicLightsEnabled = false;
+		s_main->hdrEnabled = false;
+		s_main->sceneColorFormat = bgfx::TextureFormat::BGRA8;
 		s_main->lerpTextureAnimationEnabled = false;
 		s_main->maxAnisotropyEnabled = false;
 		s_main->softSpritesEnabled = false;
@@ -283,9 +801,24 @@ void Initialize()
 		s_main->waterReflectionsEnabled = false;
 	}
 
+	interface::Cmd_Add("r_benchmarkDynamicLights", Cmd_BenchmarkDynamicLights);
+	interface::Cmd_Add("r_benchmarkMaterialStages", Cmd_BenchmarkMaterialStages);
+	interface::Cmd_Add("r_benchmarkMipmaps", Cmd_BenchmarkMipmaps);
+	interface::Cmd_Add("r_benchmarkShaderIndex", Cmd_BenchmarkShaderIndex);
+	interface::Cmd_Add("r_buildImageCache", Cmd_BuildImageCache);
 	interface::Cmd_Add("r_captureFrame", Cmd_CaptureFrame);
 	interface::Cmd_Add("r_pickMaterial", Cmd_PickMaterial);
+	interface::Cmd_Add("r_printDynamicLightStats", Cmd_PrintDynamicLightStats);
 	interface::Cmd_Add("r_printMaterials", Cmd_PrintMaterials);
+	interface::Cmd_Add("r_printMaterialShapes", Cmd_PrintMaterialShapes);
+	interface::Cmd_Add("r_printRenderGraph", Cmd_PrintRenderGraph);
+	interface::Cmd_Add("r_printShaderCache", Cmd_PrintShaderCache);
+	interface::Cmd_Add("r_printShaderPrograms", Cmd_PrintShaderPrograms);
+	interface::Cmd_Add("r_printTextureMemory", Cmd_PrintTextureMemory);
+	interface::Cmd_Add("r_testInlineFog", Cmd_TestInlineFog);
+	interface::Cmd_Add("r_testShaderCache", Cmd_TestShaderCache);
+	interface::Cmd_Add("r_writeMaterialShapes", Cmd_WriteMaterialShapes);
+	interface::Cmd_Add("r_writeShaderWarmup", Cmd_WriteShaderWarmup);
 	interface::Cmd_Add("screenshot", Cmd_Screenshot);
 	interface::Cmd_Add("screenshotJPEG", Cmd_ScreenshotJPEG);
 	interface::Cmd_Add("screenshotPNG", Cmd_ScreenshotPNG);
@@ -374,6 +907,13 @@ void Initialize()
 		
 		bgfx::renderFrame(); // Don't create render thread.
 
+		if (g_cvars.shaderCache.getBool())
+		{
+			// Binaries are specific to the driver, so keep them out of the game directory.
+			const std::string directory = std::string(interface::Cvar_Get("fs_homepath", "", 0).getString()) + "/bgfx_shadercache";
+			bgfxCallback.shaderCache.initialize(directory.c_str(), (uint64_t)g_cvars.shaderCacheSize.getInt() * 1024 * 1024);
+		}
+
 		init.callback = &bgfxCallback;
 		init.type = selectedBackend;
 		init.resolution.width = (uint32_t)window::GetWidth();
@@ -413,6 +953,37 @@ void Initialize()
 		interface::Error("R16U texture format not supported");
 	}
 
+	if (s_main->hdrEnabled)
+	{
+		const uint16_t rtCaps = BGFX_CAPS_FORMAT_TEXTURE_FRAMEBUFFER | (IsMsaa(s_main->aa) ? BGFX_CAPS_FORMAT_TEXTURE_FRAMEBUFFER_MSAA : 0);
+
+		if (s_main->sceneColorFormat == bgfx::TextureFormat::RG11B10F && (caps->formats[bgfx::TextureFormat::RG11B10F] & rtCaps) != rtCaps)
+		{
+			interface::PrintWarningf("RG11B10F frame buffers not supported, using RGBA16F for HDR\n");
+			s_main->sceneColorFormat = bgfx::TextureFormat::RGBA16F;
+		}
+
+		if ((caps->formats[s_main->sceneColorFormat] & rtCaps) != rtCaps || (caps->formats[bgfx::TextureFormat::R16F] & BGFX_CAPS_FORMAT_TEXTURE_FRAMEBUFFER) == 0)
+		{
+			interface::PrintWarningf("Float frame buffers not supported, HDR disabled\n");
+			s_main->hdrEnabled = false;
+			s_main->sceneColorFormat = bgfx::TextureFormat::BGRA8;
+		}
+	}
+
+	// Collapsed layers are clamped when they're blended in the shader. HDR frame buffer blends aren't, so overbright layers would look different depending on whether they were collapsed.
+	s_main->collapseStagesEnabled = g_cvars.collapseStages.getBool() && !s_main->hdrEnabled;
+
+	// The G-buffer has albedo, normal and depth attachments. The noop backend reports every cap, so r_backend noop runs the deferred path.
+	if (s_main->deferredLightingEnabled)
+	{
+		if (caps->limits.maxFBAttachments < 3 || (caps->formats[bgfx::TextureFormat::BGRA8] & BGFX_CAPS_FORMAT_TEXTURE_FRAMEBUFFER) == 0 || (caps->formats[bgfx::TextureFormat::D24S8] & BGFX_CAPS_FORMAT_TEXTURE_FRAMEBUFFER) == 0)
+		{
+			interface::PrintWarningf("G-buffer frame buffers not supported, using forward lighting\n");
+			s_main->deferredLightingEnabled = false;
+		}
+	}
+
 	s_main->debugDraw = DebugDrawFromString(g_cvars.debugDraw.getString());
 	s_main->halfTexelOffset = caps->rendererType == bgfx::RendererType::Direct3D9 ? 0.5f : 0;
 	Vertex::init();
@@ -429,48 +1000,52 @@ void Initialize()
 	s_main->dlightManager = std::make_unique<DynamicLightManager>();
 
 	// Get shader ID to shader source string mappings.
-	std::array<ShaderSourceMem, FragmentShaderId::Num> fragMem;
-	std::array<ShaderSourceMem, VertexShaderId::Num> vertMem;
-
 	if (caps->rendererType == bgfx::RendererType::OpenGL)
 	{
-		fragMem = GetFragmentShaderSourceMap_gl();
-		vertMem = GetVertexShaderSourceMap_gl();
+		s_fragmentShaderSource = GetFragmentShaderSourceMap_gl();
+		s_vertexShaderSource = GetVertexShaderSourceMap_gl();
 	}
 	else if (caps->rendererType == bgfx::RendererType::Vulkan)
 	{
-		fragMem = GetFragmentShaderSourceMap_vk();
-		vertMem = GetVertexShaderSourceMap_vk();
+		s_fragmentShaderSource = GetFragmentShaderSourceMap_vk();
+		s_vertexShaderSource = GetVertexShaderSourceMap_vk();
 	}
 #ifdef WIN32
 	else if (caps->rendererType == bgfx::RendererType::Direct3D11 || caps->rendererType == bgfx::RendererType::Direct3D12)
 	{
-		fragMem = GetFragmentShaderSourceMap_d3d11();
-		vertMem = GetVertexShaderSourceMap_d3d11();
+		s_fragmentShaderSource = GetFragmentShaderSourceMap_d3d11();
+		s_vertexShaderSource = GetVertexShaderSourceMap_d3d11();
 	}
 #endif
 
 	// Map shader programs to their vertex and fragment shaders.
-	std::array<ShaderProgramIdMap, ShaderProgramId::Num> programMap;
-	programMap[ShaderProgramId::Bloom] = { FragmentShaderId::Bloom, VertexShaderId::Texture };
-	programMap[ShaderProgramId::Color] = { FragmentShaderId::Color, VertexShaderId::Color };
-	programMap[ShaderProgramId::Depth] = { FragmentShaderId::Depth, VertexShaderId::Depth };
+	s_shaderProgramMap[ShaderProgramId::BloomDownsample] = { FragmentShaderId::BloomDownsample, VertexShaderId::Texture };
+	s_shaderProgramMap[ShaderProgramId::BloomUpsample] = { FragmentShaderId::BloomUpsample, VertexShaderId::Texture };
+	s_shaderProgramMap[ShaderProgramId::Color] = { FragmentShaderId::Color, VertexShaderId::Color };
 
-	programMap[ShaderProgramId::Depth + DepthShaderProgramVariant::AlphaTest] =
+	for (int i = 0; i < CompositeShaderProgramVariant::Num; i++)
+	{
+		s_shaderProgramMap[ShaderProgramId::Composite + i] = { FragmentShaderId::Enum(FragmentShaderId::Composite + i), VertexShaderId::Texture };
+	}
+
+	s_shaderProgramMap[ShaderProgramId::DeferredLight] = { FragmentShaderId::DeferredLight, VertexShaderId::Texture };
+	s_shaderProgramMap[ShaderProgramId::Depth] = { FragmentShaderId::Depth, VertexShaderId::Depth };
+
+	s_shaderProgramMap[ShaderProgramId::Depth + DepthShaderProgramVariant::AlphaTest] =
 	{
 		FragmentShaderId::Depth_AlphaTest,
 		VertexShaderId::Depth_AlphaTest
 	};
 
-	programMap[ShaderProgramId::Fog] = { FragmentShaderId::Fog, VertexShaderId::Fog };
-	programMap[ShaderProgramId::Fog + FogShaderProgramVariant::Bloom] = { FragmentShaderId::Fog_Bloom, VertexShaderId::Fog };
+	s_shaderProgramMap[ShaderProgramId::Fog] = { FragmentShaderId::Fog, VertexShaderId::Fog };
+	s_shaderProgramMap[ShaderProgramId::Fog + FogShaderProgramVariant::Bloom] = { FragmentShaderId::Fog_Bloom, VertexShaderId::Fog };
 
-	programMap[ShaderProgramId::GaussianBlur] = { FragmentShaderId::GaussianBlur, VertexShaderId::Texture };
+	s_shaderProgramMap[ShaderProgramId::GBuffer] = { FragmentShaderId::GBuffer, VertexShaderId::Generic };
 
 	// Sync with GenericShaderProgramVariant.
 	for (int i = 0; i < GenericFragmentShaderVariant::Num; i++)
 	{
-		ShaderProgramIdMap &pm = programMap[ShaderProgramId::Generic + i];
+		ShaderProgramIdMap &pm = s_shaderProgramMap[ShaderProgramId::Generic + i];
 		pm.frag = FragmentShaderId::Enum(FragmentShaderId::Generic + i);
 
 		if (i & GenericFragmentShaderVariant::SunLight)
@@ -479,16 +1054,29 @@ void Initialize()
 			pm.vert = VertexShaderId::Generic;
 	}
 
-	programMap[ShaderProgramId::SMAABlendingWeightCalculation] = { FragmentShaderId::SMAABlendingWeightCalculation, VertexShaderId::SMAABlendingWeightCalculation };
-	programMap[ShaderProgramId::SMAAEdgeDetection] = { FragmentShaderId::SMAAEdgeDetection, VertexShaderId::SMAAEdgeDetection };
-	programMap[ShaderProgramId::SMAANeighborhoodBlending] = { FragmentShaderId::SMAANeighborhoodBlending, VertexShaderId::SMAANeighborhoodBlending };
-	programMap[ShaderProgramId::Texture] = { FragmentShaderId::Texture, VertexShaderId::Texture };
-	programMap[ShaderProgramId::TextureColor] = { FragmentShaderId::TextureColor, VertexShaderId::Texture };
-	programMap[ShaderProgramId::TextureDebug] = { FragmentShaderId::TextureDebug, VertexShaderId::Texture };
+	// Material shape fragment shaders follow the generic variants.
+	for (int i = 0; i < MaterialShapeId::Num * GenericShapeFragmentShaderVariant::Num; i++)
+	{
+		s_shaderProgramMap[ShaderProgramId::GenericShape + i] =
+		{
+			FragmentShaderId::Enum(FragmentShaderId::Generic + GenericFragmentShaderVariant::Num + i),
+			VertexShaderId::Generic
+		};
+	}
+
+	s_shaderProgramMap[ShaderProgramId::Luminance] = { FragmentShaderId::Luminance, VertexShaderId::Texture };
+	s_shaderProgramMap[ShaderProgramId::Sharpen] = { FragmentShaderId::Sharpen, VertexShaderId::Texture };
+	s_shaderProgramMap[ShaderProgramId::SMAABlendingWeightCalculation] = { FragmentShaderId::SMAABlendingWeightCalculation, VertexShaderId::SMAABlendingWeightCalculation };
+	s_shaderProgramMap[ShaderProgramId::SMAAEdgeDetection] = { FragmentShaderId::SMAAEdgeDetection, VertexShaderId::SMAAEdgeDetection };
+	s_shaderProgramMap[ShaderProgramId::SMAANeighborhoodBlending] = { FragmentShaderId::SMAANeighborhoodBlending, VertexShaderId::SMAANeighborhoodBlending };
+	s_shaderProgramMap[ShaderProgramId::SMAANeighborhoodBlending + SMAANeighborhoodBlendingShaderProgramVariant::Bloom] = { FragmentShaderId::SMAANeighborhoodBlending_Bloom, VertexShaderId::SMAANeighborhoodBlending };
+	s_shaderProgramMap[ShaderProgramId::Texture] = { FragmentShaderId::Texture, VertexShaderId::Texture };
+	s_shaderProgramMap[ShaderProgramId::TextureColor] = { FragmentShaderId::TextureColor, VertexShaderId::Texture };
+	s_shaderProgramMap[ShaderProgramId::TextureDebug] = { FragmentShaderId::TextureDebug, VertexShaderId::Texture };
 
 	for (int i = 0; i < TextureVariationShaderProgramVariant::Num; i++)
 	{
-		ShaderProgramIdMap &pm = programMap[ShaderProgramId::TextureVariation + i];
+		ShaderProgramIdMap &pm = s_shaderProgramMap[ShaderProgramId::TextureVariation + i];
 		pm.frag = FragmentShaderId::Enum(FragmentShaderId::TextureVariation + i);
 
 		if (i & TextureVariationFragmentShaderVariant::SunLight)
@@ -497,76 +1085,271 @@ void Initialize()
 			pm.vert = VertexShaderId::Generic;
 	}
 
-	// Create shader programs.
-	for (int i = 0; i < ShaderProgramId::Num; i++)
+	// Shader programs are created on first use. Create the ones in the warm-up list now so they don't cause a hitch when first drawn.
+	if (g_cvars.shaderWarmup.getBool())
+	{
+		ReadShaderWarmupList();
+	}
+}
+
+RenderGraph::~RenderGraph()
+{
+	for (const TransientTexture &texture : textures)
+		bgfx::destroy(texture.handle);
+}
+
+bool RenderGraph::isLive(RenderGraphPassId::Enum id) const
+{
+	for (const RenderGraphPass &pass : passes)
 	{
-		const ShaderProgramIdMap &pm = programMap[i];
+		if (pass.id == id)
+			return !pass.culled;
+	}
 
-		// Don't create shader programs that won't be used.
-		if (s_main->aa != AntiAliasing::SMAA && (i == ShaderProgramId::SMAABlendingWeightCalculation || i == ShaderProgramId::SMAAEdgeDetection || i == ShaderProgramId::SMAANeighborhoodBlending))
-			continue;
+	return false;
+}
+
+static uint32_t ResourceBit(RenderGraphResourceId::Enum id)
+{
+	return 1 << id;
+}
 
-		if (!s_main->bloomEnabled)
+static void DestroyFrameBuffer(FrameBuffer &frameBuffer)
+{
+	if (bgfx::isValid(frameBuffer.handle))
+	{
+		bgfx::destroy(frameBuffer.handle);
+		frameBuffer.handle = BGFX_INVALID_HANDLE;
+	}
+}
+
+/// Create a frame buffer from the transient textures of the given resources. Does nothing if a resource isn't used by a live pass.
+static void CreateFrameBuffer(FrameBuffer &frameBuffer, const RenderGraphResourceId::Enum *resources, uint8_t nResources)
+{
+	bgfx::TextureHandle textures[3];
+	assert(nResources <= BX_COUNTOF(textures));
+
+	for (uint8_t i = 0; i < nResources; i++)
+	{
+		textures[i] = s_main->renderGraph.resourceTextures[resources[i]];
+
+		if (!bgfx::isValid(textures[i]))
+			return;
+	}
+
+	// The render graph owns the textures.
+	frameBuffer.handle = bgfx::createFrameBuffer(nResources, textures, false);
+}
+
+void BuildRenderGraph()
+{
+	RenderGraph &graph = s_main->renderGraph;
+
+	// Release the previous graph's frame buffers and textures.
+	DestroyFrameBuffer(s_main->gBufferFb);
+	DestroyFrameBuffer(s_main->sceneScaledFb);
+	DestroyFrameBuffer(s_main->sceneTempFb);
+	DestroyFrameBuffer(s_main->smaaBlendFb);
+	DestroyFrameBuffer(s_main->smaaEdgesFb);
+
+	for (const RenderGraph::TransientTexture &texture : graph.textures)
+		bgfx::destroy(texture.handle);
+
+	graph.passes.clear();
+	graph.textures.clear();
+
+	for (int i = 0; i < RenderGraphResourceId::Num; i++)
+	{
+		graph.formats[i] = bgfx::TextureFormat::Unknown;
+		graph.resourceTextures[i] = BGFX_INVALID_HANDLE;
+	}
+
+	// The scene is rendered straight to the backbuffer.
+	if (s_main->fastPathEnabled)
+		return;
+
+	const uint32_t sceneColor = ResourceBit(RenderGraphResourceId::SceneColor);
+	const uint32_t sceneTemp = ResourceBit(RenderGraphResourceId::SceneTemp);
+	const uint32_t bloom = ResourceBit(RenderGraphResourceId::Bloom);
+	const uint32_t backbuffer = ResourceBit(RenderGraphResourceId::Backbuffer);
+	const uint32_t sceneScaled = ResourceBit(RenderGraphResourceId::SceneScaled);
+
+	// With dynamic resolution, the last pass writes the scaled scene, which is upscaled to the backbuffer by the upscale pass.
+	// Without SMAA or sharpening, the composite pass upscales straight to the backbuffer instead, saving a full size pass and texture.
+	const bool smaa = s_main->aa == AntiAliasing::SMAA;
+	const bool upscalePass = s_main->dynamicResolutionEnabled && (smaa || g_cvars.dynamicResolutionSharpen.getFloat() > 0);
+	const uint32_t output = upscalePass ? sceneScaled : backbuffer;
+
+	// Like the soft sprite depth buffer, the G-buffer is never MSAA.
+	if (s_main->deferredLightingEnabled)
+	{
+		const uint32_t gBuffer = ResourceBit(RenderGraphResourceId::GBufferAlbedo) | ResourceBit(RenderGraphResourceId::GBufferNormal) | ResourceBit(RenderGraphResourceId::GBufferDepth);
+		graph.formats[RenderGraphResourceId::GBufferAlbedo] = bgfx::TextureFormat::BGRA8;
+		graph.formats[RenderGraphResourceId::GBufferNormal] = bgfx::TextureFormat::BGRA8;
+		graph.formats[RenderGraphResourceId::GBufferDepth] = bgfx::TextureFormat::D24S8;
+		graph.passes.push_back({ RenderGraphPassId::GBuffer, ShaderProgramId::Num, 0, gBuffer });
+		graph.passes.push_back({ RenderGraphPassId::DeferredLight, ShaderProgramId::DeferredLight, gBuffer, sceneColor });
+	}
+
+	if (s_main->hdrEnabled)
+	{
+		graph.passes.push_back({ RenderGraphPassId::Luminance, ShaderProgramId::Luminance, sceneColor, ResourceBit(RenderGraphResourceId::AdaptedLuminance) });
+	}
+
+	if (s_main->bloomEnabled)
+	{
+		// OpenGL resolves multisampled bloom into a temp texture, in the bloom attachment format.
+		if (bgfx::getRendererType() == bgfx::RendererType::OpenGL && IsMsaa(s_main->aa))
 		{
-			if (i == ShaderProgramId::Bloom || i == ShaderProgramId::GaussianBlur)
-				continue;
-			if (i == ShaderProgramId::Fog + FogShaderProgramVariant::Bloom)
-				continue;
-			if (i == ShaderProgramId::TextureVariation)
-			{
-				const int variant = i - (int)ShaderProgramId::TextureVariation;
-				if (variant & TextureVariationShaderProgramVariant::Bloom)
-					continue;
-			}
+			graph.formats[RenderGraphResourceId::SceneTemp] = s_main->sceneColorFormat;
+			graph.passes.push_back({ RenderGraphPassId::BloomMsaaResolve, ShaderProgramId::Num, sceneColor, sceneTemp });
+			graph.passes.push_back({ RenderGraphPassId::Bloom, ShaderProgramId::Num, sceneTemp, bloom });
+		}
+		else
+		{
+			graph.passes.push_back({ RenderGraphPassId::Bloom, ShaderProgramId::Num, sceneColor, bloom });
 		}
+	}
 
-		if (i >= (int)ShaderProgramId::Generic && i <= int(ShaderProgramId::Generic + GenericShaderProgramVariant::Num))
+	// SMAA needs tone mapped input, so HDR is composited into a temp BGRA8 texture first. Otherwise bloom is added by SMAA neighborhood blending.
+	uint32_t smaaColor = sceneColor;
+	int smaaVariant = SMAANeighborhoodBlendingShaderProgramVariant::None;
+
+	if (!smaa || s_main->hdrEnabled)
+	{
+		int variant = CompositeShaderProgramVariant::None;
+		uint32_t reads = sceneColor;
+
+		if (s_main->bloomEnabled)
 		{
-			const int variant = i - (int)ShaderProgramId::Generic;
+			variant |= CompositeShaderProgramVariant::Bloom;
+			reads |= bloom;
+		}
 
-			if (!s_main->bloomEnabled && (variant & GenericShaderProgramVariant::Bloom))
-				continue;
+		if (s_main->hdrEnabled)
+		{
+			variant |= CompositeShaderProgramVariant::ToneMap;
 
-			if (!s_main->sunLightEnabled && (variant & GenericShaderProgramVariant::SunLight))
-				continue;
+			// The luminance pass is culled if auto exposure is disabled.
+			if (g_cvars.hdrAutoExposure.getBool())
+				reads |= ResourceBit(RenderGraphResourceId::AdaptedLuminance);
+		}
 
-			if (!s_main->softSpritesEnabled && (variant & GenericShaderProgramVariant::SoftSprite))
-				continue;
+		if (smaa)
+		{
+			graph.formats[RenderGraphResourceId::SceneTemp] = bgfx::TextureFormat::BGRA8;
+			smaaColor = sceneTemp;
 		}
 
-		Shader &fragment = s_main->fragmentShaders[pm.frag];
+		graph.passes.push_back({ RenderGraphPassId::Composite, ShaderProgramId::Enum(ShaderProgramId::Composite + variant), reads, smaa ? sceneTemp : output });
+	}
+	else if (s_main->bloomEnabled)
+	{
+		smaaVariant |= SMAANeighborhoodBlendingShaderProgramVariant::Bloom;
+	}
 
-		if (!bgfx::isValid(fragment.handle))
+	if (smaa)
+	{
+		const uint32_t smaaEdges = ResourceBit(RenderGraphResourceId::SMAAEdges);
+		const uint32_t smaaBlend = ResourceBit(RenderGraphResourceId::SMAABlend);
+		graph.formats[RenderGraphResourceId::SMAAEdges] = bgfx::TextureFormat::RG8;
+		graph.formats[RenderGraphResourceId::SMAABlend] = bgfx::TextureFormat::BGRA8;
+		graph.passes.push_back({ RenderGraphPassId::SMAAEdgeDetection, ShaderProgramId::SMAAEdgeDetection, smaaColor, smaaEdges });
+		graph.passes.push_back({ RenderGraphPassId::SMAABlendingWeightCalculation, ShaderProgramId::SMAABlendingWeightCalculation, smaaEdges, smaaBlend });
+		graph.passes.push_back({ RenderGraphPassId::SMAANeighborhoodBlending, ShaderProgramId::Enum(ShaderProgramId::SMAANeighborhoodBlending + smaaVariant), smaaColor | smaaBlend | (smaaVariant ? bloom : 0), output });
+	}
+
+	if (upscalePass)
+	{
+		// The sharpen shader skips the sharpen taps when r_dynamicResolutionSharpen is 0.
+		graph.formats[RenderGraphResourceId::SceneScaled] = bgfx::TextureFormat::BGRA8;
+		graph.passes.push_back({ RenderGraphPassId::Upscale, ShaderProgramId::Sharpen, sceneScaled, backbuffer });
+	}
+
+	// Cull passes that don't contribute to the backbuffer, walking back from the last pass.
+	uint32_t required = backbuffer;
+
+	for (int i = (int)graph.passes.size() - 1; i >= 0; i--)
+	{
+		RenderGraphPass &pass = graph.passes[i];
+		pass.culled = (pass.writes & required) == 0;
+
+		if (!pass.culled)
+			required |= pass.reads;
+	}
+
+	// The lifetime of each transient resource is from the first to the last live pass that uses it.
+	int firstUse[RenderGraphResourceId::Num], lastUse[RenderGraphResourceId::Num];
+
+	for (int i = 0; i < RenderGraphResourceId::Num; i++)
+	{
+		firstUse[i] = lastUse[i] = -1;
+	}
+
+	for (int i = 0; i < (int)graph.passes.size(); i++)
+	{
+		const RenderGraphPass &pass = graph.passes[i];
+
+		if (pass.culled)
+			continue;
+
+		for (int j = RenderGraphResourceId::FirstTransient; j < RenderGraphResourceId::Num; j++)
 		{
-			fragment.handle = bgfx::createShader(bgfx::makeRef(fragMem[pm.frag].mem, (uint32_t)fragMem[pm.frag].size));
+			if (!((pass.reads | pass.writes) & (1 << j)))
+				continue;
 
-			if (!bgfx::isValid(fragment.handle))
-				interface::Error("Error creating fragment shader");
+			if (firstUse[j] == -1)
+				firstUse[j] = i;
 
-#ifdef _DEBUG
-			bgfx::setName(fragment.handle, s_fragmentShaderNames[pm.frag]);
-#endif
+			lastUse[j] = i;
 		}
+	}
 
-		Shader &vertex = s_main->vertexShaders[pm.vert];
-	
-		if (!bgfx::isValid(vertex.handle))
+	// Resources with the same format and non-overlapping lifetimes share a texture. Resources are assigned in the order they're first used.
+	std::vector<int> textureLastUse;
+
+	for (int i = 0; i < (int)graph.passes.size(); i++)
+	{
+		for (int j = RenderGraphResourceId::FirstTransient; j < RenderGraphResourceId::Num; j++)
 		{
-			vertex.handle = bgfx::createShader(bgfx::makeRef(vertMem[pm.vert].mem, (uint32_t)vertMem[pm.vert].size));
+			if (firstUse[j] != i)
+				continue;
 
-			if (!bgfx::isValid(vertex.handle))
-				interface::Error("Error creating vertex shader");
+			size_t k;
 
-#ifdef _DEBUG
-			bgfx::setName(vertex.handle, s_vertexShaderNames[pm.vert]);
-#endif
-		}
+			for (k = 0; k < graph.textures.size(); k++)
+			{
+				if (graph.textures[k].format == graph.formats[j] && textureLastUse[k] < i)
+					break;
+			}
 
-		s_main->shaderPrograms[i].handle = bgfx::createProgram(vertex.handle, fragment.handle);
+			if (k == graph.textures.size())
+			{
+				RenderGraph::TransientTexture texture;
+				texture.format = graph.formats[j];
+				texture.handle = bgfx::createTexture2D(bgfx::BackbufferRatio::Equal, false, 1, texture.format, BGFX_TEXTURE_RT | BGFX_SAMPLER_U_CLAMP | BGFX_SAMPLER_V_CLAMP);
+				graph.textures.push_back(texture);
+				textureLastUse.push_back(-1);
+			}
 
-		if (!bgfx::isValid(s_main->shaderPrograms[i].handle))
-			interface::Error("Error creating shader program");
+			graph.resourceTextures[j] = graph.textures[k].handle;
+			textureLastUse[k] = lastUse[j];
+		}
 	}
+
+	const RenderGraphResourceId::Enum gBufferResources[] = { RenderGraphResourceId::GBufferAlbedo, RenderGraphResourceId::GBufferNormal, RenderGraphResourceId::GBufferDepth };
+	const RenderGraphResourceId::Enum sceneScaledResource = RenderGraphResourceId::SceneScaled;
+	const RenderGraphResourceId::Enum sceneTempResource = RenderGraphResourceId::SceneTemp;
+	const RenderGraphResourceId::Enum smaaBlendResource = RenderGraphResourceId::SMAABlend;
+	const RenderGraphResourceId::Enum smaaEdgesResource = RenderGraphResourceId::SMAAEdges;
+	CreateFrameBuffer(s_main->gBufferFb, gBufferResources, BX_COUNTOF(gBufferResources));
+	CreateFrameBuffer(s_main->sceneScaledFb, &sceneScaledResource, 1);
+	CreateFrameBuffer(s_main->sceneTempFb, &sceneTempResource, 1);
+	CreateFrameBuffer(s_main->smaaBlendFb, &smaaBlendResource, 1);
+	CreateFrameBuffer(s_main->smaaEdgesFb, &smaaEdgesResource, 1);
+
+	// The adapted luminance is stale if the luminance pass was culled.
+	s_main->resetLuminanceAdaptation = true;
 }
 
 void LoadWorld(const char *name)
@@ -594,33 +1377,43 @@ void LoadWorld(const char *name)
 	if (s_main->bloomEnabled)
 	{
 		bgfx::TextureHandle sceneTextures[3];
-		sceneTextures[0] = bgfx::createTexture2D(bgfx::BackbufferRatio::Equal, false, 1, bgfx::TextureFormat::BGRA8, rtClampFlags | aaFlags);
-		sceneTextures[1] = bgfx::createTexture2D(bgfx::BackbufferRatio::Equal, false, 1, bgfx::TextureFormat::BGRA8, rtClampFlags | aaFlags);
+		sceneTextures[0] = bgfx::createTexture2D(bgfx::BackbufferRatio::Equal, false, 1, s_main->sceneColorFormat, rtClampFlags | aaFlags);
+		sceneTextures[1] = bgfx::createTexture2D(bgfx::BackbufferRatio::Equal, false, 1, s_main->sceneColorFormat, rtClampFlags | aaFlags);
 		sceneTextures[2] = bgfx::createTexture2D(bgfx::BackbufferRatio::Equal, false, 1, bgfx::TextureFormat::D24S8, BGFX_TEXTURE_RT | aaFlags);
 		s_main->sceneFb.handle = bgfx::createFrameBuffer(3, sceneTextures, true);
 		s_main->sceneBloomAttachment = 1;
 		s_main->sceneDepthAttachment = 2;
 
-		// Bloom needs a temp BGRA8 destination for SMAA. GL needs it for MSAA resolve.
-		if (s_main->aa == AntiAliasing::SMAA || (bgfx::getRendererType() == bgfx::RendererType::OpenGL && IsMsaa(s_main->aa)))
-		{
-			s_main->sceneTempFb.handle = bgfx::createFrameBuffer(bgfx::BackbufferRatio::Equal, bgfx::TextureFormat::BGRA8, rtClampFlags);
-		}
+		const bgfx::BackbufferRatio::Enum bloomRatios[] = { bgfx::BackbufferRatio::Quarter, bgfx::BackbufferRatio::Eighth, bgfx::BackbufferRatio::Sixteenth };
 
 		for (size_t i = 0; i < s_main->nBloomFrameBuffers; i++)
 		{
-			s_main->bloomFb[i].handle = bgfx::createFrameBuffer(bgfx::BackbufferRatio::Quarter, bgfx::TextureFormat::BGRA8, rtClampFlags);
+			s_main->bloomFb[i].handle = bgfx::createFrameBuffer(bloomRatios[i], s_main->sceneColorFormat, rtClampFlags);
 		}
 	}
 	else if (!s_main->fastPathEnabled)
 	{
 		bgfx::TextureHandle sceneTextures[2];
-		sceneTextures[0] = bgfx::createTexture2D(bgfx::BackbufferRatio::Equal, false, 1, bgfx::TextureFormat::BGRA8, rtClampFlags | aaFlags);
+		sceneTextures[0] = bgfx::createTexture2D(bgfx::BackbufferRatio::Equal, false, 1, s_main->sceneColorFormat, rtClampFlags | aaFlags);
 		sceneTextures[1] = bgfx::createTexture2D(bgfx::BackbufferRatio::Equal, false, 1, bgfx::TextureFormat::D24S8, BGFX_TEXTURE_RT | aaFlags);
 		s_main->sceneFb.handle = bgfx::createFrameBuffer(2, sceneTextures, true);
 		s_main->sceneDepthAttachment = 1;
 	}
 
+	if (s_main->hdrEnabled)
+	{
+		for (size_t i = 0; i < s_main->nLuminanceFrameBuffers; i++)
+		{
+			const uint16_t size = s_main->luminanceFbSize >> (i * 2);
+			s_main->luminanceFb[i].handle = bgfx::createFrameBuffer(size, size, bgfx::TextureFormat::R16F, rtClampFlags);
+		}
+
+		for (size_t i = 0; i < 2; i++)
+			s_main->adaptedLuminanceFb[i].handle = bgfx::createFrameBuffer(1, 1, bgfx::TextureFormat::R16F, rtClampFlags);
+
+		s_main->resetLuminanceAdaptation = true;
+	}
+
 	if (s_main->waterReflectionsEnabled)
 	{
 		bgfx::TextureHandle reflectionTexture = bgfx::createTexture2D(bgfx::BackbufferRatio::Equal, false, 1, bgfx::TextureFormat::BGRA8, rtClampFlags | aaFlags);
@@ -632,8 +1425,6 @@ void LoadWorld(const char *name)
 
 	if (s_main->aa == AntiAliasing::SMAA)
 	{
-		s_main->smaaBlendFb.handle = bgfx::createFrameBuffer(bgfx::BackbufferRatio::Equal, bgfx::TextureFormat::BGRA8, rtClampFlags);
-		s_main->smaaEdgesFb.handle = bgfx::createFrameBuffer(bgfx::BackbufferRatio::Equal, bgfx::TextureFormat::RG8, rtClampFlags);
 		s_main->smaaAreaTex = bgfx::createTexture2D(AREATEX_WIDTH, AREATEX_HEIGHT, false, 1, bgfx::TextureFormat::RG8, BGFX_SAMPLER_U_CLAMP | BGFX_SAMPLER_V_CLAMP, bgfx::makeRef(areaTexBytes, AREATEX_SIZE));
 		s_main->smaaSearchTex = bgfx::createTexture2D(SEARCHTEX_WIDTH, SEARCHTEX_HEIGHT, false, 1, bgfx::TextureFormat::R8, BGFX_SAMPLER_U_CLAMP | BGFX_SAMPLER_V_CLAMP, bgfx::makeRef(searchTexBytes, SEARCHTEX_SIZE));
 	}
@@ -643,6 +1434,11 @@ void LoadWorld(const char *name)
 		s_main->shadowMapFb.handle = bgfx::createFrameBuffer(s_main->shadowMapSize, s_main->shadowMapSize, bgfx::TextureFormat::D24S8, BGFX_SAMPLER_COMPARE_LEQUAL | rtClampFlags);
 	}
 
+	// Start at full resolution. Frame times measured while loading aren't representative.
+	s_main->dynamicResolutionScale = 1;
+	s_main->dynamicResolutionFrameTime = 0;
+	BuildRenderGraph();
+
 	// Load the world.
 	world::Load(name);
 	s_main->dlightManager->initializeGrid();
@@ -651,9 +1447,24 @@ void LoadWorld(const char *name)
 void Shutdown(bool destroyWindow)
 {
 	world::Unload();
+	interface::Cmd_Remove("r_benchmarkDynamicLights");
+	interface::Cmd_Remove("r_benchmarkMaterialStages");
+	interface::Cmd_Remove("r_benchmarkMipmaps");
+	interface::Cmd_Remove("r_benchmarkShaderIndex");
+	interface::Cmd_Remove("r_buildImageCache");
 	interface::Cmd_Remove("r_captureFrame");
 	interface::Cmd_Remove("r_pickMaterial");
+	interface::Cmd_Remove("r_printDynamicLightStats");
 	interface::Cmd_Remove("r_printMaterials");
+	interface::Cmd_Remove("r_printMaterialShapes");
+	interface::Cmd_Remove("r_printRenderGraph");
+	interface::Cmd_Remove("r_printShaderCache");
+	interface::Cmd_Remove("r_printShaderPrograms");
+	interface::Cmd_Remove("r_printTextureMemory");
+	interface::Cmd_Remove("r_testInlineFog");
+	interface::Cmd_Remove("r_testShaderCache");
+	interface::Cmd_Remove("r_writeMaterialShapes");
+	interface::Cmd_Remove("r_writeShaderWarmup");
 	interface::Cmd_Remove("screenshot");
 	interface::Cmd_Remove("screenshotJPEG");
 	interface::Cmd_Remove("screenshotPNG");
@@ -674,6 +1485,8 @@ void Shutdown(bool destroyWindow)
 		s_main.reset(nullptr);
 	}
 
+	bgfxCallback.shaderCache.flush();
+
 	if (destroyWindow)
 	{
 		bgfx::shutdown();
@@ -133,6 +133,17 @@ void Material::finish()
 
 	stageIndex = collapseStagesToGLSL();
 
+	if (main::IsCollapseStagesEnabled())
+	{
+		stageIndex = collapseStagesToLayers(stageIndex);
+	}
+
+	for (int i = 0; i < stageIndex; i++)
+	{
+		uint32_t key;
+		stages[i].shape = stages[i].getShapeKey(&key) ? main::FindMaterialShape(key) : -1;
+	}
+
 	if (lightmapIndex >= 0 && !hasLightmapStage)
 	{
 		interface::PrintDeveloperf("WARNING: material '%s' has lightmap but no lightmap stage!\n", name);
@@ -450,4 +461,157 @@ int Material::collapseStagesToGLSL()
 	return numStages;
 }
 
+/// @return The LAYER_BLEND_* equivalent of the stage's blend function, or 0 if there isn't one.
+static int GetLayerBlend(const MaterialStage &stage)
+{
+	if (stage.blendSrc == BGFX_STATE_BLEND_ONE && stage.blendDst == BGFX_STATE_BLEND_ONE)
+		return LAYER_BLEND_ADD;
+
+	if ((stage.blendSrc == BGFX_STATE_BLEND_DST_COLOR && stage.blendDst == BGFX_STATE_BLEND_ZERO) || (stage.blendSrc == BGFX_STATE_BLEND_ZERO && stage.blendDst == BGFX_STATE_BLEND_SRC_COLOR))
+		return LAYER_BLEND_MODULATE;
+
+	if (stage.blendSrc == BGFX_STATE_BLEND_SRC_ALPHA && stage.blendDst == BGFX_STATE_BLEND_INV_SRC_ALPHA)
+		return LAYER_BLEND_LERP;
+
+	return 0;
+}
+
+/// Layers are blended over the output of the stage they belong to, so it must replace what's in the framebuffer.
+static bool CanHaveLayers(const MaterialStage &stage)
+{
+	const bool opaque = (stage.blendSrc == 0 && stage.blendDst == 0) || (stage.blendSrc == BGFX_STATE_BLEND_ONE && stage.blendDst == BGFX_STATE_BLEND_ZERO);
+	return opaque && stage.alphaTest == MaterialAlphaTest::None && !stage.textureVariation;
+}
+
+static bool CanBeLayer(const MaterialStage &base, const MaterialStage &stage)
+{
+	const MaterialTextureBundle &bundle = stage.bundles[MaterialTextureBundleIndex::DiffuseMap];
+
+	if (!bundle.textures[0] || bundle.numImageAnimations > 1 || bundle.isVideoMap)
+		return false;
+
+	if (bundle.tcGen != MaterialTexCoordGen::Texture && bundle.tcGen != MaterialTexCoordGen::Lightmap && bundle.tcGen != MaterialTexCoordGen::EnvironmentMapped)
+		return false;
+
+	if (stage.light != MaterialLight::None || stage.alphaTest != MaterialAlphaTest::None || stage.textureVariation || stage.bloom != base.bloom)
+		return false;
+
+	// The layer must cover exactly the pixels the base stage wrote.
+	if (stage.depthWrite && !base.depthWrite)
+		return false;
+
+	if (stage.depthTestBits != base.depthTestBits && !(base.depthWrite && stage.depthTestBits == BGFX_STATE_DEPTH_TEST_EQUAL))
+		return false;
+
+	// Layer colors are uniforms, so vertex colors and colors calculated in the vertex shader aren't supported.
+	switch (stage.rgbGen)
+	{
+	case MaterialColorGen::Identity:
+	case MaterialColorGen::IdentityLighting:
+	case MaterialColorGen::Const:
+	case MaterialColorGen::Waveform:
+	case MaterialColorGen::Entity:
+	case MaterialColorGen::OneMinusEntity:
+		break;
+	default:
+		return false;
+	}
+
+	switch (stage.alphaGen)
+	{
+	case MaterialAlphaGen::Identity:
+	case MaterialAlphaGen::Skip:
+	case MaterialAlphaGen::Const:
+	case MaterialAlphaGen::Waveform:
+	case MaterialAlphaGen::Entity:
+	case MaterialAlphaGen::OneMinusEntity:
+		break;
+	default:
+		return false;
+	}
+
+	return GetLayerBlend(stage) != 0;
+}
+
+int Material::collapseStagesToLayers(int numStages)
+{
+	// Sky stages aren't drawn with the generic shader.
+	if (isSky)
+		return numStages;
+
+	MaterialStage collapsed[maxStages];
+	int nBaseStages = 0, nLayerStages = 0;
+
+	// Layer stages go after the base stages. Count the base stages first so layer indices are known.
+	bool isLayer[maxStages] = {};
+
+	for (int i = 0; i < numStages;)
+	{
+		MaterialStage &base = stages[i];
+		int j = i + 1;
+
+		if (CanHaveLayers(base))
+		{
+			for (; j < numStages && j - i - 1 < (int)MaterialStage::maxLayers && CanBeLayer(base, stages[j]); j++)
+				isLayer[j] = true;
+		}
+
+		nBaseStages++;
+		i = j;
+	}
+
+	if (nBaseStages == numStages)
+		return numStages;
+
+	int nBaseStagesCopied = 0;
+
+	for (int i = 0; i < numStages; i++)
+	{
+		if (isLayer[i])
+		{
+			MaterialStage &base = collapsed[nBaseStagesCopied - 1];
+			const int layerIndex = nBaseStages + nLayerStages;
+			base.layers[base.numLayers] = layerIndex;
+			base.layerBlends[base.numLayers] = GetLayerBlend(stages[i]);
+			base.numLayers++;
+			collapsed[layerIndex] = stages[i];
+			collapsed[layerIndex].active = false;
+			nLayerStages++;
+		}
+		else
+		{
+			collapsed[nBaseStagesCopied++] = stages[i];
+		}
+	}
+
+	const size_t nCollapsedStages = size_t(nBaseStages + nLayerStages);
+
+	for (size_t i = 0; i < maxStages; i++)
+	{
+		stages[i] = i < nCollapsedStages ? collapsed[i] : MaterialStage();
+		stages[i].material = this;
+	}
+
+	return nBaseStages;
+}
+
+bool MaterialStage::getShapeKey(uint32_t *key) const
+{
+	assert(key);
+	const MaterialTextureBundle &bundle = bundles[MaterialTextureBundleIndex::DiffuseMap];
+
+	if (bundle.tcGen == MaterialTexCoordGen::Fragment || alphaGen == MaterialAlphaGen::Water || alphaTest != MaterialAlphaTest::None)
+		return false;
+
+	if (bundle.numImageAnimations > 1 && textureAnimationLerp != MaterialStageTextureAnimationLerp::Disabled)
+		return false;
+
+	*key = (uint32_t)light | (uint32_t)numLayers << 4;
+
+	for (int i = 0; i < numLayers; i++)
+		*key |= (uint32_t)layerBlends[i] << (8 + i * 4);
+
+	return true;
+}
+
 } // namespace renderer
@@ -49,6 +49,8 @@ If you have questions concerning this license or the applicable additional terms
 #include "Precompiled.h"
 #pragma hdrstop
 
+#include "bx/hash.h"
+
 namespace renderer {
 
 // This is unfortunate, but the skin files aren't compatable with our normal parsing rules.
@@ -283,11 +285,12 @@ const char *Skin::findModelName(const char *modelType) const
 	return nullptr;
 }
 
-MaterialCache::MaterialCache() : hashTable_(), textHashTable_()
+MaterialCache::MaterialCache() : hashTable_()
 {
 	interface::Printf("Initializing Materials\n");
 	createInternalShaders();
 	scanAndLoadShaderFiles();
+	readBinaryCache();
 	createExternalShaders();
 
 	// Create the default skin.
@@ -297,16 +300,20 @@ MaterialCache::MaterialCache() : hashTable_(), textHashTable_()
 
 Material *MaterialCache::createMaterial(const Material &base)
 {
-	auto m = std::make_unique<Material>(base);
-	meta::OnMaterialCreate(m.get());
+	if (materials_.size() % materialsPerBlock_ == 0)
+		materialBlocks_.push_back(std::make_unique<Material[]>(materialsPerBlock_));
+
+	Material *m = &materialBlocks_.back()[materials_.size() % materialsPerBlock_];
+	*m = base;
+	meta::OnMaterialCreate(m);
 	m->finish();
 	m->index = (int)materials_.size();
 	m->sortedIndex = (int)materials_.size();
 	size_t hash = generateHash(m->name, hashTableSize_);
 	m->next = hashTable_[hash];
-	hashTable_[hash] = m.get();
-	materials_.push_back(std::move(m));
-	return hashTable_[hash];
+	hashTable_[hash] = m;
+	materials_.push_back(m);
+	return m;
 }
 
 Material *MaterialCache::findMaterial(const char *name, int lightmapIndex, bool mipRawImage)
@@ -336,18 +343,11 @@ Material *MaterialCache::findMaterial(const char *name, int lightmapIndex, bool
 	m.lightmapIndex = lightmapIndex;
 
 	// attempt to define shader from an explicit parameter file
-	char *shaderText = findShaderInShaderText(strippedName);
+	size_t shaderTextLength;
+	char *shaderText = textIndex_.find(strippedName, &shaderTextLength);
 
 	if (shaderText)
-	{
-		if (!m.parse(&shaderText))
-		{
-			// had errors, so use default shader
-			m.defaultShader = true;
-		}
-
-		return createMaterial(m);
-	}
+		return parseMaterial(&m, shaderText, shaderTextLength);
 
 	// if not defined in the in-memory shader descriptions, look for a single supported image file
 	int flags = TextureFlags::None;
@@ -480,20 +480,25 @@ void MaterialCache::remapMaterial(const char *oldName, const char *newName, cons
 void MaterialCache::printMaterials() const
 {
 	int nStages[Material::maxStages] = {};
+	size_t nActiveStages = 0, nLayers = 0;
 
 	for (size_t i = 0; i < materials_.size(); i++)
 	{
-		const Material *mat = materials_[i].get();
+		const Material *mat = materials_[i];
 		bool animated = false;
 
 		for (const MaterialStage &stage : mat->stages)
 		{
 			if (stage.active && stage.bundles[0].numImageAnimations > 1)
 				animated = true;
+
+			if (stage.active)
+				nLayers += stage.numLayers;
 		}
 
 		interface::Printf("%4u: [%c] %s\n", (int)i, animated ? 'a' : ' ', mat->name);
 		nStages[mat->numUnfoggedPasses]++;
+		nActiveStages += mat->numUnfoggedPasses;
 	}
 
 	for (int i = 1; i < Material::maxStages; i++)
@@ -501,6 +506,141 @@ void MaterialCache::printMaterials() const
 		if (nStages[i])
 			interface::Printf("%i materials with %i stage(s)\n", nStages[i], i);
 	}
+
+	interface::Printf("%u stages drawn as layers of other stages\n", (uint32_t)nLayers);
+
+	const size_t allocated = materialBlocks_.size() * materialsPerBlock_ * sizeof(Material);
+	const size_t stageBytes = materials_.size() * Material::maxStages * sizeof(MaterialStage);
+	interface::Printf("%u materials in %u blocks, %u KB allocated\n", (uint32_t)materials_.size(), (uint32_t)materialBlocks_.size(), (uint32_t)(allocated / 1024));
+	interface::Printf("%u bytes per material, %u bytes per stage\n", (uint32_t)sizeof(Material), (uint32_t)sizeof(MaterialStage));
+	interface::Printf("%u of %u stages active, %u KB in inactive stages\n", (uint32_t)nActiveStages, (uint32_t)(materials_.size() * Material::maxStages), (uint32_t)((stageBytes - nActiveStages * sizeof(MaterialStage)) / 1024));
+}
+
+/// Shape names are the light type followed by the blend of each layer, e.g. MapAdd.
+static std::string GetMaterialShapeName(uint32_t key)
+{
+	std::string name;
+
+	switch (key & 0xf)
+	{
+	case LIGHT_MAP: name = "Map"; break;
+	case LIGHT_VERTEX: name = "Vertex"; break;
+	case LIGHT_VECTOR: name = "Vector"; break;
+	default: name = "Unlit"; break;
+	}
+
+	const uint32_t numLayers = (key >> 4) & 0xf;
+
+	for (uint32_t i = 0; i < numLayers; i++)
+	{
+		switch ((key >> (8 + i * 4)) & 0xf)
+		{
+		case LAYER_BLEND_ADD: name += "Add"; break;
+		case LAYER_BLEND_MODULATE: name += "Modulate"; break;
+		default: name += "Lerp"; break;
+		}
+	}
+
+	return name;
+}
+
+/// Estimate of the uniform branches per fragment that the generic shader evaluates and a shape shader doesn't: texture coordinate generation, texture animation, alpha generation, two light type tests, two layer count tests and two render mode tests, plus two blend tests per layer.
+static int EstimateMaterialShapeBranchesRemoved(const MaterialStage &stage)
+{
+	return 9 + stage.numLayers * 2;
+}
+
+void MaterialCache::printMaterialShapes() const
+{
+	size_t nActiveStages = 0, nShapeStages = 0, nUnlistedStages = 0, nBranchesRemoved = 0;
+
+	for (size_t i = 0; i < materials_.size(); i++)
+	{
+		const Material *mat = materials_[i];
+
+		if (mat->numUnfoggedPasses == 0 || mat->isSky)
+			continue;
+
+		std::string shapes;
+		int nMaterialBranchesRemoved = 0;
+
+		for (const MaterialStage &stage : mat->stages)
+		{
+			if (!stage.active)
+				continue;
+
+			uint32_t key;
+
+			if (!shapes.empty())
+				shapes += " ";
+
+			if (stage.shape != -1)
+			{
+				shapes += main::GetMaterialShapeName(stage.shape);
+				nMaterialBranchesRemoved += EstimateMaterialShapeBranchesRemoved(stage);
+				nShapeStages++;
+			}
+			else if (stage.getShapeKey(&key))
+			{
+				// A shape that isn't in the shape list.
+				shapes += "(" + GetMaterialShapeName(key) + ")";
+				nUnlistedStages++;
+			}
+			else
+			{
+				shapes += "-";
+			}
+
+			nActiveStages++;
+		}
+
+		nBranchesRemoved += nMaterialBranchesRemoved;
+		interface::Printf("%4u: %s [%s] ~%d\n", (int)i, mat->name, shapes.c_str(), nMaterialBranchesRemoved);
+	}
+
+	interface::Printf("%u of %u active stages have a shape shader\n", (uint32_t)nShapeStages, (uint32_t)nActiveStages);
+	interface::Printf("%u stages have a shape that isn't in the shape list\n", (uint32_t)nUnlistedStages);
+
+	if (nShapeStages > 0)
+		interface::Printf("~%.1f fewer uniform branches per fragment in stages with a shape shader\n", nBranchesRemoved / (float)nShapeStages);
+
+	if (!g_cvars.materialShapes.getBool())
+		interface::Printf("Shape shaders are disabled by r_materialShapes\n");
+}
+
+void MaterialCache::writeMaterialShapes() const
+{
+	std::map<uint32_t, int> stageCounts;
+
+	for (const Material *mat : materials_)
+	{
+		if (mat->isSky)
+			continue;
+
+		for (const MaterialStage &stage : mat->stages)
+		{
+			uint32_t key;
+
+			if (stage.active && stage.getShapeKey(&key))
+				stageCounts[key]++;
+		}
+	}
+
+	std::vector<std::pair<uint32_t, int>> shapes(stageCounts.begin(), stageCounts.end());
+	std::sort(shapes.begin(), shapes.end(), [](const std::pair<uint32_t, int> &a, const std::pair<uint32_t, int> &b) { return a.second > b.second; });
+	std::string text;
+	text += "// Material shapes that get specialized generic fragment shaders. Read by \"premake5 shaders\".\n";
+	text += "// name light layers layer0Blend layer1Blend\n";
+
+	for (const std::pair<uint32_t, int> &shape : shapes)
+	{
+		const uint32_t key = shape.first;
+		text += util::VarArgs("%s %u %u %u %u // %d stages\n", GetMaterialShapeName(key).c_str(), key & 0xf, (key >> 4) & 0xf, (key >> 8) & 0xf, (key >> 12) & 0xf, shape.second);
+	}
+
+	const char *filename = "materialshapes.txt";
+	interface::FS_WriteFile(filename, (const uint8_t *)text.data(), text.length());
+	interface::Printf("Wrote %u material shapes to %s\n", (uint32_t)shapes.size(), filename);
 }
 
 Skin *MaterialCache::findSkin(const char *name)
@@ -590,12 +730,6 @@ void MaterialCache::scanAndLoadShaderFiles()
 		return;
 	}
 
-	numShaderFiles = std::min(numShaderFiles, (int)maxShaderFiles_);
-
-	// load and parse shader files
-	char *buffers[maxShaderFiles_] = {NULL};
-	long sum = 0;
-
 	for (int i = 0; i < numShaderFiles; i++)
 	{
 		char filename[MAX_QPATH];
@@ -618,163 +752,304 @@ void MaterialCache::scanAndLoadShaderFiles()
 		}
 		
 		interface::PrintDeveloperf("...loading '%s'\n", filename);
-		long summand = interface::FS_ReadFile(filename, (uint8_t **)&buffers[i]);
-		
-		if (!buffers[i])
+		ReadOnlyFile file(filename);
+
+		if (!file.isValid())
 			interface::Error("Couldn't load %s", filename);
-		
-		// Do a simple check on the shader structure in that file to make sure one bad shader file cannot fuck up all other shaders.
-		char *p = buffers[i];
-		util::BeginParseSession(filename);
 
-		while(1)
-		{
-			char *oldP = p;
-			char *token = util::Parse(&p, true);
-			
-			if (!*token)
-				break;
+		textIndex_.addFile(filename, (const char *)file.getData(), file.getLength());
+	}
 
-			char shaderName[MAX_QPATH];
-			util::Strncpyz(shaderName, token, sizeof(shaderName));
-			int shaderLine = util::GetCurrentParseLine();
-			token = util::Parse(&p, true);
+	interface::FS_FreeListFiles(shaderFiles);
+	textIndex_.build();
+}
 
-			if (token[0] != '{' || token[1] != '\0')
-			{
-				interface::PrintWarningf("WARNING: Shader file %s. Shader \"%s\" on line %d missing opening brace", filename, shaderName, shaderLine);
+void MaterialCache::createExternalShaders()
+{
+}
 
-				if (token[0])
-				{
-					interface::PrintWarningf(" (found \"%s\" on line %d)", token, util::GetCurrentParseLine());
-				}
+void MaterialTextIndex::addFile(const char *filename, const char *text, size_t length)
+{
+	File file;
+	util::Strncpyz(file.name, filename, sizeof(file.name));
+	file.offset = text_.size();
+	text_.insert(text_.end(), text, text + length);
+	text_.push_back('\0');
+
+	// Do a simple check on the shader structure in that file to make sure one bad shader file cannot fuck up all other shaders.
+	// Definitions are indexed at the same time, so the text is only walked once.
+	char *start = &text_[file.offset];
+	char *p = start;
+	util::BeginParseSession(filename);
 
-				interface::PrintWarningf(". Ignoring rest of shader file.\n");
-				*oldP = 0;
-				break;
-			}
+	for (;;)
+	{
+		char *oldP = p;
+		char *token = util::Parse(&p, true);
+			
+		if (!*token)
+			break;
+
+		char shaderName[MAX_QPATH];
+		util::Strncpyz(shaderName, token, sizeof(shaderName));
+		int shaderLine = util::GetCurrentParseLine();
+		char *definitionStart = p;
+		token = util::Parse(&p, true);
 
-			if (!util::SkipBracedSection(&p, 1))
+		if (token[0] != '{' || token[1] != '\0')
+		{
+			interface::PrintWarningf("WARNING: Shader file %s. Shader \"%s\" on line %d missing opening brace", filename, shaderName, shaderLine);
+
+			if (token[0])
 			{
-				interface::PrintWarningf("WARNING: Shader file %s. Shader \"%s\" on line %d missing closing brace. Ignoring rest of shader file.\n", filename, shaderName, shaderLine);
-				*oldP = 0;
-				break;
+				interface::PrintWarningf(" (found \"%s\" on line %d)", token, util::GetCurrentParseLine());
 			}
+
+			interface::PrintWarningf(". Ignoring rest of shader file.\n");
+			*oldP = 0;
+			break;
 		}
-			
-		if (buffers[i])
-			sum += summand;		
+
+		if (!util::SkipBracedSection(&p, 1))
+		{
+			interface::PrintWarningf("WARNING: Shader file %s. Shader \"%s\" on line %d missing closing brace. Ignoring rest of shader file.\n", filename, shaderName, shaderLine);
+			*oldP = 0;
+			break;
+		}
+
+		Definition def;
+		def.nameHash = hashName(shaderName);
+		def.nameOffset = names_.size();
+		def.file = files_.size();
+		def.offset = size_t(definitionStart - text_.data());
+		def.length = size_t(p - definitionStart);
+		names_.insert(names_.end(), shaderName, shaderName + strlen(shaderName) + 1);
+		definitions_.push_back(def);
 	}
 
-	// build single large buffer
-	shaderText_.resize(sum + numShaderFiles * 2);
-	shaderText_[0] = '\0';
-	char *textEnd = shaderText_.data();
- 
-	// free in reverse order, so the temp files are all dumped
-	for (int i = numShaderFiles - 1; i >= 0 ; i--)
+	file.length = strlen(start);
+	bx::HashMurmur2A hash;
+	hash.begin();
+	hash.add(filename, (int)strlen(filename));
+	hash.add(text, (int)length);
+	file.hash = hash.end();
+	files_.push_back(file);
+}
+
+void MaterialTextIndex::build()
+{
+	size_t size = 64;
+
+	while (size < definitions_.size() * 2)
+		size *= 2;
+
+	hashTable_.clear();
+	hashTable_.resize(size, -1);
+
+	for (size_t i = 0; i < definitions_.size(); i++)
 	{
-		if (!buffers[i])
-			continue;
+		const Definition &def = definitions_[i];
+		const int slot = findSlot(def.nameHash, &names_[def.nameOffset]);
+		int &index = hashTable_[slot];
 
-		strcat(textEnd, buffers[i]);
-		strcat(textEnd, "\n");
-		textEnd += strlen(textEnd);
-		interface::FS_FreeReadFile((uint8_t *)buffers[i]);
+		// Definitions are in file order, so a different file is a later one.
+		if (index == -1 || definitions_[index].file != def.file)
+			index = (int)i;
 	}
+}
 
-	util::Compress(shaderText_.data());
+char *MaterialTextIndex::find(const char *name, size_t *length)
+{
+	if (hashTable_.empty())
+		return nullptr;
 
-	// free up memory
-	interface::FS_FreeListFiles(shaderFiles);
+	const int index = hashTable_[findSlot(hashName(name), name)];
 
-	// look for shader names
-	int textHashTable_Sizes[textHashTableSize_];
-	memset(textHashTable_Sizes, 0, sizeof(textHashTable_Sizes));
-	int size = 0;
-	char *p = shaderText_.data();
+	if (index == -1)
+		return nullptr;
 
-	while (1)
-	{
-		char *token = util::Parse(&p, true);
+	if (length)
+		*length = definitions_[index].length;
 
-		if (token[0] == 0)
-			break;
+	return &text_[definitions_[index].offset];
+}
 
-		size_t hash = generateHash(token, textHashTableSize_);
-		textHashTable_Sizes[hash]++;
-		size++;
-		util::SkipBracedSection(&p, 0);
-	}
+uint32_t MaterialTextIndex::getHash() const
+{
+	bx::HashMurmur2A hash;
+	hash.begin();
+
+	for (const File &file : files_)
+		hash.add(file.hash);
 
-	size += textHashTableSize_;
-	auto hashMem = (char *)interface::Hunk_Alloc(size * sizeof(char *));
+	return hash.end();
+}
 
-	for (int i = 0; i < textHashTableSize_; i++)
+uint32_t MaterialTextIndex::hashName(const char *name)
+{
+	// FNV-1a, case insensitive.
+	uint32_t hash = 2166136261u;
+
+	for (const char *c = name; *c; c++)
 	{
-		textHashTable_[i] = (char **) hashMem;
-		hashMem = ((char *) hashMem) + ((textHashTable_Sizes[i] + 1) * sizeof(char *));
+		hash ^= (uint32_t)tolower(*c);
+		hash *= 16777619u;
 	}
 
-	// look for shader names
-	memset(textHashTable_Sizes, 0, sizeof(textHashTable_Sizes));
-	p = shaderText_.data();
+	return hash;
+}
+
+/// @return The slot containing the definition with this name, or the empty slot it would go in.
+int MaterialTextIndex::findSlot(uint32_t nameHash, const char *name) const
+{
+	const size_t mask = hashTable_.size() - 1;
 
-	while (1)
+	for (size_t slot = nameHash & mask;; slot = (slot + 1) & mask)
 	{
-		char *oldp = p;
-		char *token = util::Parse(&p, true);
+		const int index = hashTable_[slot];
 
-		if (token[0] == 0)
-			break;
+		if (index == -1)
+			return (int)slot;
+
+		const Definition &def = definitions_[index];
 
-		size_t hash = generateHash(token, textHashTableSize_);
-		textHashTable_[hash][textHashTable_Sizes[hash]++] = oldp;
-		util::SkipBracedSection(&p, 0);
+		if (def.nameHash == nameHash && !util::Stricmp(&names_[def.nameOffset], name))
+			return (int)slot;
 	}
 }
 
-void MaterialCache::createExternalShaders()
+/// Time indexing synthetic .shader files, and looking up material names in them - half defined, half not, like the textures in a typical map.
+/// The previous approach - concatenating all the files into one block, and falling back to a linear scan of it on a hash miss - is timed too for comparison.
+void BenchmarkMaterialTextIndex(int nFiles, int nDefinitionsPerFile)
 {
-}
+	const char *definition = "\n{\n\tqer_editorimage textures/base_wall/metal.tga\n\tsurfaceparm nomarks\n\t{\n\t\tmap $lightmap\n\t\trgbGen identity\n\t}\n\t{\n\t\tmap textures/base_wall/metal.tga\n\t\tblendFunc GL_DST_COLOR GL_ZERO\n\t\trgbGen identity\n\t}\n}\n";
+	std::vector<std::string> files(nFiles);
+	char name[MAX_QPATH];
 
-char *MaterialCache::findShaderInShaderText(const char *name)
-{
-	size_t hash = generateHash(name, textHashTableSize_);
+	for (int i = 0; i < nFiles; i++)
+	{
+		for (int j = 0; j < nDefinitionsPerFile; j++)
+		{
+			util::Sprintf(name, sizeof(name), "textures/pack%d/material%d", i, j);
+			files[i] += name;
+			files[i] += definition;
+		}
+	}
+
+	std::vector<std::string> lookups;
 
-	if (textHashTable_[hash])
+	for (int i = 0; i < nFiles; i++)
 	{
-		for (size_t i = 0; textHashTable_[hash][i]; i++)
+		util::Sprintf(name, sizeof(name), "textures/pack%d/material%d", i, i % nDefinitionsPerFile);
+		lookups.push_back(name);
+		util::Sprintf(name, sizeof(name), "textures/pack%d/undefined%d", i, i);
+		lookups.push_back(name);
+	}
+
+	// Previous approach: check each file's structure, concatenate and compress, then walk the text twice to size and fill a hash table.
+	int64_t start = bx::getHPCounter();
+	size_t totalSize = 0;
+
+	for (std::string &file : files)
+	{
+		char *p = &file[0];
+
+		for (;;)
 		{
-			char *p = textHashTable_[hash][i];
 			char *token = util::Parse(&p, true);
-		
-			if (!util::Stricmp(token, name))
-				return p;
+
+			if (!token[0])
+				break;
+
+			util::Parse(&p, true);
+			util::SkipBracedSection(&p, 1);
 		}
+
+		totalSize += file.length() + 1;
 	}
 
-	char *p = shaderText_.data();
+	std::vector<char> text(totalSize + 1);
+	text[0] = '\0';
+	char *textEnd = text.data();
 
-	if (!p)
-		return NULL;
+	for (int i = nFiles - 1; i >= 0; i--)
+	{
+		strcat(textEnd, files[i].c_str());
+		strcat(textEnd, "\n");
+		textEnd += strlen(textEnd);
+	}
 
-	// look for label
-	for (;;)
+	util::Compress(text.data());
+	std::vector<char *> definitionNames;
+
+	for (int pass = 0; pass < 2; pass++)
 	{
-		char *token = util::Parse(&p, true);
+		definitionNames.clear();
+		char *p = text.data();
 
-		if (token[0] == 0)
-			break;
+		for (;;)
+		{
+			char *oldP = p;
+			char *token = util::Parse(&p, true);
 
-		if (!util::Stricmp(token, name))
-			return p;
-		
-		// skip the definition
-		util::SkipBracedSection(&p, 0);
+			if (!token[0])
+				break;
+
+			definitionNames.push_back(oldP);
+			util::SkipBracedSection(&p, 0);
+		}
+	}
+
+	const int64_t oldIndexTime = bx::getHPCounter() - start;
+
+	// Misses scanned all the text. Hits were cheap hash table lookups, so leave them out. Scanning is slow, so time a few misses and extrapolate.
+	const int nOldMisses = std::min(nFiles, 32);
+	start = bx::getHPCounter();
+
+	for (int i = 0; i < nOldMisses; i++)
+	{
+		const char *name = lookups[i * 2 + 1].c_str();
+		char *p = text.data();
+
+		for (;;)
+		{
+			char *token = util::Parse(&p, true);
+
+			if (!token[0] || !util::Stricmp(token, name))
+				break;
+
+			util::SkipBracedSection(&p, 0);
+		}
+	}
+
+	const int64_t oldLookupTime = (bx::getHPCounter() - start) * nFiles / nOldMisses;
+
+	// Current approach.
+	start = bx::getHPCounter();
+	MaterialTextIndex index;
+
+	for (int i = 0; i < nFiles; i++)
+	{
+		util::Sprintf(name, sizeof(name), "scripts/pack%d.shader", i);
+		index.addFile(name, files[i].c_str(), files[i].length());
+	}
+
+	index.build();
+	const int64_t newIndexTime = bx::getHPCounter() - start;
+	start = bx::getHPCounter();
+	int nNewFound = 0;
+
+	for (const std::string &lookup : lookups)
+	{
+		if (index.find(lookup.c_str()))
+			nNewFound++;
 	}
 
-	return NULL;
+	const int64_t newLookupTime = bx::getHPCounter() - start;
+	const double toMs = 1000.0 / bx::getHPFrequency();
+	interface::Printf("%d files, %d definitions, %.2fMB text, %d lookups\n", nFiles, (int)index.getNumDefinitions(), index.getTextSize() / (1024.0 * 1024.0), (int)lookups.size());
+	interface::Printf("concatenate   index %8.2fms   lookup %8.2fms (estimated from %d misses)\n", oldIndexTime * toMs, oldLookupTime * toMs, nOldMisses);
+	interface::Printf("single pass   index %8.2fms   lookup %8.2fms   found %d\n", newIndexTime * toMs, newLookupTime * toMs, nNewFound);
 }
 
 } // namespace renderer
@@ -0,0 +1,466 @@
+/*
+===========================================================================
+Copyright (C) 1999-2005 Id Software, Inc.
+
+This file is part of Quake III Arena source code.
+
+Quake III Arena source code is free software; you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the License,
+or (at your option) any later version.
+
+Quake III Arena source code is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Quake III Arena source code; if not, write to the Free Software
+Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+===========================================================================
+*/
+#include "Precompiled.h"
+#pragma hdrstop
+
+#include <type_traits>
+
+namespace renderer {
+
+static_assert(std::is_trivially_copyable<Material>::value, "Material is copied as bytes by the binary cache");
+
+static const char *s_binaryCacheFilename = "materialcache.bin";
+
+static const size_t s_nStageTextureSlots = Material::maxStages * MaterialTextureBundleIndex::NumMaterialTextureBundles * MaterialTextureBundle::maxImageAnimations;
+static const size_t s_nTextureSlots = s_nStageTextureSlots + 12;
+
+/// Entries are this header, followed by the material bytes before stages, nStages stages, the material bytes after stages, and nTextureRefs BinaryTextureRef.
+struct BinaryEntryHeader
+{
+	uint32_t size;
+	char name[MAX_QPATH];
+	uint32_t nStages;
+	uint32_t nTextureRefs;
+};
+
+static const Texture **GetTextureSlot(Material *material, size_t slot)
+{
+	if (slot < s_nStageTextureSlots)
+	{
+		const size_t texturesPerStage = MaterialTextureBundleIndex::NumMaterialTextureBundles * MaterialTextureBundle::maxImageAnimations;
+		MaterialTextureBundle &bundle = material->stages[slot / texturesPerStage].bundles[(slot % texturesPerStage) / MaterialTextureBundle::maxImageAnimations];
+		return &bundle.textures[slot % MaterialTextureBundle::maxImageAnimations];
+	}
+
+	slot -= s_nStageTextureSlots;
+	return slot < 6 ? &material->sky.outerbox[slot] : &material->sky.innerbox[slot - 6];
+}
+
+static bool IsSlotLightmap(const Material &material, size_t slot)
+{
+	if (slot >= s_nStageTextureSlots)
+		return false;
+
+	const size_t texturesPerStage = MaterialTextureBundleIndex::NumMaterialTextureBundles * MaterialTextureBundle::maxImageAnimations;
+	return material.stages[slot / texturesPerStage].bundles[(slot % texturesPerStage) / MaterialTextureBundle::maxImageAnimations].isLightmap;
+}
+
+/// The bytes of a material before and after the stages array.
+static void GetMaterialSpans(const Material &material, size_t *prefixSize, size_t *suffixOffset)
+{
+	*prefixSize = size_t((const uint8_t *)&material.stages[0] - (const uint8_t *)&material);
+	*suffixOffset = size_t((const uint8_t *)&material.stages[Material::maxStages] - (const uint8_t *)&material);
+}
+
+static bool ContainsKeyword(const char *text, size_t length, const char *keyword)
+{
+	const size_t keywordLength = strlen(keyword);
+
+	for (size_t i = 0; i + keywordLength <= length; i++)
+	{
+		if (!util::Stricmpn(&text[i], keyword, (int)keywordLength))
+			return true;
+	}
+
+	return false;
+}
+
+#define DIFF_FIELD(a, b, prefix, field) if (memcmp(&(a).field, &(b).field, sizeof((a).field))) { interface::Printf("Material cache mismatch: %s %s%s\n", name, prefix, #field); nDiffs++; }
+
+/// Print the fields that are different.
+/// @return The number of fields that are different.
+static int DiffMaterials(const Material &a, const Material &b)
+{
+	const char *name = a.name;
+	int nDiffs = 0;
+	DIFF_FIELD(a, b, "", sort);
+	DIFF_FIELD(a, b, "", explicitlyDefined);
+	DIFF_FIELD(a, b, "", surfaceLight);
+	DIFF_FIELD(a, b, "", surfaceFlags);
+	DIFF_FIELD(a, b, "", contentFlags);
+	DIFF_FIELD(a, b, "", entityMergable);
+	DIFF_FIELD(a, b, "", isSky);
+	DIFF_FIELD(a, b, "", sky.cloudHeight);
+	DIFF_FIELD(a, b, "", sky.outerbox);
+	DIFF_FIELD(a, b, "", sky.innerbox);
+	DIFF_FIELD(a, b, "", fogParms.color);
+	DIFF_FIELD(a, b, "", fogParms.depthForOpaque);
+	DIFF_FIELD(a, b, "", noFog);
+	DIFF_FIELD(a, b, "", portalRange);
+	DIFF_FIELD(a, b, "", isPortal);
+	DIFF_FIELD(a, b, "", reflective);
+	DIFF_FIELD(a, b, "", cullType);
+	DIFF_FIELD(a, b, "", polygonOffset);
+	DIFF_FIELD(a, b, "", noMipMaps);
+	DIFF_FIELD(a, b, "", noPicMip);
+	DIFF_FIELD(a, b, "", fogPass);
+	DIFF_FIELD(a, b, "", vertexAttribs);
+	DIFF_FIELD(a, b, "", numDeforms);
+	DIFF_FIELD(a, b, "", deforms);
+	DIFF_FIELD(a, b, "", numUnfoggedPasses);
+	DIFF_FIELD(a, b, "", clampTime);
+	DIFF_FIELD(a, b, "", timeOffset);
+
+	for (size_t i = 0; i < Material::maxStages; i++)
+	{
+		const MaterialStage &sa = a.stages[i], &sb = b.stages[i];
+		char prefix[32];
+		util::Sprintf(prefix, sizeof(prefix), "stages[%d].", (int)i);
+		DIFF_FIELD(sa, sb, prefix, active);
+		DIFF_FIELD(sa, sb, prefix, numTexMods);
+		DIFF_FIELD(sa, sb, prefix, texMods);
+		DIFF_FIELD(sa, sb, prefix, rgbWave);
+		DIFF_FIELD(sa, sb, prefix, rgbGen);
+		DIFF_FIELD(sa, sb, prefix, alphaWave);
+		DIFF_FIELD(sa, sb, prefix, alphaGen);
+		DIFF_FIELD(sa, sb, prefix, textureAnimationLerp);
+		DIFF_FIELD(sa, sb, prefix, constantColor);
+		DIFF_FIELD(sa, sb, prefix, depthTestBits);
+		DIFF_FIELD(sa, sb, prefix, depthWrite);
+		DIFF_FIELD(sa, sb, prefix, alphaTest);
+		DIFF_FIELD(sa, sb, prefix, blendSrc);
+		DIFF_FIELD(sa, sb, prefix, blendDst);
+		DIFF_FIELD(sa, sb, prefix, adjustColorsForFog);
+		DIFF_FIELD(sa, sb, prefix, isDetail);
+		DIFF_FIELD(sa, sb, prefix, type);
+		DIFF_FIELD(sa, sb, prefix, light);
+		DIFF_FIELD(sa, sb, prefix, bloom);
+		DIFF_FIELD(sa, sb, prefix, textureVariation);
+		DIFF_FIELD(sa, sb, prefix, normalScale);
+		DIFF_FIELD(sa, sb, prefix, specularScale);
+		DIFF_FIELD(sa, sb, prefix, zFadeBounds);
+
+		for (size_t j = 0; j < MaterialTextureBundleIndex::NumMaterialTextureBundles; j++)
+		{
+			const MaterialTextureBundle &ba = sa.bundles[j], &bb = sb.bundles[j];
+			util::Sprintf(prefix, sizeof(prefix), "stages[%d].bundles[%d].", (int)i, (int)j);
+			DIFF_FIELD(ba, bb, prefix, textures);
+			DIFF_FIELD(ba, bb, prefix, numImageAnimations);
+			DIFF_FIELD(ba, bb, prefix, imageAnimationSpeed);
+			DIFF_FIELD(ba, bb, prefix, tcGen);
+			DIFF_FIELD(ba, bb, prefix, tcGenVectors);
+			DIFF_FIELD(ba, bb, prefix, isLightmap);
+		}
+	}
+
+	return nDiffs;
+}
+
+#undef DIFF_FIELD
+
+void MaterialCache::readBinaryCache()
+{
+	binaryCacheMode_ = g_cvars.materialCache.getInt();
+	shaderFilesHash_ = textIndex_.getHash();
+
+	if (binaryCacheMode_ == 0)
+		return;
+
+	ReadOnlyFile file(s_binaryCacheFilename);
+
+	if (!file.isValid() || file.getLength() < sizeof(BinaryCacheHeader))
+		return;
+
+	BinaryCacheHeader header;
+	memcpy(&header, file.getData(), sizeof(header));
+
+	// Any change to the shader files - e.g. a pak being added, removed or changed - or to whether stages are collapsed invalidates the whole cache.
+	if (header.magic != BinaryCacheHeader::currentMagic || header.version != BinaryCacheHeader::currentVersion || header.materialSize != sizeof(Material) || header.shaderFilesHash != shaderFilesHash_ || header.collapseStages != (main::IsCollapseStagesEnabled() ? 1u : 0u))
+	{
+		interface::PrintDeveloperf("Ignoring stale %s\n", s_binaryCacheFilename);
+		return;
+	}
+
+	binaryData_.assign(file.getData() + sizeof(header), file.getData() + file.getLength());
+	size_t offset = 0;
+
+	for (uint32_t i = 0; i < header.nEntries; i++)
+	{
+		BinaryEntryHeader entry;
+
+		if (offset + sizeof(entry) > binaryData_.size())
+			break;
+
+		memcpy(&entry, &binaryData_[offset], sizeof(entry));
+
+		if (entry.size < sizeof(entry) || offset + entry.size > binaryData_.size())
+			break;
+
+		entry.name[MAX_QPATH - 1] = 0;
+		binaryEntries_[entry.name] = offset;
+		offset += entry.size;
+	}
+
+	if (binaryEntries_.size() != header.nEntries)
+	{
+		interface::PrintWarningf("WARNING: %s is corrupt\n", s_binaryCacheFilename);
+		binaryEntries_.clear();
+		binaryData_.clear();
+		return;
+	}
+
+	interface::PrintDeveloperf("Read %d materials from %s\n", (int)binaryEntries_.size(), s_binaryCacheFilename);
+}
+
+bool MaterialCache::readBinaryMaterial(const char *name, Material *material)
+{
+	char lowerName[MAX_QPATH];
+	util::Strncpyz(lowerName, name, sizeof(lowerName));
+	util::ToLowerCase(lowerName);
+	auto it = binaryEntries_.find(lowerName);
+
+	if (it == binaryEntries_.end())
+	{
+		nBinaryMisses_++;
+		return false;
+	}
+
+	const uint8_t *data = &binaryData_[it->second];
+	BinaryEntryHeader entry;
+	memcpy(&entry, data, sizeof(entry));
+	size_t prefixSize, suffixOffset;
+	GetMaterialSpans(*material, &prefixSize, &suffixOffset);
+	const size_t suffixSize = sizeof(Material) - suffixOffset;
+
+	if (entry.nStages > Material::maxStages || entry.size != sizeof(entry) + prefixSize + entry.nStages * sizeof(MaterialStage) + suffixSize + entry.nTextureRefs * sizeof(BinaryTextureRef))
+	{
+		nBinaryMisses_++;
+		return false;
+	}
+
+	// Resolve the textures first, so a missing texture leaves the material untouched for parsing.
+	const Texture *textures[s_nTextureSlots] = {};
+	const uint8_t *refData = data + entry.size - entry.nTextureRefs * sizeof(BinaryTextureRef);
+
+	for (uint32_t i = 0; i < entry.nTextureRefs; i++)
+	{
+		BinaryTextureRef ref;
+		memcpy(&ref, refData + i * sizeof(ref), sizeof(ref));
+
+		if (ref.slot >= s_nTextureSlots)
+		{
+			nBinaryMisses_++;
+			return false;
+		}
+
+		if (ref.type == BinaryTextureRef::Type::Default)
+		{
+			textures[ref.slot] = g_textureCache->getDefault();
+		}
+		else if (ref.type == BinaryTextureRef::Type::Lightmap)
+		{
+			// Same as parsing $lightmap.
+			const Texture *lightmap = world::IsLoaded() ? world::GetLightmap(material->lightmapIndex) : nullptr;
+			textures[ref.slot] = lightmap ? lightmap : g_textureCache->getWhite();
+		}
+		else if (ref.type == BinaryTextureRef::Type::Named)
+		{
+			ref.name[MAX_QPATH - 1] = 0;
+			textures[ref.slot] = g_textureCache->find(ref.name, ref.flags);
+
+			if (!textures[ref.slot])
+			{
+				nBinaryMisses_++;
+				return false;
+			}
+		}
+		else if (ref.type == BinaryTextureRef::Type::White)
+		{
+			textures[ref.slot] = g_textureCache->getWhite();
+		}
+	}
+
+	// The name and lightmap are from the material that was cached, which may have had a different case and lightmap.
+	char materialName[MAX_QPATH];
+	util::Strncpyz(materialName, material->name, sizeof(materialName));
+	const int lightmapIndex = material->lightmapIndex;
+	data += sizeof(entry);
+	memcpy((void *)material, data, prefixSize);
+	data += prefixSize;
+	memcpy((void *)material->stages, data, entry.nStages * sizeof(MaterialStage));
+	data += entry.nStages * sizeof(MaterialStage);
+	memcpy((uint8_t *)material + suffixOffset, data, suffixSize);
+	util::Strncpyz(material->name, materialName, sizeof(material->name));
+	material->lightmapIndex = lightmapIndex;
+
+	// Pointers are from another session.
+	for (size_t i = 0; i < s_nTextureSlots; i++)
+		*GetTextureSlot(material, i) = textures[i];
+
+	for (size_t i = 0; i < Material::maxStages; i++)
+		material->stages[i].material = nullptr;
+
+	material->reflectiveFrontSideMaterial = nullptr;
+	material->remappedShader = nullptr;
+	material->next = nullptr;
+	nBinaryHits_++;
+	return true;
+}
+
+void MaterialCache::writeBinaryMaterial(const Material &material, const char *definition, size_t definitionLength)
+{
+	char lowerName[MAX_QPATH];
+	util::Strncpyz(lowerName, material.name, sizeof(lowerName));
+	util::ToLowerCase(lowerName);
+
+	if (binaryEntries_.find(lowerName) != binaryEntries_.end())
+		return;
+
+	// These keywords change state outside the material, or depend on state that isn't known until the material is used.
+	const char *uncacheableKeywords[] = { "$deluxemap", "fogvars", "q3gl2_sun", "q3map_sun", "videoMap" };
+
+	for (const char *keyword : uncacheableKeywords)
+	{
+		if (ContainsKeyword(definition, definitionLength, keyword))
+			return;
+	}
+
+	std::vector<BinaryTextureRef> refs;
+
+	for (size_t i = 0; i < s_nTextureSlots; i++)
+	{
+		const Texture *texture = *GetTextureSlot(const_cast<Material *>(&material), i);
+
+		if (!texture)
+			continue;
+
+		BinaryTextureRef ref = {};
+		ref.slot = (uint16_t)i;
+
+		if (IsSlotLightmap(material, i))
+		{
+			ref.type = BinaryTextureRef::Type::Lightmap;
+		}
+		else if (texture == g_textureCache->getWhite())
+		{
+			ref.type = BinaryTextureRef::Type::White;
+		}
+		else if (texture == g_textureCache->getDefault())
+		{
+			ref.type = BinaryTextureRef::Type::Default;
+		}
+		else if (g_textureCache->get(texture->getName()) == texture)
+		{
+			ref.type = BinaryTextureRef::Type::Named;
+			ref.flags = texture->getFlags();
+			util::Strncpyz(ref.name, texture->getName(), sizeof(ref.name));
+		}
+		else
+		{
+			return; // Can't be found again, e.g. a scratch texture.
+		}
+
+		refs.push_back(ref);
+	}
+
+	uint32_t nStages = 0;
+
+	for (uint32_t i = 0; i < Material::maxStages; i++)
+	{
+		if (material.stages[i].active)
+			nStages = i + 1;
+	}
+
+	size_t prefixSize, suffixOffset;
+	GetMaterialSpans(material, &prefixSize, &suffixOffset);
+	const size_t suffixSize = sizeof(Material) - suffixOffset;
+	BinaryEntryHeader entry = {};
+	entry.size = uint32_t(sizeof(entry) + prefixSize + nStages * sizeof(MaterialStage) + suffixSize + refs.size() * sizeof(BinaryTextureRef));
+	util::Strncpyz(entry.name, lowerName, sizeof(entry.name));
+	entry.nStages = nStages;
+	entry.nTextureRefs = (uint32_t)refs.size();
+	const size_t offset = binaryData_.size();
+	binaryData_.resize(offset + entry.size);
+	uint8_t *data = &binaryData_[offset];
+	memcpy(data, &entry, sizeof(entry));
+	data += sizeof(entry);
+	memcpy(data, &material, prefixSize);
+	data += prefixSize;
+	memcpy(data, material.stages, nStages * sizeof(MaterialStage));
+	data += nStages * sizeof(MaterialStage);
+	memcpy(data, (const uint8_t *)&material + suffixOffset, suffixSize);
+	data += suffixSize;
+
+	if (!refs.empty())
+		memcpy(data, refs.data(), refs.size() * sizeof(BinaryTextureRef));
+
+	binaryEntries_[lowerName] = offset;
+	binaryCacheDirty_ = true;
+}
+
+void MaterialCache::writeBinaryCache()
+{
+	if (binaryCacheMode_ != 0)
+	{
+		interface::PrintDeveloperf("Material cache: %d hits, %d misses, %d mismatches\n", nBinaryHits_, nBinaryMisses_, nBinaryMismatches_);
+	}
+
+	if (!binaryCacheDirty_)
+		return;
+
+	BinaryCacheHeader header;
+	header.magic = BinaryCacheHeader::currentMagic;
+	header.version = BinaryCacheHeader::currentVersion;
+	header.materialSize = sizeof(Material);
+	header.shaderFilesHash = shaderFilesHash_;
+	header.collapseStages = main::IsCollapseStagesEnabled() ? 1 : 0;
+	header.nEntries = (uint32_t)binaryEntries_.size();
+	std::vector<uint8_t> file(sizeof(header) + binaryData_.size());
+	memcpy(file.data(), &header, sizeof(header));
+
+	if (!binaryData_.empty())
+		memcpy(&file[sizeof(header)], binaryData_.data(), binaryData_.size());
+
+	interface::FS_WriteFile(s_binaryCacheFilename, file.data(), file.size());
+	binaryCacheDirty_ = false;
+}
+
+Material *MaterialCache::parseMaterial(Material *material, char *definition, size_t definitionLength)
+{
+	if (binaryCacheMode_ == 1 && readBinaryMaterial(material->name, material))
+		return createMaterial(*material);
+
+	// Verify mode reads the cached version into a copy of the material before parsing.
+	Material cached = *material;
+	char *text = definition;
+
+	if (!material->parse(&text))
+	{
+		// had errors, so use default shader
+		material->defaultShader = true;
+		return createMaterial(*material);
+	}
+
+	if (binaryCacheMode_ == 2 && readBinaryMaterial(cached.name, &cached))
+	{
+		if (DiffMaterials(*material, cached))
+			nBinaryMismatches_++;
+	}
+	else if (binaryCacheMode_ != 0)
+	{
+		writeBinaryMaterial(*material, definition, definitionLength);
+	}
+
+	return createMaterial(*material);
+}
+
+} // namespace renderer
@@ -48,10 +48,8 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 
 namespace renderer {
 
-vec4 MaterialStage::getFogColorMask() const
+static vec4 GetFogColorMask(MaterialAdjustColorsForFog adjustColorsForFog)
 {
-	assert(active);
-
 	switch(adjustColorsForFog)
 	{
 	case MaterialAdjustColorsForFog::ModulateRGB:
@@ -67,6 +65,26 @@ vec4 MaterialStage::getFogColorMask() const
 	return vec4(0, 0, 0, 0);
 }
 
+bool MaterialStage::adjustsColorsForFog() const
+{
+	if (adjustColorsForFog != MaterialAdjustColorsForFog::None)
+		return true;
+
+	for (int i = 0; i < numLayers; i++)
+	{
+		if (material->stages[layers[i]].adjustColorsForFog != MaterialAdjustColorsForFog::None)
+			return true;
+	}
+
+	return false;
+}
+
+vec4 MaterialStage::getFogColorMask() const
+{
+	assert(active);
+	return GetFogColorMask(adjustColorsForFog);
+}
+
 uint64_t MaterialStage::getState() const
 {
 	assert(active);
@@ -119,13 +137,13 @@ void MaterialStage::setShaderUniforms(Uniforms_MaterialStage *uniforms, int flag
 		uniforms->generators.set(generators);
 	}
 
+	const EvaluationCache &evaluated = evaluate(flags);
+
 	if (flags & MaterialStageSetUniformsFlags::ColorGen)
 	{
 		// rgbGen and alphaGen
-		vec4 baseColor, vertexColor;
-		calculateColors(&baseColor, &vertexColor);
-		uniforms->baseColor.set(util::ToLinear(baseColor));
-		uniforms->vertexColor.set(util::ToLinear(vertexColor));
+		uniforms->baseColor.set(evaluated.baseColor);
+		uniforms->vertexColor.set(evaluated.vertexColor);
 
 		if (alphaGen == MaterialAlphaGen::Portal)
 		{
@@ -136,10 +154,8 @@ void MaterialStage::setShaderUniforms(Uniforms_MaterialStage *uniforms, int flag
 	if (flags & MaterialStageSetUniformsFlags::TexGen)
 	{
 		// tcGen and tcMod
-		vec4 texMatrix, texOffTurb;
-		calculateTexMods(&texMatrix, &texOffTurb);
-		uniforms->diffuseTextureMatrix.set(texMatrix);
-		uniforms->diffuseTextureOffsetTurbulent.set(texOffTurb);
+		uniforms->diffuseTextureMatrix.set(evaluated.texMatrix);
+		uniforms->diffuseTextureOffsetTurbulent.set(evaluated.texOffTurb);
 
 		if (bundles[0].tcGen == MaterialTexCoordGen::Vector)
 		{
@@ -147,6 +163,40 @@ void MaterialStage::setShaderUniforms(Uniforms_MaterialStage *uniforms, int flag
 			uniforms->tcGenVector1.set(bundles[0].tcGenVectors[1]);
 		}
 	}
+
+	// Layers
+	vec4 layers_Num_TCGen((float)numLayers, 0, 0, 0);
+	vec4 layerBlend, layerColor[maxLayers], layerFogColorMask[maxLayers], layerTexMatrix[maxLayers], layerTexOffTurb[maxLayers];
+
+	for (int i = 0; i < numLayers; i++)
+	{
+		const MaterialStage &layer = material->stages[layers[i]];
+		const EvaluationCache &layerEvaluated = layer.evaluate(flags);
+		layers_Num_TCGen[1 + i] = (float)layer.bundles[0].tcGen;
+		layerBlend[i] = (float)layerBlends[i];
+		layerColor[i] = layerEvaluated.baseColor;
+		layerFogColorMask[i] = GetFogColorMask(layer.adjustColorsForFog);
+		layerTexMatrix[i] = layerEvaluated.texMatrix;
+		layerTexOffTurb[i] = layerEvaluated.texOffTurb;
+	}
+
+	uniforms->layers_Num_TCGen.set(layers_Num_TCGen);
+
+	if (numLayers > 0)
+	{
+		if (flags & MaterialStageSetUniformsFlags::ColorGen)
+		{
+			uniforms->layerBlend.set(layerBlend);
+			uniforms->layerColor.set(layerColor, maxLayers);
+			uniforms->layerFogColorMask.set(layerFogColorMask, maxLayers);
+		}
+
+		if (flags & MaterialStageSetUniformsFlags::TexGen)
+		{
+			uniforms->layerTextureMatrix.set(layerTexMatrix, maxLayers);
+			uniforms->layerTextureOffsetTurbulent.set(layerTexOffTurb, maxLayers);
+		}
+	}
 }
 
 void MaterialStage::setTextureSamplers(Uniforms_MaterialStage *uniforms) const
@@ -163,8 +213,11 @@ void MaterialStage::setTextureSamplers(Uniforms_MaterialStage *uniforms) const
 		interface::CIN_UploadCinematic(diffuseBundle.videoMapHandle);
 	}
 
+	const uint32_t frameNo = main::GetFrameNo();
+
 	if (diffuseBundle.numImageAnimations <= 1)
 	{
+		diffuseBundle.textures[0]->setLastUsedFrame(frameNo);
 		bgfx::setTexture(TextureUnit::Diffuse, uniforms->diffuseSampler.handle, diffuseBundle.textures[0]->getHandle());
 
 #ifdef _DEBUG
@@ -175,10 +228,12 @@ void MaterialStage::setTextureSamplers(Uniforms_MaterialStage *uniforms) const
 	{
 		int frame, nextFrame;
 		calculateTextureAnimation(&frame, &nextFrame, nullptr);
+		diffuseBundle.textures[frame]->setLastUsedFrame(frameNo);
 		bgfx::setTexture(TextureUnit::Diffuse, uniforms->diffuseSampler.handle, diffuseBundle.textures[frame]->getHandle());
 
 		if (shouldLerpTextureAnimation())
 		{
+			diffuseBundle.textures[nextFrame]->setLastUsedFrame(frameNo);
 			bgfx::setTexture(TextureUnit::Diffuse2, uniforms->diffuseSampler2.handle, diffuseBundle.textures[nextFrame]->getHandle());
 		}
 #ifdef _DEBUG
@@ -202,6 +257,104 @@ void MaterialStage::setTextureSamplers(Uniforms_MaterialStage *uniforms) const
 		bgfx::setTexture(TextureUnit::Light, uniforms->lightSampler.handle, g_textureCache->getWhite()->getHandle());
 	}
 #endif
+
+	// Layers.
+	for (int i = 0; i < (int)maxLayers; i++)
+	{
+		const Texture *texture = nullptr;
+
+		if (i < numLayers)
+		{
+			texture = material->stages[layers[i]].bundles[MaterialTextureBundleIndex::DiffuseMap].textures[0];
+			texture->setLastUsedFrame(frameNo);
+		}
+#ifdef _DEBUG
+		else
+		{
+			texture = g_textureCache->getWhite();
+		}
+#endif
+
+		if (texture)
+		{
+			bgfx::setTexture(TextureUnit::Layer0 + i, uniforms->layerSamplers[i].handle, texture->getHandle());
+		}
+	}
+}
+
+int MaterialStage::nEvaluationCacheHits_ = 0;
+int MaterialStage::nEvaluationCacheMisses_ = 0;
+
+void MaterialStage::getEvaluationCacheStats(int *hits, int *misses, bool reset)
+{
+	*hits = nEvaluationCacheHits_;
+	*misses = nEvaluationCacheMisses_;
+
+	if (reset)
+		nEvaluationCacheHits_ = nEvaluationCacheMisses_ = 0;
+}
+
+bool MaterialStage::dependsOnEntity() const
+{
+	if (rgbGen == MaterialColorGen::Entity || rgbGen == MaterialColorGen::OneMinusEntity || alphaGen == MaterialAlphaGen::Entity || alphaGen == MaterialAlphaGen::OneMinusEntity)
+		return true;
+
+	for (int i = 0; i < numTexMods; i++)
+	{
+		if (texMods[i].type == MaterialTexMod::EntityTranslate)
+			return true;
+	}
+
+	return false;
+}
+
+const MaterialStage::EvaluationCache &MaterialStage::evaluate(int flags) const
+{
+	EvaluationCache &cache = evaluationCache_;
+	flags &= MaterialStageSetUniformsFlags::ColorGen | MaterialStageSetUniformsFlags::TexGen;
+	const bool enabled = g_cvars.materialStageCache.getBool();
+
+	// Entity time is already part of the material time.
+	const Entity *entity = dependsOnEntity() ? main::GetCurrentEntity() : nullptr;
+	const uint32_t frameNo = main::GetFrameNo();
+
+	const bool entityChanged = (entity != nullptr) != cache.hasEntity || (entity && (!entity->materialColor.equals(cache.entityColor) || entity->materialTexCoord != cache.entityTexCoord));
+
+	if (!enabled || cache.frameNo != frameNo || cache.time != material->time_ || entityChanged)
+	{
+		cache.frameNo = frameNo;
+		cache.time = material->time_;
+		cache.hasEntity = entity != nullptr;
+		cache.entityColor = entity ? entity->materialColor : vec4::empty;
+		cache.entityTexCoord = entity ? entity->materialTexCoord : vec2::empty;
+		cache.flags = 0;
+	}
+
+	const int missing = flags & ~cache.flags;
+
+	if (enabled)
+	{
+		if (missing)
+			nEvaluationCacheMisses_++;
+		else if (flags)
+			nEvaluationCacheHits_++;
+	}
+
+	if (missing & MaterialStageSetUniformsFlags::ColorGen)
+	{
+		vec4 baseColor, vertexColor;
+		calculateColors(&baseColor, &vertexColor);
+		cache.baseColor = util::ToLinear(baseColor);
+		cache.vertexColor = util::ToLinear(vertexColor);
+	}
+
+	if (missing & MaterialStageSetUniformsFlags::TexGen)
+	{
+		calculateTexMods(&cache.texMatrix, &cache.texOffTurb);
+	}
+
+	cache.flags |= missing;
+	return cache;
 }
 
 bool MaterialStage::shouldLerpTextureAnimation() const
@@ -286,18 +439,17 @@ void MaterialStage::calculateTexMods(vec4 *outMatrix, vec4 *outOffTurb) const
 	float currentMatrix[6] = { 1, 0, 0, 1, 0, 0 };
 	(*outMatrix) = { 1, 0, 0, 1 };
 	(*outOffTurb) = { 0, 0, 0, 0 };
-	const MaterialTextureBundle &bundle = bundles[0];
 
-	for (int tm = 0; tm < bundle.numTexMods; tm++)
+	for (int tm = 0; tm < numTexMods; tm++)
 	{
-		switch (bundle.texMods[tm].type)
+		switch (texMods[tm].type)
 		{
 		case MaterialTexMod::None:
-			tm = MaterialTextureBundle::maxTexMods; // break out of for loop
+			tm = maxTexMods; // break out of for loop
 			break;
 
 		case MaterialTexMod::Turbulent:
-			calculateTurbulentFactors(bundle.texMods[tm].wave, &(*outOffTurb)[2], &(*outOffTurb)[3]);
+			calculateTurbulentFactors(texMods[tm].wave, &(*outOffTurb)[2], &(*outOffTurb)[3]);
 			break;
 
 		case MaterialTexMod::EntityTranslate:
@@ -305,31 +457,31 @@ void MaterialStage::calculateTexMods(vec4 *outMatrix, vec4 *outOffTurb) const
 			break;
 
 		case MaterialTexMod::Scroll:
-			calculateScrollTexMatrix(bundle.texMods[tm].scroll, matrix);
+			calculateScrollTexMatrix(texMods[tm].scroll, matrix);
 			break;
 
 		case MaterialTexMod::Scale:
-			calculateScaleTexMatrix(bundle.texMods[tm].scale, matrix);
+			calculateScaleTexMatrix(texMods[tm].scale, matrix);
 			break;
 		
 		case MaterialTexMod::Stretch:
-			calculateStretchTexMatrix(bundle.texMods[tm].wave,  matrix);
+			calculateStretchTexMatrix(texMods[tm].wave,  matrix);
 			break;
 
 		case MaterialTexMod::Transform:
-			calculateTransformTexMatrix(bundle.texMods[tm], matrix);
+			calculateTransformTexMatrix(texMods[tm], matrix);
 			break;
 
 		case MaterialTexMod::Rotate:
-			calculateRotateTexMatrix(bundle.texMods[tm].rotateSpeed, matrix);
+			calculateRotateTexMatrix(texMods[tm].rotateSpeed, matrix);
 			break;
 
 		default:
-			interface::Error("ERROR: unknown texmod '%d' in shader '%s'", (int)bundle.texMods[tm].type, material->name);
+			interface::Error("ERROR: unknown texmod '%d' in shader '%s'", (int)texMods[tm].type, material->name);
 			break;
 		}
 
-		switch (bundle.texMods[tm].type)
+		switch (texMods[tm].type)
 		{	
 		case MaterialTexMod::None:
 		case MaterialTexMod::Turbulent:
@@ -586,6 +738,19 @@ float Material::setTime(float time)
 	return time_;
 }
 
+bool Material::canInlineFogPass() const
+{
+	// The fog pass blends over the final color of the surface. That's the output of the shader if there's one opaque pass, including any layers.
+	if (fogPass != MaterialFogPass::Equal || numUnfoggedPasses != 1)
+		return false;
+
+	const MaterialStage &stage = stages[0];
+	const bool opaque = (stage.blendSrc == 0 && stage.blendDst == 0) || (stage.blendSrc == BGFX_STATE_BLEND_ONE && stage.blendDst == BGFX_STATE_BLEND_ZERO);
+
+	// The texture variation shader doesn't do fog.
+	return stage.active && opaque && !stage.textureVariation;
+}
+
 bool Material::hasAutoSpriteDeform() const
 {
 	for (const MaterialDeformStage &ds : deforms)
@@ -634,10 +634,33 @@ vec3 Material::parseVector(char **text, bool *result) const
 	return v;
 }
 
+/// alphaFunc usually comes after the stage map, so look ahead for it. Alpha tested textures preserve alpha coverage when generating mipmaps.
+static bool IsStageAlphaTested(const char *text)
+{
+	for (const char *c = text; *c && *c != '}'; c++)
+	{
+		if (c[0] == '/' && c[1] == '/')
+		{
+			while (*c && *c != '\n')
+				c++;
+
+			if (!*c)
+				break;
+		}
+		else if (!util::Stricmpn(c, "alphaFunc", 9) && (c == text || isspace(c[-1])) && isspace(c[9]))
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
 bool Material::parseStage(MaterialStage *stage, char **text)
 {
 	bool depthWriteExplicit = false;
 	stage->active = true;
+	const int alphaTestFlags = IsStageAlphaTested(*text) ? TextureFlags::AlphaTest : TextureFlags::None;
 
 	for (;;)
 	{
@@ -777,7 +800,7 @@ bool Material::parseStage(MaterialStage *stage, char **text)
 				if (!noPicMip)
 					flags |= TextureFlags::Picmip;
 
-				stage->bundles[0].textures[0] = g_textureCache->find(token, flags);
+				stage->bundles[0].textures[0] = g_textureCache->find(token, flags | alphaTestFlags);
 
 				if (!stage->bundles[0].textures[0])
 				{
@@ -804,7 +827,7 @@ bool Material::parseStage(MaterialStage *stage, char **text)
 			if (!noPicMip)
 				flags |= TextureFlags::Picmip;
 
-			stage->bundles[0].textures[0] = g_textureCache->find(token, flags);
+			stage->bundles[0].textures[0] = g_textureCache->find(token, flags | alphaTestFlags);
 
 			if (!stage->bundles[0].textures[0])
 			{
@@ -845,7 +868,7 @@ bool Material::parseStage(MaterialStage *stage, char **text)
 					if (!noPicMip)
 						flags |= TextureFlags::Picmip;
 
-					stage->bundles[0].textures[num] = g_textureCache->find(token, flags);
+					stage->bundles[0].textures[num] = g_textureCache->find(token, flags | alphaTestFlags);
 
 					if (!stage->bundles[0].textures[num])
 					{
@@ -1335,7 +1358,7 @@ bool Material::parseStage(MaterialStage *stage, char **text)
 		// tcMod <type> <...>
 		else if (!util::Stricmp(token, "tcMod"))
 		{
-			if (stage->bundles[0].numTexMods == MaterialTextureBundle::maxTexMods)
+			if (stage->numTexMods == MaterialStage::maxTexMods)
 			{
 				interface::PrintWarningf("'%s': too many tcMod stages", name);
 				continue;
@@ -1354,8 +1377,8 @@ bool Material::parseStage(MaterialStage *stage, char **text)
 				util::Strcat(buffer, sizeof (buffer), " ");
 			}
 
-			stage->bundles[0].texMods[stage->bundles[0].numTexMods] = parseTexMod(buffer);
-			stage->bundles[0].numTexMods++;
+			stage->texMods[stage->numTexMods] = parseTexMod(buffer);
+			stage->numTexMods++;
 		}
 		// depthmask
 		else if (!util::Stricmp(token, "depthwrite"))
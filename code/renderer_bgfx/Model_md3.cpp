@@ -872,19 +872,14 @@ void Model_md3::render(const mat3 &sceneRotation, DrawCallList *drawCallList, En
 		}
 	}
 
-	int fogIndex = -1;
-
-	if (world::IsLoaded())
+	if (isAnimated)
 	{
-		if (isAnimated)
-		{
-			const Frame &frame = frames_[oldFrameIndex];
-			fogIndex = world::FindFogIndex(vec3(entity->position) + frame.position, frame.radius);
-		}
-		else
-		{
-			fogIndex = world::FindFogIndex(entity->position, frames_[0].radius);
-		}
+		const Frame &frame = frames_[oldFrameIndex];
+		main::ClassifyEntity(entity, vec3(entity->position) + frame.position, frame.radius);
+	}
+	else
+	{
+		main::ClassifyEntity(entity, entity->position, frames_[0].radius);
 	}
 
 	for (Surface &surface : surfaces_)
@@ -905,8 +900,9 @@ void Model_md3::render(const mat3 &sceneRotation, DrawCallList *drawCallList, En
 		}
 
 		DrawCall dc;
+		dc.dynamicLighting = entity->dynamicallyLit;
 		dc.entity = entity;
-		dc.fogIndex = fogIndex;
+		dc.fogIndex = entity->fogIndex;
 		dc.material = mat;
 		dc.modelMatrix = modelMatrix;
 
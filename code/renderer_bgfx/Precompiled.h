@@ -50,9 +50,12 @@ If you have questions concerning this license or the applicable additional terms
 
 #include <algorithm>
 #include <cmath>
+#include <condition_variable>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <vector>
 #include <float.h>
 
@@ -128,23 +131,50 @@ struct ConsoleVariables
 	ConsoleVariable backend;
 	ConsoleVariable bgfx_stats;
 	ConsoleVariable bloomScale;
+	ConsoleVariable collapseStages;
 	ConsoleVariable debug;
 	ConsoleVariable debugDraw;
 	ConsoleVariable debugDrawSize;
+	ConsoleVariable dynamicLightClusters;
 	ConsoleVariable dynamicLightIntensity;
 	ConsoleVariable dynamicLightScale;
+	ConsoleVariable dynamicResolutionMinScale;
+	ConsoleVariable dynamicResolutionSharpen;
+	ConsoleVariable dynamicResolutionTargetFps;
+	ConsoleVariable hdrAutoExposure;
+	ConsoleVariable hdrExposure;
+	ConsoleVariable imageCache;
+	ConsoleVariable imageLoadThreads;
+	ConsoleVariable inlineFog;
+	ConsoleVariable lightGridTexture;
+	ConsoleVariable materialCache;
+	ConsoleVariable materialShapes;
+	ConsoleVariable materialStageCache;
+	ConsoleVariable mipmapFilter;
 	ConsoleVariable picmip;
 	ConsoleVariable railWidth;
 	ConsoleVariable railCoreWidth;
 	ConsoleVariable railSegmentLength;
 	ConsoleVariable screenshotJpegQuality;
+	ConsoleVariable shaderCache;
+	ConsoleVariable shaderCacheSize;
+	ConsoleVariable shaderWarmup;
 	ConsoleVariable shadowDepthBias;
 	ConsoleVariable shadowNormalBias;
 	ConsoleVariable shadowSlopeScaleDepthBias;
 	ConsoleVariable sunLightIntensity;
+	ConsoleVariable textureMemoryBudget;
+	ConsoleVariable textureStreaming;
+	ConsoleVariable textureUploadBudget;
 	ConsoleVariable textureVariation;
 	ConsoleVariable wireframe;
 
+	/// @name Engine
+	/// Read by the renderer, owned by the engine.
+	/// @{
+	ConsoleVariable maxFps;
+	/// @}
+
 	/// @name Gamma
 	/// @{
 	ConsoleVariable gamma;
@@ -256,10 +286,11 @@ struct DynamicLight
 /*
 Cells texture:
 uint16_t offset into indices texture
+World grid cells (0...n), followed by view space clusters if enabled
 
 Indices texture:
-uint8_t num lights
-uint8_t light index (0...n) into lights texture
+uint16_t num lights
+uint16_t light index (0...n) into lights texture
 
 Lights texture:
 DynamicLight struct (0...n)
@@ -270,42 +301,131 @@ public:
 	DynamicLightManager();
 	~DynamicLightManager();
 	void add(uint32_t frameNo, const DynamicLight &light);
+
+	/// Measure the CPU cost of assigning a synthetic set of lights to the world grid and the view space clusters.
+	void benchmark(size_t nLights, int nIterations, vec3 cameraPosition, const mat3 &cameraRotation, vec2 cameraFov) const;
+
 	void clear();
 	void contribute(uint32_t frameNo, vec3 position, vec3 *color, vec3 *direction) const;
+
+	/// Batched contribute. Adds the lights reaching each position to the corresponding color and direction.
+	void contribute(uint32_t frameNo, const vec3 *positions, size_t nPositions, vec3 *colors, vec3 *directions) const;
+
 	bgfx::TextureHandle getCellsTexture() const { return cellsTexture_; }
 	bgfx::TextureHandle getIndicesTexture() const { return indicesTexture_; }
 	bgfx::TextureHandle getLightsTexture() const { return lightsTexture_; }
+	uint16_t getNumLights() const { return nLights_; }
 	void initializeGrid();
-	void updateTextures(uint32_t frameNo);
-	void updateUniforms(Uniforms *uniforms);
 
-	static const size_t maxLights = 256;
+	/// @return true if any light reaches the bounds.
+	bool touchesBounds(uint32_t frameNo, const Bounds &bounds) const;
+
+	/// @return true if any light reaches the sphere.
+	bool touchesSphere(uint32_t frameNo, vec3 position, float radius) const;
+
+	/// Build the coarse CPU grid used by contribute and touchesSphere. Call once all of the scene's lights have been added.
+	void updateQueryGrid(uint32_t frameNo);
+
+	/// @remarks The view space clusters are built for this camera.
+	void updateTextures(uint32_t frameNo, vec3 cameraPosition, const mat3 &cameraRotation, vec2 cameraFov);
+
+	/// @param useClusters Use the view space clusters. Only valid for the camera passed to updateTextures, other cameras use the world grid.
+	void updateUniforms(Uniforms *uniforms, bool useClusters);
+
+	static const size_t maxLights = 1024;
 
 private:
-	void decodeAssignedLight(uint32_t value, vec3b *cellPosition, uint8_t *lightIndex) const;
-	uint32_t encodeAssignedLight(vec3b cellPosition, uint8_t lightIndex) const;
+	/// A view space cluster grid: screen tiles by exponential depth slices.
+	struct ClusterCamera
+	{
+		vec3 position;
+		vec3 forward, left, up;
+		vec2 tanHalfFov;
+		float zNear, zFar;
+
+		/// Number of slices per log unit of depth.
+		float sliceScale;
+	};
+
+	/// Coarse grid over the bounds of the scene's lights, for CPU queries.
+	/// @remarks Separate from the world grid so non-world scenes (menus, HUD models) can use it too.
+	struct QueryGrid
+	{
+		Bounds bounds;
+		vec3 cellSize;
+		vec3i size;
+
+		/// The lights in cell i are lightIndices[cellOffsets[i]] to lightIndices[cellOffsets[i + 1] - 1].
+		std::vector<uint32_t> cellOffsets;
+
+		std::vector<uint16_t> lightIndices;
+
+		/// Scratch space for filling lightIndices.
+		std::vector<uint32_t> cellCursors;
+
+		/// Cleared when lights are added or cleared.
+		bool built = false;
+
+		uint32_t frameNo = 0;
+	};
+
+	/// @return true if test returns true for any light overlapping bounds. Uses the query grid if it's valid.
+	/// @remarks A template so the test is inlined into the per batch query.
+	template<typename Test>
+	bool anyLight(uint32_t frameNo, const Bounds &bounds, Test test) const;
+
+	/// Append lights touching world grid cells to assignedLights.
+	void assignLightsToGrid(const DynamicLight *lights, size_t nLights, std::vector<uint32_t> *assignedLights) const;
+
+	/// Append lights touching view space clusters to assignedLights.
+	void assignLightsToClusters(const ClusterCamera &camera, const DynamicLight *lights, size_t nLights, std::vector<uint32_t> *assignedLights) const;
+
+	/// @return The view space bounds of a cluster. x is left, y is up, z is forward.
+	Bounds calculateClusterBounds(const ClusterCamera &camera, int tileX, int tileY, int slice) const;
+
+	ClusterCamera createClusterCamera(vec3 position, const mat3 &rotation, vec2 fov) const;
+	static void contributeLight(const DynamicLight &light, vec3 position, vec3 *color, vec3 *direction);
+	void decodeAssignedLight(uint32_t value, size_t *cellIndex, uint16_t *lightIndex) const;
+	uint32_t encodeAssignedLight(size_t cellIndex, uint16_t lightIndex) const;
 
 	size_t cellIndexFromCellPosition(vec3b position) const;
 
 	/// @remarks Result is clamped.
 	vec3b cellPositionFromWorldspacePosition(vec3 position) const;
 
+	/// @remarks Result is clamped.
+	int clusterSliceFromDepth(const ClusterCamera &camera, float z) const;
+
+	bool isQueryGridValid(uint32_t frameNo) const;
+
+	/// @remarks Result is clamped.
+	vec3i queryCellFromPosition(vec3 position) const;
+
+	size_t queryCellIndex(vec3i cell) const { return cell.x + cell.y * (size_t)queryGrid_.size.x + cell.z * (size_t)queryGrid_.size.x * (size_t)queryGrid_.size.y; }
+
 	bgfx::TextureHandle cellsTexture_;
 	std::vector<uint16_t> cellsTextureData_[BGFX_NUM_BUFFER_FRAMES];
 	uint16_t cellsTextureSize_;
 
 	bgfx::TextureHandle indicesTexture_;
-	std::vector<uint8_t> indicesTextureData_[BGFX_NUM_BUFFER_FRAMES];
+	std::vector<uint16_t> indicesTextureData_[BGFX_NUM_BUFFER_FRAMES];
 	uint16_t indicesTextureSize_;
 
 	std::vector<uint32_t> assignedLights_;
 	vec3i cellSize_;
 	vec3 gridOffset_;
 	vec3b gridSize_;
+
+	/// @remarks Cluster cells start after the world grid cells.
+	size_t nGridCells_ = 0;
+
+	ClusterCamera clusterCamera_;
+	bool clustersEnabled_ = false;
 	DynamicLight lights_[BGFX_NUM_BUFFER_FRAMES][maxLights];
-	uint8_t nLights_;
+	uint16_t nLights_;
 	bgfx::TextureHandle lightsTexture_;
 	uint16_t lightsTextureSize_;
+	QueryGrid queryGrid_;
 };
 
 struct EntityFlags
@@ -379,6 +499,24 @@ struct Entity
 
 	vec3 directedLight;
 
+	/// Dynamic light added to directedLight and lightDir in non-world scenes. Calculated for all entities at once, before the scene is rendered.
+	vec3 dynamicLightColor;
+	vec3 dynamicLightDir;
+
+	/// @}
+
+	/// @name Classification
+	/// Found by the first camera that draws the entity, and reused by later cameras in the same scene. See main::ClassifyEntity.
+	/// @{
+
+	bool classified = false;
+
+	/// Fog volume the entity is in, or -1 if none.
+	int fogIndex = -1;
+
+	/// A dynamic light reaches the entity.
+	bool dynamicallyLit = false;
+
 	/// @}
 };
 
@@ -413,13 +551,48 @@ struct CreateImageFlags
 {
 	enum
 	{
-		GenerateMipmaps    = 1<<0,
-		Picmip             = 1<<1
+		GenerateMipmaps       = 1<<0,
+		Picmip                = 1<<1,
+
+		/// Average RGB in linear space when generating mipmaps.
+		GammaCorrectMipmaps   = 1<<2,
+
+		/// Scale mipmap alpha so the same fraction of pixels pass the alpha test at every mip level.
+		PreserveAlphaCoverage = 1<<3,
+
+		/// Generate mipmaps with stb_image_resize instead of the 2x2 box filter.
+		ResampleMipmaps       = 1<<4
 	};
 };
 
+/// The contents of an image file, read on the main thread so the image can be decoded on any thread.
+struct ImageFile
+{
+	char filename[MAX_QPATH];
+	std::vector<uint8_t> data;
+
+	/// @name Processed image cache
+	/// @{
+
+	/// Empty if r_imageCache is disabled.
+	char cacheFilename[MAX_QPATH];
+
+	/// The cache file contents if it exists, or a new cache file serialized by DecodeImageFile.
+	std::vector<uint8_t> cacheData;
+
+	/// cacheData is a new cache file that needs to be written by WriteImageCacheFile.
+	bool writeCache = false;
+	/// @}
+};
+
+void BenchmarkMaterialTextIndex(int nFiles, int nDefinitionsPerFile);
+void BenchmarkMipmaps(const char *directory);
+void BuildImageCache(const char *directory);
 Image CreateImage(int width, int height, int nComponents, uint8_t *data, int flags = 0);
+const char *DecodeImageFile(ImageFile *imageFile, int flags, int picmip, Image *image);
 Image LoadImage(const char *filename, int flags = 0);
+bool ReadImageFile(const char *filename, int flags, ImageFile *imageFile);
+void WriteImageCacheFile(ImageFile *imageFile);
 
 struct IndexBuffer
 {
@@ -436,6 +609,7 @@ namespace main
 	bool AreWaterReflectionsEnabled();
 	bool AreExtraDynamicLightsEnabled();
 	float CalculateNoise(float x, float y, float z, float t);
+	void ClassifyEntity(Entity *entity, vec3 position, float radius);
 	void DebugPrint(const char *format, ...);
 	void DrawAxis(vec3 position);
 	void DrawBounds(const Bounds &bounds);
@@ -443,11 +617,16 @@ namespace main
 	void DrawStretchPicGradient(float x, float y, float w, float h, float s1, float t1, float s2, float t2, int materialIndex, vec4 gradientColor);
 	void DrawStretchRaw(int x, int y, int w, int h, int cols, int rows, const uint8_t *data, int client, bool dirty);
 	void EndFrame();
+	void EndRegistration();
+	int FindMaterialShape(uint32_t key);
 	const Entity *GetCurrentEntity();
 	float GetFloatTime();
+	uint32_t GetFrameNo();
 	Transform GetMainCameraTransform();
+	const char *GetMaterialShapeName(int shape);
 	void Initialize();
 	bool IsCameraMirrored();
+	bool IsCollapseStagesEnabled();
 	bool IsLerpTextureAnimationEnabled();
 	bool IsMaxAnisotropyEnabled();
 	void LoadWorld(const char *name); 
@@ -458,6 +637,10 @@ namespace main
 	const SunLight &GetSunLight();
 	void SetSunLight(const SunLight &sunLight); 
 	void Shutdown(bool destroyWindow);
+
+	/// @return true if any of the current scene's dynamic lights reaches the bounds.
+	bool TouchesDynamicLight(const Bounds &bounds);
+
 	void UploadCinematic(int w, int h, int cols, int rows, const uint8_t *data, int client, bool dirty);
 }
 
@@ -745,8 +928,6 @@ struct MaterialTextureBundle
 {
 	MaterialTextureBundle() : textures() {}
 
-	static const size_t maxTexMods = 4;
-
 	static const size_t maxImageAnimations = 8;
 	const Texture *textures[maxImageAnimations];
 	int numImageAnimations = 0;
@@ -755,24 +936,19 @@ struct MaterialTextureBundle
 	MaterialTexCoordGen tcGen = MaterialTexCoordGen::None;
 	vec3 tcGenVectors[2];
 
-	int numTexMods = 0;
-	MaterialTexModInfo texMods[maxTexMods];
-
 	int videoMapHandle = 0;
 	bool isLightmap = false;
 	bool isVideoMap = false;
 };
 
 /// Indices into MaterialStage::bundle
+/// @remarks Normal and specular map stages are parsed, but deactivated when the material is finished, so they don't have bundles.
 struct MaterialTextureBundleIndex
 {
 	enum
 	{
 		DiffuseMap,
 		Lightmap,
-		NormalMap,
-		Deluxemap,
-		Specularmap,
 		NumMaterialTextureBundles
 	};
 };
@@ -794,6 +970,11 @@ struct MaterialStage
 
 	MaterialTextureBundle bundles[MaterialTextureBundleIndex::NumMaterialTextureBundles];
 
+	/// Applied to the diffuse map texture coordinates.
+	static const size_t maxTexMods = 4;
+	int numTexMods = 0;
+	MaterialTexModInfo texMods[maxTexMods];
+
 	MaterialWaveForm rgbWave;
 	MaterialColorGen rgbGen = MaterialColorGen::Bad;
 
@@ -827,12 +1008,70 @@ struct MaterialStage
 
 	vec2 zFadeBounds; // for MaterialAlphaGen::NormalZFade
 
+	/// @name Layers
+	/// Later stages that are blended in the fragment shader instead of being drawn as separate passes. See Material::collapseStagesToLayers.
+	/// @{
+	static const size_t maxLayers = MAX_STAGE_LAYERS;
+	int numLayers = 0;
+
+	/// Indices into Material::stages. Layer stages are inactive, and stored after the active stages.
+	int layers[maxLayers] = {};
+
+	/// LAYER_BLEND_*
+	int layerBlends[maxLayers] = {};
+	/// @}
+
+	/// MaterialShapeId of the specialized generic shader that draws this stage, or -1 to use the generic shader.
+	int shape = -1;
+
+	/// Get the key identifying the shape of this stage: light type, number of layers and layer blends. See s_materialShapeKeys.
+	/// @return false if the stage uses generic shader features that shapes don't have, so it can't have a shape.
+	bool getShapeKey(uint32_t *key) const;
+
+	/// @return true if this stage or any of its layers adjust colors for fog.
+	bool adjustsColorsForFog() const;
+
 	vec4 getFogColorMask() const;
 	uint64_t getState() const;
 	void setShaderUniforms(Uniforms_MaterialStage *uniforms, int flags = MaterialStageSetUniformsFlags::All) const;
 	void setTextureSamplers(Uniforms_MaterialStage *uniforms) const;
 
+	/// @name Evaluation cache
+	/// Colors and texture matrices evaluated by setShaderUniforms are reused by later draw calls in the same frame with the same inputs.
+	/// @{
+
+	/// Evaluations counted since the last call. Only counted if the cache is enabled.
+	static void getEvaluationCacheStats(int *hits, int *misses, bool reset);
+
 private:
+	struct EvaluationCache
+	{
+		uint32_t frameNo = UINT32_MAX;
+		float time = 0;
+
+		/// The entity inputs the stage reads. Keyed by value, not by entity pointer, since scene entities are reused by later scenes in the same frame.
+		/// Only set if the stage reads entity color or texture coordinates.
+		bool hasEntity = false;
+		vec4 entityColor;
+		vec2 entityTexCoord;
+
+		/// MaterialStageSetUniformsFlags that have been evaluated for this frame, time and entity inputs.
+		int flags = 0;
+
+		vec4 baseColor, vertexColor;
+		vec4 texMatrix, texOffTurb;
+	};
+
+	bool dependsOnEntity() const;
+
+	/// Evaluate anything in flags that isn't cached for the current inputs.
+	const EvaluationCache &evaluate(int flags) const;
+
+	mutable EvaluationCache evaluationCache_;
+	static int nEvaluationCacheHits_, nEvaluationCacheMisses_;
+
+	/// @}
+
 	/// @name Calculate
 	/// @{
 	bool shouldLerpTextureAnimation() const;
@@ -953,6 +1192,11 @@ private:
 	void finish();
 	int collapseStagesToGLSL();
 
+	/// Fold runs of stages that blend with add, modulate or lerp by alpha into the preceding opaque stage, as layers blended in the shader.
+	/// @param numStages The number of active stages, which must be at the start of the stages array.
+	/// @return The number of active stages after collapsing.
+	int collapseStagesToLayers(int numStages);
+
 	/// @}
 
 public:
@@ -964,6 +1208,9 @@ public:
 	/// @remarks Used for animated textures, waveforms etc.
 	float setTime(float time);
 
+	/// @return true if the fog pass can be blended in the shader of this material's only stage, instead of being drawn as a separate pass.
+	bool canInlineFogPass() const;
+
 	bool hasAutoSpriteDeform() const;
 	void doAutoSpriteDeform(const mat3 &sceneRotation, Vertex *vertices, uint32_t nVertices, uint16_t *indices, uint32_t nIndices, float *softSpriteDepth) const;
 	void setDeformUniforms(Uniforms_Material *uniforms) const;
@@ -974,6 +1221,59 @@ private:
 	/// @}
 };
 
+/// Index of the material definitions in .shader files, built in a single pass over each file.
+class MaterialTextIndex
+{
+public:
+	/// Copy and index the text of a .shader file. If a definition is malformed, the rest of the file is ignored.
+	void addFile(const char *filename, const char *text, size_t length);
+
+	/// Build the name lookup table. Call after adding all files.
+	/// @remarks When more than one file defines a material, the definition in the file added last wins. Within a file, the first definition wins.
+	void build();
+
+	/// @return The definition text following the material name, starting with the opening brace. nullptr if not found.
+	char *find(const char *name, size_t *length = nullptr);
+
+	/// @return A hash of the names and contents of all the files, in the order they were added.
+	uint32_t getHash() const;
+
+	size_t getNumDefinitions() const { return definitions_.size(); }
+	size_t getNumFiles() const { return files_.size(); }
+	size_t getTextSize() const { return text_.size(); }
+
+private:
+	struct File
+	{
+		char name[MAX_QPATH];
+		size_t offset;
+		size_t length;
+		uint32_t hash;
+	};
+
+	struct Definition
+	{
+		uint32_t nameHash;
+		size_t nameOffset;
+		size_t file;
+
+		/// Definition text, relative to the start of text_.
+		size_t offset;
+		size_t length;
+	};
+
+	static uint32_t hashName(const char *name);
+	int findSlot(uint32_t nameHash, const char *name) const;
+
+	std::vector<char> text_;
+	std::vector<char> names_;
+	std::vector<File> files_;
+	std::vector<Definition> definitions_;
+
+	/// Open addressing. Indices into definitions_, -1 if empty.
+	std::vector<int> hashTable_;
+};
+
 class MaterialCache
 {
 public:
@@ -981,38 +1281,101 @@ public:
 	Material *createMaterial(const Material &base);
 	Material *findMaterial(const char *name, int lightmapIndex = MaterialLightmapId::StretchPic, bool mipRawImage = true);
 	void remapMaterial(const char *oldName, const char *newName, const char *offsetTime);
-	Material *getMaterial(int handle) { return materials_[handle].get(); }
+	Material *getMaterial(int handle) { return materials_[handle]; }
 	Material *getDefaultMaterial() { return defaultMaterial_; }
+	size_t getNumMaterials() const { return materials_.size(); }
 	void printMaterials() const;
 
+	/// Print the shape of each material's stages, and estimate the shader work saved by specialized shape shaders.
+	void printMaterialShapes() const;
+
+	/// Write the shapes of the loaded material stages to materialshapes.txt, most used first, in the format of shaders/MaterialShapes.txt.
+	void writeMaterialShapes() const;
+
 	Skin *findSkin(const char *name);
 	Skin *getSkin(qhandle_t handle);
 
+	/// Write the binary cache if materials have been added to it.
+	void writeBinaryCache();
+
 private:
 	size_t generateHash(const char *fname, size_t size);
 
 	void createInternalShaders();
 
-	/// Finds and loads all .shader files, combining them into a single large text block that can be scanned for shader names.
+	/// Finds and loads all .shader files, indexing the material definitions they contain.
 	void scanAndLoadShaderFiles();
 
 	void createExternalShaders();
 
-	/// Scans the combined text description of all the shader files for the given shader name.
-	/// @return If found, a valid shader. NULL if not found.
-	char *findShaderInShaderText(const char *name);
+	MaterialTextIndex textIndex_;
+
+	/// @name Binary cache
+	/// Parsed materials, so they can be created without tokenizing their definitions.
+	/// @{
+
+	/// How to find the texture in one of a material's texture slots.
+	struct BinaryTextureRef
+	{
+		enum class Type : uint16_t
+		{
+			Default,
+			Lightmap,
+			Named,
+			White
+		};
+
+		uint16_t slot;
+		Type type;
+		int flags;
+		char name[MAX_QPATH];
+	};
+
+	/// The cache is only valid for the same set of shader files, and the same Material layout.
+	struct BinaryCacheHeader
+	{
+		static const uint32_t currentMagic = 0x4354414d; // "MATC"
+		static const uint32_t currentVersion = 4;
+		uint32_t magic;
+		uint32_t version;
+		uint32_t materialSize;
+		uint32_t shaderFilesHash;
+		uint32_t collapseStages; ///< Collapsed layers are part of the parsed material.
+		uint32_t nEntries;
+	};
+
+	/// Parse a material from its definition text, or read it from the binary cache.
+	Material *parseMaterial(Material *material, char *definition, size_t definitionLength);
+
+	void readBinaryCache();
+
+	/// @return false if the material isn't in the cache, or one of its textures can't be found.
+	bool readBinaryMaterial(const char *name, Material *material);
+
+	/// Add a material that has just been parsed from the definition text.
+	/// @remarks Materials that change anything outside themselves while parsing (e.g. set sun light or fog cvars, play videos) aren't added.
+	void writeBinaryMaterial(const Material &material, const char *definition, size_t definitionLength);
+
+	int binaryCacheMode_;
+	uint32_t shaderFilesHash_;
+
+	/// Entries, keyed by lowercase material name. Values are offsets into binaryData_.
+	std::map<std::string, size_t> binaryEntries_;
+
+	std::vector<uint8_t> binaryData_;
+	bool binaryCacheDirty_ = false;
+	int nBinaryHits_ = 0, nBinaryMisses_ = 0, nBinaryMismatches_ = 0;
+	/// @}
 
-	static const size_t maxShaderFiles_ = 4096;
-	std::vector<char> shaderText_;
+	/// Materials are allocated in blocks, so materials created together (e.g. by the same map) are close in memory.
+	static const size_t materialsPerBlock_ = 64;
+	std::vector<std::unique_ptr<Material[]>> materialBlocks_;
 
-	std::vector<std::unique_ptr<Material>> materials_;
+	std::vector<Material *> materials_;
 
 	static const size_t hashTableSize_ = 1024;
 	Material *hashTable_[hashTableSize_];
 
-	static const size_t textHashTableSize_ = 2048;
-	char **textHashTable_[textHashTableSize_];
-
 	Material *defaultMaterial_;
 
 	std::vector<std::unique_ptr<Skin>> skins_;
@@ -1303,6 +1666,9 @@ struct TextureFlags
 		Mutable     = 1<<1,
 		Picmip      = 1<<2,
 		ClampToEdge = 1<<3,
+
+		/// Used by an alpha tested material stage.
+		AlphaTest   = 1<<4,
 	};
 };
 
@@ -1316,11 +1682,16 @@ public:
 	const char *getName() const { return name_; }
 	int getWidth() const { return width_; }
 	int getHeight() const { return height_; }
+	uint32_t getMemorySize() const { return memorySize_; }
+
+	/// Record that the texture was used this frame. Least recently used textures are the first to drop mips when over r_textureMemoryBudget.
+	void setLastUsedFrame(uint32_t frameNo) const { lastUsedFrame_ = frameNo; }
 
 private:
 	void initialize(const char *name, const Image &image, int flags, bgfx::TextureFormat::Enum format);
 	void initialize(const char *name, bgfx::TextureHandle handle);
 	uint32_t calculateBgfxFlags() const;
+	void calculateMemorySize();
 
 	char name_[MAX_QPATH];
 	int flags_;
@@ -1330,6 +1701,24 @@ private:
 	bgfx::TextureHandle handle_;
 	Texture *next_;
 
+	/// @name Residency
+	/// @{
+
+	/// Estimated video memory used by the texture, in bytes.
+	uint32_t memorySize_ = 0;
+
+	mutable uint32_t lastUsedFrame_ = 0;
+
+	/// The number of top mip levels that aren't resident. width_ and height_ are the size of the largest resident mip.
+	int nDroppedMips_ = 0;
+
+	/// The texture was loaded from a file, and can be reloaded to drop or restore mips.
+	bool reloadable_ = false;
+
+	/// An image load is pending for this texture.
+	bool loading_ = false;
+	/// @}
+
 	friend class TextureCache;
 };
 
@@ -1353,9 +1742,46 @@ public:
 	Texture *getScratch(size_t index) { return scratchTextures_[index]; }
 	void alias(Texture *from, Texture *to);
 
+	/// Upload images that have finished loading on the image load threads.
+	/// @param wait Wait for all pending image loads to finish first. If false, r_textureUploadBudget limits how much is uploaded.
+	void uploadLoadedImages(bool wait);
+
+	/// All pending image loads are finished and uploaded. Unless streaming, images are loaded on the main thread from now on.
+	void endRegistration();
+
+	/// Drop or restore the top mip levels of textures to stay within r_textureMemoryBudget. Called once per frame.
+	void updateResidency(uint32_t frameNo);
+
+	void printResidency() const;
+
 private:
+	/// An image being decoded and mipmapped on an image load thread. The texture uses the default texture handle until the image is uploaded.
+	struct PendingImageLoad
+	{
+		Texture *texture;
+		ImageFile file;
+		int imageFlags;
+		Image image;
+		const char *error = nullptr;
+		bool loaded = false;
+
+		/// Reloading an already uploaded texture to change the number of resident mips.
+		bool reload = false;
+
+		int nDroppedMips = 0;
+
+		/// Estimated change in texture memory when this image is uploaded.
+		int64_t memoryChange = 0;
+	};
+
+	Texture *createPending(const char *name, int flags, int imageFlags);
+	void queueImageLoad(std::unique_ptr<PendingImageLoad> load);
+	bool reloadTexture(Texture *texture, int nDroppedMips);
+	void uploadImage(Texture *texture, const Image &image, int nDroppedMips);
 	void hashTexture(Texture *texture);
 	size_t generateHash(const char *name) const;
+	void imageLoadThread();
+	void stopImageLoadThreads();
 
 	static const size_t maxTextures_ = 2048;
 	Texture textures_[maxTextures_];
@@ -1376,6 +1802,39 @@ private:
 	uint8_t scratchImageData_[nScratchTextures_][defaultImageDataSize_];
 	std::array<Texture *, nScratchTextures_> scratchTextures_;
 	std::map<Texture *, Texture *> aliases_;
+
+	/// @name Image load threads
+	/// @{
+
+	/// Images are loaded on the image load threads until endRegistration is called.
+	bool registering_ = true;
+
+	/// r_picmip is latched, but read it once on the main thread so the image load threads never touch the cvar.
+	int picmip_;
+
+	/// Keep loading images on the image load threads after registration. Set by r_textureStreaming.
+	bool streamImages_;
+
+	std::vector<std::thread> imageLoadThreads_;
+	std::mutex imageLoadMutex_;
+	std::condition_variable imageLoadQueued_, imageLoadFinished_;
+	std::vector<std::unique_ptr<PendingImageLoad>> pendingImageLoads_;
+	size_t nextImageLoad_ = 0; ///< Index into pendingImageLoads_ of the next image for an image load thread to load.
+	size_t nextImageUpload_ = 0; ///< Index into pendingImageLoads_ of the next image to upload. Images are uploaded in the order they were requested.
+	size_t nLoadedImages_ = 0;
+	bool stopImageLoadThreads_ = false;
+	/// @}
+
+	/// @name Residency
+	/// @{
+	static const int maxResidencyChangesPerFrame_ = 4;
+
+	/// Sum of PendingImageLoad::memoryChange for all pending image loads.
+	int64_t pendingMemoryChange_ = 0;
+
+	uint32_t nMipsDropped_ = 0;
+	uint32_t nMipsRestored_ = 0;
+	/// @}
 };
 
 /// Texture units used by the generic shader(s).
@@ -1391,7 +1850,31 @@ struct TextureUnit
 		DynamicLightIndices = TU_DYNAMIC_LIGHT_INDICES,
 		DynamicLights       = TU_DYNAMIC_LIGHTS,
 		ShadowMap           = TU_SHADOWMAP,
-		Noise               = TU_NOISE
+		Noise               = TU_NOISE,
+		Layer0              = TU_LAYER0,
+		Layer1              = TU_LAYER1,
+		LightGridAmbient    = TU_LIGHT_GRID_AMBIENT,
+		LightGridDirected   = TU_LIGHT_GRID_DIRECTED,
+		LightGridDirection  = TU_LIGHT_GRID_DIRECTION,
+		GBufferAlbedo       = TU_GBUFFER_ALBEDO,
+		GBufferNormal       = TU_GBUFFER_NORMAL
+	};
+};
+
+struct LightGridTexture
+{
+	enum
+	{
+		/// rgb is ambient light in gamma space, alpha is 0 for samples in walls.
+		Ambient,
+
+		/// rgb is directed light in gamma space.
+		Directed,
+
+		/// xyz is the light direction, scaled and biased to 0-1.
+		Direction,
+
+		Num
 	};
 };
 
@@ -1458,12 +1941,38 @@ struct Uniforms
 	Uniform_vec4 portalPlane = "u_PortalPlane";
 	/// @}
 
+	/// @name Light grid
+	/// @{
+
+	/// @remarks xyz is the world space origin, w is 1 if the light grid textures are bound for vector lit stages.
+	Uniform_vec4 lightGridOrigin_Enabled = "u_LightGridOrigin_Enabled";
+
+	/// @remarks xyz is 1 / the grid cell size, w is the minimum ambient light added to entities.
+	Uniform_vec4 lightGridInverseSize_MinAmbient = "u_LightGridInverseSize_MinAmbient";
+
+	/// @remarks xyz is the number of grid points, w not used.
+	Uniform_vec4 lightGridBounds = "u_LightGridBounds";
+
+	/// @}
+
 	/// @name Dynamic lights
 	/// @{
 
 	/// @remarks xyz is cell size in world coordinates, w is the texture size.
 	Uniform_vec4 dynamicLightCellSize = "u_DynamicLightCellSize";
 
+	/// @remarks xyz is the cluster camera forward axis, w is the first cluster cell index (0 if clusters are disabled).
+	Uniform_vec4 dynamicLightClusterForward_Offset = "u_DynamicLightClusterForward_Offset";
+
+	/// @remarks xyz is the cluster camera left axis divided by tan(fovX / 2), w is the number of slices per log unit of depth.
+	Uniform_vec4 dynamicLightClusterLeft_SliceScale = "u_DynamicLightClusterLeft_SliceScale";
+
+	/// @remarks xyz is the cluster camera position, w is the depth of the first slice boundary.
+	Uniform_vec4 dynamicLightClusterOrigin_Near = "u_DynamicLightClusterOrigin_Near";
+
+	/// @remarks xyz is the cluster camera up axis divided by tan(fovY / 2), w not used.
+	Uniform_vec4 dynamicLightClusterUp = "u_DynamicLightClusterUp";
+
 	/// @remarks w not used.
 	Uniform_vec4 dynamicLightGridOffset = "u_DynamicLightGridOffset";
 
@@ -1473,6 +1982,9 @@ struct Uniforms
 	/// @remarks x is the number of dynamic lights, y is the intensity scale.
 	Uniform_vec4 dynamicLight_Num_Intensity = "u_DynamicLight_Num_Intensity";
 
+	/// @brief Used by the deferred light pass to reconstruct world space positions from G-buffer depth.
+	Uniform_mat4 deferredInvViewProj = "u_DeferredInvViewProj";
+
 	/// @remarks w not used.
 	Uniform_vec4 dynamicLightTextureSizes_Cells_Indices_Lights = "u_DynamicLightTextureSizes_Cells_Indices_Lights";
 
@@ -1482,9 +1994,12 @@ struct Uniforms
 	/// @{
 
 	/// @brief Enable fog in the generic shader.
-	/// @remarks Only x used.
+	/// @remarks x adjusts stage colors for fog, y blends the fog color over the output instead of drawing a fog pass.
 	Uniform_vec4 fogEnabled = "u_FogEnabled";
 
+	/// @remarks Used when fogEnabled.y is set.
+	Uniform_vec4 fogColor = "u_FogColor";
+
 	Uniform_vec4 fogDistance = "u_FogDistance";
 	Uniform_vec4 fogDepth = "u_FogDepth";
 
@@ -1494,12 +2009,39 @@ struct Uniforms
 
 	/// @name Bloom
 	/// @{
-	Uniform_vec4 guassianBlurDirection = "u_GuassianBlurDirection";
+	/// @remarks Offset between filter taps in texture coordinates. Only xy used.
+	Uniform_vec4 bloomTapOffset = "u_BloomTapOffset";
 
-	/// @remarks z and w not used.
+	/// @remarks Only x used. The bloom scale is in exposure_Key_BloomScale.
 	Uniform_vec4 bloom_Write_Scale = "u_Bloom_Write_Scale";
 	/// @}
 
+	/// @name Dynamic resolution
+	/// @{
+
+	/// @remarks The fraction of the full size targets the world scene is rendered to. Only xy used.
+	Uniform_vec4 sceneScale = "u_SceneScale";
+
+	/// @remarks xy is the source texel size, z is the sharpening amount.
+	Uniform_vec4 sharpenTexelSize_Amount = "u_SharpenTexelSize_Amount";
+
+	/// @remarks Post process filter taps are clamped to these bounds, so they don't read stale texels outside the scaled rect. xy is the minimum, zw is the maximum.
+	Uniform_vec4 texCoordClamp = "u_TexCoordClamp";
+
+	/// @remarks Like texCoordClamp, for bloom read by the composite passes.
+	Uniform_vec4 bloomTexCoordClamp = "u_BloomTexCoordClamp";
+	/// @}
+
+	/// @name HDR
+	/// @{
+
+	/// @remarks y is the key value the average luminance is scaled to, 0 if auto exposure is disabled. z is the bloom scale, 0 if bloom is disabled.
+	Uniform_vec4 exposure_Key_BloomScale = "u_Exposure_Key_BloomScale";
+
+	/// @remarks xy is the tap offset in texture coordinates, z is LUMINANCE_PASS_*, w is the adaptation fraction for LUMINANCE_PASS_ADAPT.
+	Uniform_vec4 luminanceTapOffset_Pass = "u_LuminanceTapOffset_Pass";
+	/// @}
+
 	/// @name Sun light
 	/// @{
 	Uniform_mat4 lightModelViewProj = "u_LightModelViewProj";
@@ -1515,6 +2057,7 @@ struct Uniforms
 	Uniform_sampler textureSampler = "s_Texture";
 
 	Uniform_sampler bloomSampler = "s_Bloom";
+	Uniform_sampler luminanceSampler = "s_Luminance";
 	Uniform_sampler shadowMapSampler = "s_Shadow";
 	Uniform_sampler smaaColorSampler = "s_SmaaColor";
 	Uniform_sampler smaaEdgesSampler = "s_SmaaEdges";
@@ -1571,6 +2114,12 @@ struct Uniforms_MaterialStage
 	Uniform_sampler dynamicLightCellsSampler = "s_DynamicLightCells";
 	Uniform_sampler dynamicLightIndicesSampler = "s_DynamicLightIndices";
 	Uniform_sampler dynamicLightsSampler = "s_DynamicLights";
+	Uniform_sampler gBufferAlbedoSampler = "s_GBufferAlbedo";
+	Uniform_sampler gBufferNormalSampler = "s_GBufferNormal";
+	Uniform_sampler layerSamplers[MaterialStage::maxLayers] = { "s_Layer0", "s_Layer1" };
+	Uniform_sampler lightGridAmbientSampler = "s_LightGridAmbient";
+	Uniform_sampler lightGridDirectedSampler = "s_LightGridDirected";
+	Uniform_sampler lightGridDirectionSampler = "s_LightGridDirection";
 	Uniform_sampler lightSampler = "s_Light";
 	/// @}
 
@@ -1609,6 +2158,21 @@ struct Uniforms_MaterialStage
 	/// @remarks Only x used.
 	Uniform_vec4 portalRange = "u_PortalRange";
 	/// @}
+
+	/// @name Layers
+	/// @{
+
+	/// @remarks x is the number of layers, y and z are the tcGen of each layer.
+	Uniform_vec4 layers_Num_TCGen = "u_Layers_Num_TCGen";
+
+	/// @remarks LAYER_BLEND_* of each layer.
+	Uniform_vec4 layerBlend = "u_LayerBlend";
+
+	Uniform_vec4 layerColor = { "u_LayerColor", MaterialStage::maxLayers };
+	Uniform_vec4 layerFogColorMask = { "u_LayerFogColorMask", MaterialStage::maxLayers };
+	Uniform_vec4 layerTextureMatrix = { "u_LayerTexMatrix", MaterialStage::maxLayers };
+	Uniform_vec4 layerTextureOffsetTurbulent = { "u_LayerTexOffTurb", MaterialStage::maxLayers };
+	/// @}
 };
 
 namespace util
@@ -1772,7 +2336,15 @@ namespace world
 	Texture *GetLightmap(int index);
 	bool GetEntityToken(char *buffer, int size);
 	bool HasLightGrid();
+
+	/// @return false if 3D textures aren't supported or the map has no light grid.
+	bool HasLightGridTextures();
+
+	/// @param index LightGridTexture.
+	bgfx::TextureHandle GetLightGridTexture(int index);
+
 	void SampleLightGrid(vec3 position, vec3 *ambientLight, vec3 *directedLight, vec3 *lightDir);
+	void UpdateLightGridUniforms(Uniforms *uniforms);
 	bool InPvs(vec3 position);
 	bool InPvs(vec3 position1, vec3 position2);
 	int FindFogIndex(vec3 position, float radius);
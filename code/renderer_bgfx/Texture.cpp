@@ -46,6 +46,7 @@ void Texture::initialize(const char *name, const Image &image, int flags, bgfx::
 
 	// Create with data: immutable. Create without data: mutable, update whenever.
 	handle_ = bgfx::createTexture2D(width_, height_, nMips_ > 1, 1, format_, calculateBgfxFlags(), (flags_ & TextureFlags::Mutable) ? nullptr : mem);
+	calculateMemorySize();
 
 #ifdef _DEBUG
 	bgfx::setName(handle_, name_);
@@ -62,6 +63,7 @@ void Texture::initialize(const char *name, bgfx::TextureHandle handle)
 	strcpy(name_, name);
 	handle_ = handle;
 	flags_ = 0;
+	memorySize_ = 0;
 }
 
 void Texture::resize(int width, int height)
@@ -73,6 +75,7 @@ void Texture::resize(int width, int height)
 	width_ = width;
 	height_ = height;
 	handle_ = bgfx::createTexture2D(width_, height_, nMips_ > 1, 1, format_, calculateBgfxFlags());
+	calculateMemorySize();
 
 #ifdef _DEBUG
 	bgfx::setName(handle_, name_);
@@ -84,6 +87,13 @@ void Texture::update(const bgfx::Memory *mem, int x, int y, int width, int heigh
 	bgfx::updateTexture2D(handle_, 0, 0, x, y, width, height, mem);
 }
 
+void Texture::calculateMemorySize()
+{
+	bgfx::TextureInfo info;
+	bgfx::calcTextureSize(info, (uint16_t)width_, (uint16_t)height_, 1, false, nMips_ > 1, 1, format_);
+	memorySize_ = info.storageSize;
+}
+
 uint32_t Texture::calculateBgfxFlags() const
 {
 	uint32_t bgfxFlags = BGFX_TEXTURE_NONE;
@@ -103,6 +113,9 @@ uint32_t Texture::calculateBgfxFlags() const
 
 TextureCache::TextureCache() : hashTable_()
 {
+	picmip_ = g_cvars.picmip.getInt();
+	streamImages_ = g_cvars.textureStreaming.getBool();
+
 	// Default texture (black box with white border).
 	memset(defaultImageData_, 32, defaultImageDataSize_);
 
@@ -150,9 +163,24 @@ TextureCache::TextureCache() : hashTable_()
 
 TextureCache::~TextureCache()
 {
+	stopImageLoadThreads();
+
+	// Discard any images that were never uploaded. Unless they're being reloaded, their textures are still using the default texture handle.
+	for (size_t i = nextImageUpload_; i < pendingImageLoads_.size(); i++)
+	{
+		PendingImageLoad *load = pendingImageLoads_[i].get();
+
+		if (load->image.data && load->image.release)
+			load->image.release(load->image.data, nullptr);
+
+		if (!load->reload)
+			load->texture->handle_ = BGFX_INVALID_HANDLE;
+	}
+
 	for (size_t i = 0; i < nTextures_; i++)
 	{
-		bgfx::destroy(textures_[i].handle_);
+		if (bgfx::isValid(textures_[i].handle_))
+			bgfx::destroy(textures_[i].handle_);
 	}
 }
 
@@ -194,6 +222,37 @@ Texture *TextureCache::create(const char *name, bgfx::TextureHandle handle)
 	return texture;
 }
 
+static int CalculateImageFlags(int textureFlags)
+{
+	int imageFlags = 0;
+
+	if (textureFlags & (TextureFlags::Mipmap | TextureFlags::Picmip))
+	{
+		imageFlags |= CreateImageFlags::GenerateMipmaps;
+
+		if (!util::Stricmp(g_cvars.mipmapFilter.getString(), "gamma"))
+		{
+			imageFlags |= CreateImageFlags::GammaCorrectMipmaps;
+		}
+		else if (!util::Stricmp(g_cvars.mipmapFilter.getString(), "stb"))
+		{
+			imageFlags |= CreateImageFlags::ResampleMipmaps;
+		}
+
+		if (textureFlags & TextureFlags::AlphaTest)
+		{
+			imageFlags |= CreateImageFlags::PreserveAlphaCoverage;
+		}
+	}
+
+	if (textureFlags & TextureFlags::Picmip)
+	{
+		imageFlags |= CreateImageFlags::Picmip;
+	}
+
+	return imageFlags;
+}
+
 Texture *TextureCache::find(const char *name, int flags)
 {
 	if (!name)
@@ -220,24 +279,22 @@ Texture *TextureCache::find(const char *name, int flags)
 	}
 
 	// Load it from a file.
-	int imageFlags = 0;
-
-	if (flags & (TextureFlags::Mipmap | TextureFlags::Picmip))
-	{
-		imageFlags |= CreateImageFlags::GenerateMipmaps;
-	}
+	const int imageFlags = CalculateImageFlags(flags);
 
-	if (flags & TextureFlags::Picmip)
-	{
-		imageFlags |= CreateImageFlags::Picmip;
-	}
+	// Decoding and mipmapping is slow, so do it on the image load threads while registering.
+	// Images without mipmaps (e.g. UI and the loading screen) are loaded immediately so they don't flash the default texture.
+	// When streaming, images registered after registration (e.g. HUD and cgame effects) are loaded on the image load threads too, so they don't stall the frame.
+	if (g_cvars.imageLoadThreads.getInt() != 0 && ((registering_ && (imageFlags & CreateImageFlags::GenerateMipmaps)) || (!registering_ && streamImages_)))
+		return createPending(name, flags, imageFlags);
 
 	Image image = LoadImage(name, imageFlags);
 
 	if (!image.data)
 		return nullptr;
 
-	return create(name, image, flags, bgfx::TextureFormat::RGBA8);
+	Texture *texture = create(name, image, flags, bgfx::TextureFormat::RGBA8);
+	texture->reloadable_ = true;
+	return texture;
 }
 
 Texture *TextureCache::get(const char *name)
@@ -272,6 +329,329 @@ void TextureCache::alias(Texture *from, Texture *to)
 	}
 }
 
+void TextureCache::uploadLoadedImages(bool wait)
+{
+	std::unique_lock<std::mutex> lock(imageLoadMutex_);
+
+	if (wait)
+	{
+		imageLoadFinished_.wait(lock, [this]() { return nLoadedImages_ == pendingImageLoads_.size(); });
+	}
+
+	// Don't stall the frame uploading a lot of streamed images at once. Always upload at least one image so big images can't get stuck.
+	const uint32_t uploadBudget = wait ? 0 : uint32_t(std::max(0, g_cvars.textureUploadBudget.getInt())) * 1024;
+	uint32_t uploadedBytes = 0;
+
+	// Upload in request order, stopping at the first image that hasn't finished loading.
+	while (nextImageUpload_ < pendingImageLoads_.size() && pendingImageLoads_[nextImageUpload_]->loaded)
+	{
+		if (uploadBudget > 0 && uploadedBytes > 0 && uploadedBytes + pendingImageLoads_[nextImageUpload_]->image.dataSize > uploadBudget)
+			break;
+
+		PendingImageLoad *load = pendingImageLoads_[nextImageUpload_].get();
+		nextImageUpload_++;
+		lock.unlock();
+		Texture *texture = load->texture;
+		texture->loading_ = false;
+
+		if (load->error)
+		{
+			interface::Printf("Error loading image \"%s\". Reason: \"%s\"\n", load->file.filename, load->error);
+		}
+
+		// Swap the default texture handle for the real one. Materials only read the handle when drawing, so this upgrades the texture in place.
+		if (load->image.data)
+		{
+			uploadedBytes += load->image.dataSize;
+
+			if (load->reload)
+				bgfx::destroy(texture->handle_);
+
+			uploadImage(texture, load->image, load->nDroppedMips);
+		}
+		else if (!load->reload)
+		{
+			// The file exists, so the texture has already been handed out. Give it its own copy of the default image.
+			char name[MAX_QPATH];
+			util::Strncpyz(name, texture->name_, sizeof(name));
+			texture->initialize(name, CreateImage(defaultImageSize_, defaultImageSize_, 4, defaultImageData_), texture->flags_, bgfx::TextureFormat::RGBA8);
+		}
+
+		pendingMemoryChange_ -= load->memoryChange;
+		WriteImageCacheFile(&load->file);
+
+		lock.lock();
+	}
+
+	// Start again from the beginning when everything has been uploaded, so streaming doesn't grow the queue forever.
+	if (nextImageUpload_ == pendingImageLoads_.size() && nextImageLoad_ == pendingImageLoads_.size())
+	{
+		pendingImageLoads_.clear();
+		nextImageLoad_ = nextImageUpload_ = nLoadedImages_ = 0;
+	}
+}
+
+void TextureCache::endRegistration()
+{
+	if (!registering_)
+		return;
+
+	registering_ = false;
+	uploadLoadedImages(true);
+
+	// Keep the image load threads around to stream images registered during gameplay.
+	if (!streamImages_)
+	{
+		stopImageLoadThreads();
+	}
+}
+
+Texture *TextureCache::createPending(const char *name, int flags, int imageFlags)
+{
+	auto load = std::make_unique<PendingImageLoad>();
+
+	// The engine file system isn't thread safe, so read the file here.
+	if (!ReadImageFile(name, imageFlags, &load->file))
+		return nullptr;
+
+	// Use the default texture handle until the image is uploaded. Materials only read the handle when drawing.
+	Texture *texture = create(name, defaultTexture_->handle_);
+	texture->flags_ = flags;
+	texture->width_ = defaultTexture_->width_;
+	texture->height_ = defaultTexture_->height_;
+	texture->nMips_ = defaultTexture_->nMips_;
+	texture->format_ = defaultTexture_->format_;
+	texture->reloadable_ = true;
+	load->texture = texture;
+	load->imageFlags = imageFlags;
+	queueImageLoad(std::move(load));
+	return texture;
+}
+
+void TextureCache::queueImageLoad(std::unique_ptr<PendingImageLoad> load)
+{
+	load->texture->loading_ = true;
+	pendingMemoryChange_ += load->memoryChange;
+	const int nThreads = g_cvars.imageLoadThreads.getInt();
+
+	if (nThreads == 0)
+	{
+		// No image load threads. Load it now, it will be uploaded with the others.
+		load->error = DecodeImageFile(&load->file, load->imageFlags, picmip_, &load->image);
+		load->file.data = std::vector<uint8_t>();
+		load->loaded = true;
+		pendingImageLoads_.push_back(std::move(load));
+		nextImageLoad_++;
+		nLoadedImages_++;
+		return;
+	}
+
+	if (imageLoadThreads_.empty())
+	{
+		stopImageLoadThreads_ = false;
+
+		for (int i = 0; i < (nThreads < 0 ? std::max(1, (int)std::thread::hardware_concurrency() - 1) : nThreads); i++)
+			imageLoadThreads_.push_back(std::thread(&TextureCache::imageLoadThread, this));
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(imageLoadMutex_);
+		pendingImageLoads_.push_back(std::move(load));
+	}
+
+	imageLoadQueued_.notify_one();
+}
+
+void TextureCache::uploadImage(Texture *texture, const Image &image, int nDroppedMips)
+{
+	char name[MAX_QPATH];
+	util::Strncpyz(name, texture->name_, sizeof(name));
+	nDroppedMips = std::min(nDroppedMips, image.nMips - 1);
+
+	if (nDroppedMips <= 0)
+	{
+		texture->initialize(name, image, texture->flags_, bgfx::TextureFormat::RGBA8);
+		texture->nDroppedMips_ = 0;
+		return;
+	}
+
+	// Skip the top mip levels.
+	int width = image.width, height = image.height;
+	uint32_t offset = 0;
+
+	for (int i = 0; i < nDroppedMips; i++)
+	{
+		offset += uint32_t(width * height * image.nComponents);
+		width = std::max(1, width >> 1);
+		height = std::max(1, height >> 1);
+	}
+
+	Image mips;
+	mips.width = width;
+	mips.height = height;
+	mips.nComponents = image.nComponents;
+	mips.nMips = image.nMips - nDroppedMips;
+	mips.dataSize = image.dataSize - offset;
+	mips.data = (uint8_t *)bgfx::copy(&image.data[offset], mips.dataSize);
+	mips.flags = ImageFlags::DataIsBgfxMemory;
+	texture->initialize(name, mips, texture->flags_, bgfx::TextureFormat::RGBA8);
+	texture->nDroppedMips_ = nDroppedMips;
+
+	if (image.release)
+		image.release(image.data, nullptr);
+}
+
+bool TextureCache::reloadTexture(Texture *texture, int nDroppedMips)
+{
+	const int imageFlags = CalculateImageFlags(texture->flags_);
+	auto load = std::make_unique<PendingImageLoad>();
+
+	if (!ReadImageFile(texture->name_, imageFlags, &load->file))
+		return false;
+
+	// Each mip level is a quarter the size of the one above it.
+	const int64_t size = texture->memorySize_;
+	load->memoryChange = nDroppedMips > texture->nDroppedMips_ ? -(size - (size >> (2 * (nDroppedMips - texture->nDroppedMips_)))) : (size << (2 * (texture->nDroppedMips_ - nDroppedMips))) - size;
+	load->texture = texture;
+	load->imageFlags = imageFlags;
+	load->nDroppedMips = nDroppedMips;
+	load->reload = true;
+	queueImageLoad(std::move(load));
+	return true;
+}
+
+void TextureCache::updateResidency(uint32_t frameNo)
+{
+	const int64_t budget = int64_t(std::max(0, g_cvars.textureMemoryBudget.getInt())) * 1024 * 1024;
+	int64_t memory = pendingMemoryChange_;
+
+	for (size_t i = 0; i < nTextures_; i++)
+		memory += textures_[i].memorySize_;
+
+	// Only mipmapped textures loaded from files can drop mips, and can't be changed while they're already loading.
+	auto canChange = [](const Texture &texture) { return texture.reloadable_ && !texture.loading_ && texture.memorySize_ > 0 && texture.nMips_ > 1; };
+
+	if (budget > 0 && memory > budget)
+	{
+		// Over budget: drop the top mip of the least recently used textures that weren't used last frame. Don't go below 32x32.
+		for (int i = 0; i < maxResidencyChangesPerFrame_ && memory > budget; i++)
+		{
+			Texture *lru = nullptr;
+
+			for (size_t j = 0; j < nTextures_; j++)
+			{
+				Texture &t = textures_[j];
+
+				if (!canChange(t) || t.lastUsedFrame_ + 1 >= frameNo || t.width_ <= 32 || t.height_ <= 32)
+					continue;
+
+				if (!lru || t.lastUsedFrame_ < lru->lastUsedFrame_ || (t.lastUsedFrame_ == lru->lastUsedFrame_ && t.memorySize_ > lru->memorySize_))
+					lru = &t;
+			}
+
+			if (!lru || !reloadTexture(lru, lru->nDroppedMips_ + 1))
+				break;
+
+			memory = memory - lru->memorySize_ + (lru->memorySize_ >> 2);
+			nMipsDropped_++;
+		}
+	}
+	else
+	{
+		// Under budget: restore the top mip of the most recently used texture, if it still fits with some room to spare so textures don't thrash.
+		Texture *mru = nullptr;
+
+		for (size_t j = 0; j < nTextures_; j++)
+		{
+			Texture &t = textures_[j];
+
+			if (!canChange(t) || t.nDroppedMips_ == 0 || t.lastUsedFrame_ + 1 < frameNo)
+				continue;
+
+			if (budget > 0 && memory + int64_t(t.memorySize_) * 3 > budget - budget / 10)
+				continue;
+
+			if (!mru || t.memorySize_ > mru->memorySize_)
+				mru = &t;
+		}
+
+		if (mru && reloadTexture(mru, mru->nDroppedMips_ - 1))
+			nMipsRestored_++;
+	}
+}
+
+void TextureCache::printResidency() const
+{
+	const uint32_t frameNo = main::GetFrameNo();
+	int64_t memory = 0;
+	int nDropped = 0;
+
+	for (size_t i = 0; i < nTextures_; i++)
+	{
+		const Texture &t = textures_[i];
+		memory += t.memorySize_;
+
+		if (t.nDroppedMips_ > 0)
+		{
+			interface::Printf("%6uKB %4dx%-4d -%d mips, last used %u frames ago: %s\n", t.memorySize_ / 1024, t.width_, t.height_, t.nDroppedMips_, frameNo - t.lastUsedFrame_, t.name_);
+			nDropped++;
+		}
+	}
+
+	interface::Printf("%d textures, %.2fMB\n", (int)nTextures_, memory / (1024.0f * 1024.0f));
+	interface::Printf("%d textures with dropped mips, %u mips dropped, %u mips restored\n", nDropped, nMipsDropped_, nMipsRestored_);
+
+	if (g_cvars.textureMemoryBudget.getInt() > 0)
+		interface::Printf("Budget: %dMB\n", g_cvars.textureMemoryBudget.getInt());
+	else
+		interface::Printf("Budget: unlimited\n");
+}
+
+void TextureCache::imageLoadThread()
+{
+	for (;;)
+	{
+		PendingImageLoad *load;
+
+		{
+			std::unique_lock<std::mutex> lock(imageLoadMutex_);
+			imageLoadQueued_.wait(lock, [this]() { return stopImageLoadThreads_ || nextImageLoad_ < pendingImageLoads_.size(); });
+
+			if (stopImageLoadThreads_)
+				return;
+
+			load = pendingImageLoads_[nextImageLoad_].get();
+			nextImageLoad_++;
+		}
+
+		load->error = DecodeImageFile(&load->file, load->imageFlags, picmip_, &load->image);
+		load->file.data = std::vector<uint8_t>(); // Free the file contents now instead of waiting for the upload.
+
+		{
+			std::lock_guard<std::mutex> lock(imageLoadMutex_);
+			load->loaded = true;
+			nLoadedImages_++;
+		}
+
+		imageLoadFinished_.notify_all();
+	}
+}
+
+void TextureCache::stopImageLoadThreads()
+{
+	{
+		std::lock_guard<std::mutex> lock(imageLoadMutex_);
+		stopImageLoadThreads_ = true;
+	}
+
+	imageLoadQueued_.notify_all();
+
+	for (std::thread &thread : imageLoadThreads_)
+		thread.join();
+
+	imageLoadThreads_.clear();
+}
+
 void TextureCache::hashTexture(Texture *texture)
 {
 	size_t hash = generateHash(texture->name_);
@@ -301,6 +301,71 @@ static void ReleaseLightmapAtlasImage(void *data, void *userData)
 	free(data);
 }
 
+/// Upload the light grid as 3D textures, so entities can be lit per pixel instead of sampling the grid once on the CPU.
+static void CreateLightGridTextures()
+{
+	if (!HasLightGrid() || !(bgfx::getCaps()->supported & BGFX_CAPS_TEXTURE_3D))
+		return;
+
+	const vec3i &bounds = s_world->lightGridBounds;
+
+	for (size_t i = 0; i < 3; i++)
+	{
+		if (bounds[i] > (int)bgfx::getCaps()->limits.maxTextureSize)
+		{
+			interface::PrintWarningf("Light grid too large for a 3D texture\n");
+			return;
+		}
+	}
+
+	const uint32_t nGridPoints = uint32_t(bounds.x * bounds.y * bounds.z);
+	const bgfx::Memory *mem[LightGridTexture::Num];
+
+	for (int i = 0; i < LightGridTexture::Num; i++)
+		mem[i] = bgfx::alloc(nGridPoints * 4);
+
+	for (uint32_t i = 0; i < nGridPoints; i++)
+	{
+		const uint8_t *data = &s_world->lightGridData[i * 8];
+		uint8_t *ambient = &mem[LightGridTexture::Ambient]->data[i * 4];
+		uint8_t *directed = &mem[LightGridTexture::Directed]->data[i * 4];
+		uint8_t *direction = &mem[LightGridTexture::Direction]->data[i * 4];
+
+		// Samples in walls have alpha 0, so the shader can ignore them the same way SampleLightGrid does.
+		const bool inWall = !(data[0] + data[1] + data[2] + data[3] + data[4] + data[5]);
+		ambient[0] = data[0];
+		ambient[1] = data[1];
+		ambient[2] = data[2];
+		ambient[3] = inWall ? 0 : 255;
+		directed[0] = data[3];
+		directed[1] = data[4];
+		directed[2] = data[5];
+		directed[3] = 255;
+
+		// Same decoding as SampleLightGrid. Wall samples have a zero direction.
+		vec3 normal;
+
+		if (!inWall)
+		{
+			const int lat = data[7] * (g_funcTableSize / 256);
+			const int lng = data[6] * (g_funcTableSize / 256);
+			normal[0] = g_sinTable[(lat + (g_funcTableSize / 4)) & g_funcTableMask] * g_sinTable[lng];
+			normal[1] = g_sinTable[lat] * g_sinTable[lng];
+			normal[2] = g_sinTable[(lng + (g_funcTableSize / 4)) & g_funcTableMask];
+		}
+
+		for (size_t j = 0; j < 3; j++)
+			direction[j] = uint8_t(math::Clamped((normal[j] * 0.5f + 0.5f) * 255.0f + 0.5f, 0.0f, 255.0f));
+
+		direction[3] = 255;
+	}
+
+	for (int i = 0; i < LightGridTexture::Num; i++)
+	{
+		s_world->lightGridTextures[i] = bgfx::createTexture3D(uint16_t(bounds.x), uint16_t(bounds.y), uint16_t(bounds.z), false, bgfx::TextureFormat::RGBA8, BGFX_SAMPLER_U_CLAMP | BGFX_SAMPLER_V_CLAMP | BGFX_SAMPLER_W_CLAMP, mem[i]);
+	}
+}
+
 static void CreateBatchedSurfaces(const std::vector<Surface *> &surfaces, std::vector<BatchedSurface> *batchedSurfaces, std::vector<uint16_t> *batchedIndices, std::vector<Vertex> *cpuDeformVertices, std::vector<uint16_t> *cpuDeformIndices)
 {
 	assert(batchedSurfaces);
@@ -789,6 +854,8 @@ void Load(const char *name)
 			util::OverbrightenColor(&s_world->lightGridData[i*8], &s_world->lightGridData[i*8]);
 			util::OverbrightenColor(&s_world->lightGridData[i*8+3], &s_world->lightGridData[i*8+3]);
 		}
+
+		CreateLightGridTextures();
 	}
 
 	// Materials
@@ -1210,6 +1277,17 @@ bool HasLightGrid()
 	return !s_world->lightGridData.empty();
 }
 
+bool HasLightGridTextures()
+{
+	return bgfx::isValid(s_world->lightGridTextures[0]);
+}
+
+bgfx::TextureHandle GetLightGridTexture(int index)
+{
+	assert(index >= 0 && index < LightGridTexture::Num);
+	return s_world->lightGridTextures[index];
+}
+
 void SampleLightGrid(vec3 position, vec3 *ambientLight, vec3 *directedLight, vec3 *lightDir)
 {
 	assert(ambientLight);
@@ -1307,6 +1385,17 @@ void SampleLightGrid(vec3 position, vec3 *ambientLight, vec3 *directedLight, vec
 	lightDir->normalizeFast();
 }
 
+void UpdateLightGridUniforms(Uniforms *uniforms)
+{
+	assert(uniforms);
+	assert(HasLightGridTextures());
+	uniforms->lightGridOrigin_Enabled.set(vec4(s_world->lightGridOrigin, 1));
+
+	// Bonus items and view weapons have a fixed minimum add. See SetupEntityLighting.
+	uniforms->lightGridInverseSize_MinAmbient.set(vec4(s_world->lightGridInverseSize, g_identityLight * 32 / 255.0f));
+	uniforms->lightGridBounds.set(vec4((float)s_world->lightGridBounds.x, (float)s_world->lightGridBounds.y, (float)s_world->lightGridBounds.z, 0));
+}
+
 Node *LeafFromPosition(vec3 pos)
 {
 	Node *node = &s_world->nodes[0];
@@ -2147,6 +2236,9 @@ void Render(VisibilityId visId, DrawCallList *drawCallList, const mat3 &sceneRot
 		dc.fogIndex = surface.fogIndex;
 		dc.material = surface.material;
 
+		// Skip the dynamic light shader variant for batches no light touches.
+		dc.dynamicLighting = !(surface.surfaceFlags & SURF_SKY) && main::TouchesDynamicLight(surface.bounds);
+
 		if (main::AreWaterReflectionsEnabled())
 		{
 			// If this is a back side reflective material, use the front side material if there's any reflective surfaces visible to the camera.
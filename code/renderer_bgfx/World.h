@@ -446,6 +446,10 @@ struct World
 	std::vector<uint8_t> lightGridData;
 	vec3 lightGridOrigin;
 	vec3i lightGridBounds;
+
+	/// The light grid uploaded for per pixel lighting. Indexed by LightGridTexture.
+	bgfx::TextureHandle lightGridTextures[LightGridTexture::Num] = { BGFX_INVALID_HANDLE, BGFX_INVALID_HANDLE, BGFX_INVALID_HANDLE };
+
 	std::vector<MaterialDef> materials;
 	std::vector<ModelDef> modelDefs;
 	std::vector<Plane> planes;
@@ -485,6 +489,15 @@ struct World
 	std::vector<uint16_t> cpuDeformIndices;
 	IndexBuffer indexBuffers[s_maxWorldGeometryBuffers];
 	std::vector<SkySurface> skySurfaces;
+
+	~World()
+	{
+		for (bgfx::TextureHandle handle : lightGridTextures)
+		{
+			if (bgfx::isValid(handle))
+				bgfx::destroy(handle);
+		}
+	}
 };
 
 extern std::unique_ptr<World> s_world;
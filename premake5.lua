@@ -155,6 +155,12 @@ newaction
 			renderers = { "gl", "vk" }
 		end
 		
+		local compositeFragmentVariants =
+		{
+			{ "Bloom", "USE_BLOOM" },
+			{ "ToneMap", "USE_TONE_MAP" }
+		}
+		
 		local depthFragmentVariants =
 		{
 			{ "AlphaTest", "USE_ALPHA_TEST" }
@@ -179,11 +185,23 @@ newaction
 			{ "SunLight", "USE_SUN_LIGHT" }
 		}
 		
+		-- Material shapes are only specialized for the common variants. Other variants use the generic shader.
+		local genericShapeFragmentVariants =
+		{
+			{ "Bloom", "USE_BLOOM" },
+			{ "DynamicLights", "USE_DYNAMIC_LIGHTS" }
+		}
+		
 		local genericVertexVariants =
 		{
 			{ "SunLight", "USE_SUN_LIGHT" }
 		}
 		
+		local smaaNeighborhoodBlendingFragmentVariants =
+		{
+			{ "Bloom", "USE_BLOOM" }
+		}
+		
 		local textureVariationFragmentVariants =
 		{
 			{ "Bloom", "USE_BLOOM" },
@@ -192,15 +210,20 @@ newaction
 		
 		local fragmentShaders =
 		{
-			{ "Bloom" },
+			{ "BloomDownsample" },
+			{ "BloomUpsample" },
 			{ "Color" },
+			{ "Composite", compositeFragmentVariants },
+			{ "DeferredLight" },
 			{ "Depth", depthFragmentVariants },
 			{ "Fog", fogFragmentVariants },
-			{ "GaussianBlur" },
+			{ "GBuffer" },
 			{ "Generic", genericFragmentVariants },
+			{ "Luminance" },
+			{ "Sharpen" },
 			{ "SMAABlendingWeightCalculation" },
 			{ "SMAAEdgeDetection" },
-			{ "SMAANeighborhoodBlending" },
+			{ "SMAANeighborhoodBlending", smaaNeighborhoodBlendingFragmentVariants },
 			{ "Texture" },
 			{ "TextureColor" },
 			{ "TextureDebug" },
@@ -219,6 +242,23 @@ newaction
 			{ "Texture" }
 		}
 		
+		-- Read the material shapes, one per line: name light layers layer0Blend layer1Blend
+		local materialShapes = {}
+		local materialShapesFilename = _OPTIONS["material-shapes"] or path.join(BASE_PATH, "shaders/MaterialShapes.txt")
+		
+		for line in io.lines(materialShapesFilename) do
+			local name, light, layers, blend0, blend1 = line:match("^(%w+)%s+(%d+)%s+(%d+)%s+(%d+)%s+(%d+)")
+			
+			if name ~= nil then
+				table.insert(materialShapes, { name = name, light = tonumber(light), layers = tonumber(layers), blend0 = tonumber(blend0), blend1 = tonumber(blend1) })
+			end
+		end
+		
+		if #materialShapes == 0 then
+			print("No material shapes in " .. materialShapesFilename)
+			return
+		end
+		
 		-- Make sure the build directory exists
 		os.mkdir(path.join(BASE_PATH, "build"))
 		
@@ -237,6 +277,27 @@ newaction
 		-- Expand shader lists so each variant has a single entry.
 		local expandedFragmentShaders = expandShaderVariants(fragmentShaders)
 		local expandedVertexShaders = expandShaderVariants(vertexShaders)
+		
+		-- Material shape shaders go straight after the generic shader variants, in the same order as the shape list.
+		local shapeIndex = 1
+		
+		while not (expandedFragmentShaders[shapeIndex][1] == "Generic" and (shapeIndex == #expandedFragmentShaders or expandedFragmentShaders[shapeIndex + 1][1] ~= "Generic")) do
+			shapeIndex = shapeIndex + 1
+		end
+		
+		for _,shape in ipairs(materialShapes) do
+			local shapeDefines = string.format("USE_MATERIAL_SHAPE;MATERIAL_SHAPE_LIGHT=%d;MATERIAL_SHAPE_LAYERS=%d;MATERIAL_SHAPE_LAYER0_BLEND=%d;MATERIAL_SHAPE_LAYER1_BLEND=%d", shape.light, shape.layers, shape.blend0, shape.blend1)
+			
+			for _,v in ipairs(expandShaderVariants({ { "Generic", genericShapeFragmentVariants } })) do
+				shapeIndex = shapeIndex + 1
+				
+				if v[2] == nil then
+					table.insert(expandedFragmentShaders, shapeIndex, { "Generic", "Shape" .. shape.name, shapeDefines })
+				else
+					table.insert(expandedFragmentShaders, shapeIndex, { "Generic", "Shape" .. shape.name .. v[2], shapeDefines .. ";" .. v[3] })
+				end
+			end
+		end
 
 		-- Compile the shaders.
 		local ok, message = pcall(function()
@@ -275,8 +336,7 @@ newaction
 			of:write("\t};\n")
 			of:write("};\n\n")
 			
-			of:write("#ifdef _DEBUG\n")
-			of:write("static const char *" .. stringsVarName .. "[] =\n")
+			of:write("static const char * const " .. stringsVarName .. "[] =\n")
 			of:write("{\n")
 			
 			for _,v in pairs(data) do
@@ -289,8 +349,7 @@ newaction
 				of:write("\",\n")
 			end
 			
-			of:write("};\n")
-			of:write("#endif\n\n")
+			of:write("};\n\n")
 		end
 		
 		function writeShaderVariantEnum(of, data, name)
@@ -318,6 +377,31 @@ newaction
 		writeShaderVariantEnum(outputHeaderFile, depthVertexVariants, "DepthVertex")
 		writeShaderVariantEnum(outputHeaderFile, fogFragmentVariants, "FogFragment")
 		writeShaderVariantEnum(outputHeaderFile, textureVariationFragmentVariants, "TextureVariationFragment")
+		writeShaderVariantEnum(outputHeaderFile, genericShapeFragmentVariants, "GenericShapeFragment")
+		
+		-- Material shape IDs and the keys MaterialStage::getShapeKey returns for them.
+		outputHeaderFile:write("struct MaterialShapeId\n")
+		outputHeaderFile:write("{\n")
+		outputHeaderFile:write("\tenum Enum\n")
+		outputHeaderFile:write("\t{\n")
+		for _,shape in ipairs(materialShapes) do
+			outputHeaderFile:write("\t\t" .. shape.name .. ",\n")
+		end
+		outputHeaderFile:write("\t\tNum\n")
+		outputHeaderFile:write("\t};\n")
+		outputHeaderFile:write("};\n\n")
+		outputHeaderFile:write("static const uint32_t s_materialShapeKeys[] =\n")
+		outputHeaderFile:write("{\n")
+		for _,shape in ipairs(materialShapes) do
+			outputHeaderFile:write(string.format("\t0x%04x,\n", shape.light + shape.layers * 0x10 + shape.blend0 * 0x100 + shape.blend1 * 0x1000))
+		end
+		outputHeaderFile:write("};\n\n")
+		outputHeaderFile:write("static const char * const s_materialShapeNames[] =\n")
+		outputHeaderFile:write("{\n")
+		for _,shape in ipairs(materialShapes) do
+			outputHeaderFile:write("\t\"" .. shape.name .. "\",\n")
+		end
+		outputHeaderFile:write("};\n\n")
 		outputHeaderFile:close()
 
 		-- Generate functions to map shader ID enums to source strings, appending them to the output source file.
@@ -375,6 +459,13 @@ newoption
 	}
 }
 
+newoption
+{
+	trigger = "material-shapes",
+	value = "FILE",
+	description = "Material shape list for the shaders action (default shaders/MaterialShapes.txt)"
+}
+
 newoption
 {
 	trigger = "engine",
@@ -0,0 +1,24 @@
+$input v_texcoord0
+
+#include <bgfx_shader.sh>
+
+SAMPLER2D(s_Texture, 0);
+
+uniform vec4 u_BloomTapOffset; // only xy used
+uniform vec4 u_TexCoordClamp; // xy is the minimum, zw is the maximum
+
+vec4 SampleClamped(vec2 texcoord)
+{
+	return texture2D(s_Texture, clamp(texcoord, u_TexCoordClamp.xy, u_TexCoordClamp.zw));
+}
+
+void main()
+{
+	// Dual filter downsample. Each bilinear tap lands between 2x2 source texels, so the four taps cover 4x4 source texels.
+	vec2 offset = u_BloomTapOffset.xy;
+	vec4 color = SampleClamped(v_texcoord0 + vec2(-offset.x, -offset.y));
+	color += SampleClamped(v_texcoord0 + vec2( offset.x, -offset.y));
+	color += SampleClamped(v_texcoord0 + vec2(-offset.x,  offset.y));
+	color += SampleClamped(v_texcoord0 + vec2( offset.x,  offset.y));
+	gl_FragColor = color * 0.25;
+}
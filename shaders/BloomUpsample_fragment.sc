@@ -0,0 +1,28 @@
+$input v_texcoord0
+
+#include <bgfx_shader.sh>
+
+SAMPLER2D(s_Texture, 0);
+
+uniform vec4 u_BloomTapOffset; // only xy used
+uniform vec4 u_TexCoordClamp; // xy is the minimum, zw is the maximum
+
+vec4 SampleClamped(vec2 texcoord)
+{
+	return texture2D(s_Texture, clamp(texcoord, u_TexCoordClamp.xy, u_TexCoordClamp.zw));
+}
+
+void main()
+{
+	// Dual filter upsample. A tent of four edge taps and four diagonal taps weighted double.
+	vec2 offset = u_BloomTapOffset.xy;
+	vec4 color = SampleClamped(v_texcoord0 + vec2(-offset.x * 2.0, 0.0));
+	color += SampleClamped(v_texcoord0 + vec2( offset.x * 2.0, 0.0));
+	color += SampleClamped(v_texcoord0 + vec2(0.0, -offset.y * 2.0));
+	color += SampleClamped(v_texcoord0 + vec2(0.0,  offset.y * 2.0));
+	color += SampleClamped(v_texcoord0 + vec2(-offset.x, -offset.y)) * 2.0;
+	color += SampleClamped(v_texcoord0 + vec2( offset.x, -offset.y)) * 2.0;
+	color += SampleClamped(v_texcoord0 + vec2(-offset.x,  offset.y)) * 2.0;
+	color += SampleClamped(v_texcoord0 + vec2( offset.x,  offset.y)) * 2.0;
+	gl_FragColor = color / 12.0;
+}
@@ -0,0 +1,40 @@
+uniform vec4 u_Exposure_Key_BloomScale; // y is 0 if auto exposure is disabled, w not used
+#define u_Exposure u_Exposure_Key_BloomScale.x
+#define u_Key u_Exposure_Key_BloomScale.y
+#define u_BloomScale u_Exposure_Key_BloomScale.z
+
+#if defined(USE_BLOOM)
+uniform vec4 u_BloomTexCoordClamp; // xy is the minimum, zw is the maximum. Bloom is smaller than the scene, so its scaled rect doesn't line up exactly.
+#endif
+
+#if defined(USE_TONE_MAP)
+// ACES filmic curve, fitted by Krzysztof Narkowicz.
+vec3 ToneMapFilmic(vec3 x)
+{
+	return saturate((x * (2.51 * x + 0.03)) / (x * (2.43 * x + 0.59) + 0.14));
+}
+#endif
+
+// Add bloom and tone map the scene color. Effects that are disabled are compiled out.
+vec3 Composite(vec3 color, vec2 texcoord)
+{
+#if defined(USE_BLOOM)
+	color += texture2D(s_Bloom, clamp(texcoord, u_BloomTexCoordClamp.xy, u_BloomTexCoordClamp.zw)).rgb * u_BloomScale;
+#endif
+
+#if defined(USE_TONE_MAP)
+	// The scene is gamma encoded like the LDR path, but values above 1 haven't been clipped.
+	float exposure = u_Exposure;
+
+	if (u_Key > 0.0)
+	{
+		// Scale the average scene luminance to the key value, within limits so dark and bright areas still look dark and bright.
+		float luminance = texture2D(s_Luminance, vec2_splat(0.5)).r;
+		exposure *= clamp(u_Key / max(luminance, 0.0001), 0.25, 4.0);
+	}
+
+	color = ToGamma(ToneMapFilmic(ToLinear(color) * exposure));
+#endif
+
+	return color;
+}
@@ -0,0 +1,24 @@
+$input v_texcoord0
+
+#include <bgfx_shader.sh>
+#include "Common.sh"
+
+SAMPLER2D(s_Texture, 0);
+
+#if defined(USE_BLOOM)
+SAMPLER2D(s_Bloom, 1);
+#endif
+
+#if defined(USE_TONE_MAP)
+SAMPLER2D(s_Luminance, 2);
+#endif
+
+uniform vec4 u_TexCoordClamp; // xy is the minimum, zw is the maximum
+
+#include "Composite.sh"
+
+void main()
+{
+	// Clamped, since this pass can upscale the scene rect straight to the backbuffer with dynamic resolution.
+	gl_FragColor = vec4(Composite(texture2D(s_Texture, clamp(v_texcoord0, u_TexCoordClamp.xy, u_TexCoordClamp.zw)).rgb, v_texcoord0), 1.0);
+}
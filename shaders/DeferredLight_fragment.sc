@@ -0,0 +1,43 @@
+$input v_texcoord0
+
+#include <bgfx_shader.sh>
+#include "Common.sh"
+#include "SharedDefines.sh"
+
+#define USE_DYNAMIC_LIGHTS
+#include "DynamicLight.sh"
+
+SAMPLER2D(s_Depth, 3); // TU_DEPTH
+SAMPLER2D(s_GBufferAlbedo, 14); // TU_GBUFFER_ALBEDO
+SAMPLER2D(s_GBufferNormal, 15); // TU_GBUFFER_NORMAL
+
+uniform mat4 u_DeferredInvViewProj;
+
+void main()
+{
+	vec4 albedo = texture2D(s_GBufferAlbedo, v_texcoord0);
+
+	// Nothing opaque was written here, e.g. sky.
+	if (albedo.a == 0.0)
+		discard;
+
+	// Reconstruct the world space position from depth.
+	float depth = texture2D(s_Depth, v_texcoord0).r;
+	vec2 ndc = v_texcoord0 * 2.0 - 1.0;
+
+	// GL uses -1 to 1 NDC and a bottom left origin. D3D uses 0 to 1 and a top left origin.
+#if BGFX_SHADER_LANGUAGE_GLSL
+	depth = depth * 2.0 - 1.0;
+#else
+	ndc.y = -ndc.y;
+#endif
+
+	vec4 position = mul(u_DeferredInvViewProj, vec4(ndc, depth, 1.0));
+	position.xyz /= position.w;
+	vec3 normal = normalize(texture2D(s_GBufferNormal, v_texcoord0).xyz * 2.0 - 1.0);
+	vec3 light = CalculateDynamicLight(position.xyz, normal);
+
+	// Blended additively over the scene color, like the original Quake 3 dynamic light pass. Nothing is added to the bloom attachment.
+	gl_FragData[0] = vec4(ToGamma(ToLinear(albedo.rgb) * light), 0.0);
+	gl_FragData[1] = vec4_splat(0.0);
+}
@@ -4,6 +4,10 @@ USAMPLER2D(s_DynamicLightIndices, 5); // TU_DYNAMIC_LIGHT_INDICES
 SAMPLER2D(s_DynamicLights, 6); // TU_DYNAMIC_LIGHTS
 
 uniform vec4 u_DynamicLightCellSize; // xyz is size
+uniform vec4 u_DynamicLightClusterForward_Offset; // w is the first cluster cell, 0 if clusters are disabled
+uniform vec4 u_DynamicLightClusterLeft_SliceScale; // xyz is scaled by 1 / tan(fovX / 2)
+uniform vec4 u_DynamicLightClusterOrigin_Near;
+uniform vec4 u_DynamicLightClusterUp; // xyz is scaled by 1 / tan(fovY / 2), w not used
 uniform vec4 u_DynamicLightGridOffset; // w not used
 uniform vec4 u_DynamicLightGridSize; // w not used
 uniform vec4 u_DynamicLight_Num_Intensity; // x is the number of dynamic lights, y is the intensity scale
@@ -32,13 +36,36 @@ DynamicLight GetDynamicLight(uint index)
 	return dl;
 }
 
+uint GetDynamicLightClusterOffset(vec3 position)
+{
+	// Screen tile from the projected position, depth slice from the exponential view depth.
+	vec3 dir = position - u_DynamicLightClusterOrigin_Near.xyz;
+	float z = dot(dir, u_DynamicLightClusterForward_Offset.xyz);
+	vec2 ndc = vec2(dot(dir, u_DynamicLightClusterLeft_SliceScale.xyz), dot(dir, u_DynamicLightClusterUp.xyz)) / max(z, 1.0);
+	uint tileX = uint(clamp((ndc.x * 0.5 + 0.5) * float(DLIGHT_CLUSTER_TILES_X), 0.0, float(DLIGHT_CLUSTER_TILES_X - 1)));
+	uint tileY = uint(clamp((ndc.y * 0.5 + 0.5) * float(DLIGHT_CLUSTER_TILES_Y), 0.0, float(DLIGHT_CLUSTER_TILES_Y - 1)));
+	float nearZ = u_DynamicLightClusterOrigin_Near.w;
+	uint slice = uint(clamp(log(max(z, nearZ) / nearZ) * u_DynamicLightClusterLeft_SliceScale.w, 0.0, float(DLIGHT_CLUSTER_SLICES - 1)));
+	return uint(u_DynamicLightClusterForward_Offset.w) + tileX + tileY * uint(DLIGHT_CLUSTER_TILES_X) + slice * uint(DLIGHT_CLUSTER_TILES_X * DLIGHT_CLUSTER_TILES_Y);
+}
+
 uint GetDynamicLightIndicesOffset(vec3 position)
 {
-	vec3 local = u_DynamicLightGridOffset.xyz + position;
-	uint cellX = min(uint(max(0, local.x / u_DynamicLightCellSize.x)), uint(u_DynamicLightGridSize.x) - 1u);
-	uint cellY = min(uint(max(0, local.y / u_DynamicLightCellSize.y)), uint(u_DynamicLightGridSize.y) - 1u);
-	uint cellZ = min(uint(max(0, local.z / u_DynamicLightCellSize.z)), uint(u_DynamicLightGridSize.z) - 1u);
-	uint cellOffset = cellX + (cellY * uint(u_DynamicLightGridSize.x)) + (cellZ * uint(u_DynamicLightGridSize.x) * uint(u_DynamicLightGridSize.y));
+	uint cellOffset;
+
+	if (u_DynamicLightClusterForward_Offset.w > 0.0)
+	{
+		cellOffset = GetDynamicLightClusterOffset(position);
+	}
+	else
+	{
+		vec3 local = u_DynamicLightGridOffset.xyz + position;
+		uint cellX = min(uint(max(0, local.x / u_DynamicLightCellSize.x)), uint(u_DynamicLightGridSize.x) - 1u);
+		uint cellY = min(uint(max(0, local.y / u_DynamicLightCellSize.y)), uint(u_DynamicLightGridSize.y) - 1u);
+		uint cellZ = min(uint(max(0, local.z / u_DynamicLightCellSize.z)), uint(u_DynamicLightGridSize.z) - 1u);
+		cellOffset = cellX + (cellY * uint(u_DynamicLightGridSize.x)) + (cellZ * uint(u_DynamicLightGridSize.x) * uint(u_DynamicLightGridSize.y));
+	}
+
 	int u = int(cellOffset) % int(u_DynamicLightTextureSizes_Cells_Indices_Lights.x);
 	int v = int(cellOffset) / int(u_DynamicLightTextureSizes_Cells_Indices_Lights.x);
 	return texelFetch(s_DynamicLightCells, ivec2(u, v), 0).r;
@@ -0,0 +1,40 @@
+$input v_position, v_projPosition, v_shadowPosition, v_texcoord0, v_texcoord1, v_texcoord2, v_texcoord3, v_normal, v_color0
+
+#include <bgfx_shader.sh>
+#include "Common.sh"
+#include "SharedDefines.sh"
+
+// u_AlphaTest is 0 for stages without alpha testing, which always passes.
+#define USE_ALPHA_TEST
+#include "AlphaTest.sh"
+#include "PortalClip.sh"
+
+SAMPLER2D(s_Diffuse, 0); // TU_DIFFUSE
+
+uniform vec4 u_Generators;
+#define u_ColorGen int(u_Generators[GEN_COLOR])
+
+uniform vec4 u_LightType; // only x used
+
+void main()
+{
+	if (PortalClipped(v_position))
+		discard;
+
+	vec4 diffuse = texture2D(s_Diffuse, v_texcoord0);
+
+	if (!AlphaTestPassed(diffuse.a * v_color0.a))
+		discard;
+
+	// Vertex colors are treated as diffuse light when there's no other light, same as the forward dynamic light path.
+	vec3 albedo = diffuse.rgb;
+
+	if (!(int(u_LightType.x) == LIGHT_NONE && (u_ColorGen == CGEN_EXACT_VERTEX || u_ColorGen == CGEN_VERTEX)))
+	{
+		albedo = ToGamma(ToLinear(diffuse.rgb) * v_color0.rgb);
+	}
+
+	// Alpha marks pixels written by an opaque surface. The clear color leaves it 0 everywhere else.
+	gl_FragData[0] = vec4(albedo, 1.0);
+	gl_FragData[1] = vec4(normalize(v_normal.xyz) * 0.5 + 0.5, 1.0);
+}
@@ -1,16 +1,19 @@
-$input v_position, v_projPosition, v_shadowPosition, v_texcoord0, v_texcoord1, v_normal, v_color0
+$input v_position, v_projPosition, v_shadowPosition, v_texcoord0, v_texcoord1, v_texcoord2, v_texcoord3, v_normal, v_color0
 
 #include <bgfx_shader.sh>
 #include "Common.sh"
 #include "SharedDefines.sh"
 #include "AlphaTest.sh"
 #include "DynamicLight.sh"
+#include "LightGrid.sh"
 #include "PortalClip.sh"
 #include "SunLight.sh"
 
 SAMPLER2D(s_Diffuse, 0); // TU_DIFFUSE
 SAMPLER2D(s_Diffuse2, 1); // TU_DIFFUSE2
 SAMPLER2D(s_Light, 2); // TU_LIGHT
+SAMPLER2D(s_Layer0, 9); // TU_LAYER0
+SAMPLER2D(s_Layer1, 10); // TU_LAYER1
 
 #if defined(USE_SOFT_SPRITE)
 SAMPLER2D(s_Depth, 3); // TU_DEPTH
@@ -23,7 +26,10 @@ uniform vec4 u_Bloom_Write_Scale;
 #define u_BloomWrite int(u_Bloom_Write_Scale.x)
 
 uniform vec4 u_Animation_Enabled_Fraction; // only x and y used
+uniform vec4 u_FogEnabled; // only y used
+uniform vec4 u_FogColor;
 uniform vec4 u_RenderMode; // only x used
+uniform vec4 u_SceneScale; // only xy used
 uniform vec4 u_ViewOrigin;
 
 uniform vec4 u_Generators;
@@ -38,6 +44,48 @@ uniform vec4 u_AmbientLight;
 
 uniform vec4 u_LightType; // only x used
 
+// A material shape replaces uniform branches with constants. See MaterialShapes.txt.
+#if defined(USE_MATERIAL_SHAPE)
+#define SHAPE_LIGHT_TYPE MATERIAL_SHAPE_LIGHT
+#define SHAPE_NUM_LAYERS MATERIAL_SHAPE_LAYERS
+#define SHAPE_LAYER0_BLEND MATERIAL_SHAPE_LAYER0_BLEND
+#define SHAPE_LAYER1_BLEND MATERIAL_SHAPE_LAYER1_BLEND
+#else
+#define SHAPE_LIGHT_TYPE int(u_LightType.x)
+#define SHAPE_NUM_LAYERS int(u_Layers_Num_TCGen.x)
+#define SHAPE_LAYER0_BLEND int(u_LayerBlend.x)
+#define SHAPE_LAYER1_BLEND int(u_LayerBlend.y)
+#endif
+
+// Later stages blended in the shader instead of the framebuffer.
+uniform vec4 u_Layers_Num_TCGen; // only x used
+uniform vec4 u_LayerBlend; // LAYER_BLEND_* of each layer
+uniform vec4 u_LayerColor[MAX_STAGE_LAYERS];
+uniform vec4 u_LayerFogColorMask[MAX_STAGE_LAYERS];
+
+// Do what the framebuffer blend would have done if the layer was drawn as a separate pass.
+vec4 BlendLayer(vec4 dest, vec4 texel, vec4 color, vec4 fogColorMask, int blend, float fog)
+{
+	color *= vec4_splat(1.0) - fogColorMask * fog;
+	vec4 src = vec4(ToGamma(ToLinear(texel.rgb) * color.rgb), texel.a * color.a);
+	vec4 result;
+
+	if (blend == LAYER_BLEND_ADD)
+	{
+		result = dest + src;
+	}
+	else if (blend == LAYER_BLEND_MODULATE)
+	{
+		result = dest * src;
+	}
+	else
+	{
+		result = vec4(mix(dest.rgb, src.rgb, src.a), src.a * src.a + dest.a * (1.0 - src.a));
+	}
+
+	return saturate(result);
+}
+
 void main()
 {
 	if (PortalClipped(v_position))
@@ -45,36 +93,39 @@ void main()
 
 	vec2 texCoord0 = v_texcoord0;
 
+	// Material shapes never have fragment texture coordinates, lerped texture animation or water alpha.
+#if !defined(USE_MATERIAL_SHAPE)
 	if (u_TexCoordGen == TCGEN_FRAGMENT)
 	{
-		texCoord0 = gl_FragCoord.xy * u_viewTexel.xy;
+		texCoord0 = gl_FragCoord.xy * u_viewTexel.xy * u_SceneScale.xy;
 	}
+#endif
 
 	vec4 diffuse = texture2D(s_Diffuse, texCoord0);
 
+#if !defined(USE_MATERIAL_SHAPE)
 	if (int(u_Animation_Enabled_Fraction.x) != 0)
 	{
 		vec4 diffuse2 = texture2D(s_Diffuse2, texCoord0);
 		diffuse = mix(diffuse, diffuse2, u_Animation_Enabled_Fraction.y);
 	}
+#endif
 
 	diffuse.rgb = ToLinear(diffuse.rgb);
-	float alpha;
+	float alpha = diffuse.a * v_color0.a;
 
+#if !defined(USE_MATERIAL_SHAPE)
 	if (u_AlphaGen == AGEN_WATER)
 	{
 		const float minReflectivity = 0.1;
 		vec3 viewDir = normalize(u_ViewOrigin.xyz - v_position);
 		alpha = minReflectivity + (1.0 - minReflectivity) * pow(1.0 - dot(v_normal.xyz, viewDir), 5);
 	}
-	else
-	{
-		alpha = diffuse.a * v_color0.a;
-	}
+#endif
 
 #if defined(USE_SOFT_SPRITE)
 	// Normalized linear depths.
-	float sceneDepth = ToLinearDepth(texture2D(s_Depth, gl_FragCoord.xy * u_viewTexel.xy).r, u_DepthRange.z, u_DepthRange.w);
+	float sceneDepth = ToLinearDepth(texture2D(s_Depth, gl_FragCoord.xy * u_viewTexel.xy * u_SceneScale.xy).r, u_DepthRange.z, u_DepthRange.w);
 
 	// GL uses -1 to 1 NDC. D3D uses 0 to 1.
 #if BGFX_SHADER_LANGUAGE_GLSL
@@ -107,7 +158,7 @@ void main()
 
 	vec3 vertexColor = v_color0.rgb;
 	vec3 diffuseLight = vec3_splat(1.0);
-	int lightType = int(u_LightType.x);
+	int lightType = SHAPE_LIGHT_TYPE;
 
 	if (lightType == LIGHT_MAP)
 	{
@@ -115,7 +166,14 @@ void main()
 	}
 	else if (lightType == LIGHT_VECTOR)
 	{
-		diffuseLight = u_AmbientLight.xyz + u_DirectedLight.xyz * Lambert(v_normal.xyz, u_LightDirection.xyz);
+		if (u_LightGridOrigin_Enabled.w > 0.0)
+		{
+			diffuseLight = CalculateLightGrid(v_position, v_normal.xyz);
+		}
+		else
+		{
+			diffuseLight = u_AmbientLight.xyz + u_DirectedLight.xyz * Lambert(v_normal.xyz, u_LightDirection.xyz);
+		}
 	}
 
 #if defined(USE_DYNAMIC_LIGHTS)
@@ -134,7 +192,30 @@ void main()
 #endif
 
 	vec4 fragColor = vec4(ToGamma(diffuse.rgb * vertexColor * diffuseLight), alpha);
+	int numLayers = SHAPE_NUM_LAYERS;
+
+	if (numLayers > 0)
+	{
+		fragColor = BlendLayer(saturate(fragColor), texture2D(s_Layer0, v_texcoord2.xy), u_LayerColor[0], u_LayerFogColorMask[0], SHAPE_LAYER0_BLEND, v_texcoord3.x);
+	}
 
+	if (numLayers > 1)
+	{
+		fragColor = BlendLayer(fragColor, texture2D(s_Layer1, v_texcoord2.zw), u_LayerColor[1], u_LayerFogColorMask[1], SHAPE_LAYER1_BLEND, v_texcoord3.x);
+	}
+
+	// Blend the fog color like the fog pass would have.
+	vec4 unfoggedColor = fragColor;
+	float fog = 0.0;
+
+	if (int(u_FogEnabled.y) != 0)
+	{
+		fog = sqrt(saturate(v_texcoord3.y));
+		fragColor.rgb = mix(fragColor.rgb, u_FogColor.rgb, fog);
+	}
+
+	// Material shapes aren't used with debug render modes.
+#if !defined(USE_MATERIAL_SHAPE)
 	int renderMode = int(u_RenderMode.x);
 
 	if (renderMode == RENDER_MODE_LIT && lightType != LIGHT_MAP)
@@ -145,13 +226,14 @@ void main()
 	{
 		fragColor = vec4(texture2D(s_Light, v_texcoord1).rgb, alpha);
 	}
+#endif
 
 #if defined(USE_BLOOM)
 	gl_FragData[0] = fragColor;
 
 	if (u_BloomWrite != 0)
 	{
-		gl_FragData[1] = fragColor;
+		gl_FragData[1] = vec4(unfoggedColor.rgb * (1.0 - fog), fragColor.a);
 	}
 	else
 	{
@@ -1,5 +1,5 @@
 $input a_position, a_normal, a_tangent, a_texcoord0, a_color0
-$output v_position, v_projPosition, v_shadowPosition, v_texcoord0, v_texcoord1, v_normal, v_color0
+$output v_position, v_projPosition, v_shadowPosition, v_texcoord0, v_texcoord1, v_texcoord2, v_texcoord3, v_normal, v_color0
 
 /*
 ===========================================================================
@@ -53,31 +53,37 @@ uniform vec4 u_TCGen0Vector1;
 uniform vec4 u_DiffuseTexMatrix;
 uniform vec4 u_DiffuseTexOffTurb;
 
+// Later stages blended in the fragment shader.
+uniform vec4 u_Layers_Num_TCGen; // x is the number of layers, y and z are the tcgen of each layer
+uniform vec4 u_LayerTexMatrix[MAX_STAGE_LAYERS];
+uniform vec4 u_LayerTexOffTurb[MAX_STAGE_LAYERS];
+
 // colorgen and alphagen
 uniform vec4 u_PortalRange;
 
-uniform vec4 u_FogEnabled; // only x used
+uniform vec4 u_FogEnabled; // only x and y used
+uniform vec4 u_FogColor;
 uniform vec4 u_FogColorMask;
 uniform vec4 u_FogDepth;
 uniform vec4 u_FogDistance;
 uniform vec4 u_FogEyeT; // only x used
 
-vec2 GenTexCoords(vec3 position, vec3 normal, vec2 texCoord1, vec2 texCoord2)
+vec2 GenTexCoords(int tcGen, vec3 position, vec3 normal, vec2 texCoord1, vec2 texCoord2)
 {
 	vec2 tex = texCoord1;
 
-	if (u_TCGen0 == TCGEN_LIGHTMAP)
+	if (tcGen == TCGEN_LIGHTMAP)
 	{
 		tex = texCoord2;
 	}
-	else if (u_TCGen0 == TCGEN_ENVIRONMENT_MAPPED)
+	else if (tcGen == TCGEN_ENVIRONMENT_MAPPED)
 	{
 		vec3 viewer = normalize(u_LocalViewOrigin.xyz - position);
 		vec2 ref = reflect(viewer, normal).yz;
 		tex.x = ref.x * -0.5 + 0.5;
 		tex.y = ref.y *  0.5 + 0.5;
 	}
-	else if (u_TCGen0 == TCGEN_VECTOR)
+	else if (tcGen == TCGEN_VECTOR)
 	{
 		tex = vec2(dot(position, u_TCGen0Vector0.xyz), dot(position, u_TCGen0Vector1.xyz));
 	}
@@ -119,7 +125,7 @@ void main()
 
 	if (u_TCGen0 != TCGEN_NONE)
 	{
-		vec2 tex = GenTexCoords(position, normal, a_texcoord0.xy, a_texcoord0.zw);
+		vec2 tex = GenTexCoords(u_TCGen0, position, normal, a_texcoord0.xy, a_texcoord0.zw);
 		v_texcoord0 = ModTexCoords(tex, position, u_DiffuseTexMatrix, u_DiffuseTexOffTurb);
 	}
 	else
@@ -127,6 +133,21 @@ void main()
 		v_texcoord0 = a_texcoord0.xy;
 	}
 
+	int numLayers = int(u_Layers_Num_TCGen.x);
+	v_texcoord2 = vec4_splat(0.0);
+
+	if (numLayers > 0)
+	{
+		vec2 tex = GenTexCoords(int(u_Layers_Num_TCGen.y), position, normal, a_texcoord0.xy, a_texcoord0.zw);
+		v_texcoord2.xy = ModTexCoords(tex, position, u_LayerTexMatrix[0], u_LayerTexOffTurb[0]);
+	}
+
+	if (numLayers > 1)
+	{
+		vec2 tex = GenTexCoords(int(u_Layers_Num_TCGen.z), position, normal, a_texcoord0.xy, a_texcoord0.zw);
+		v_texcoord2.zw = ModTexCoords(tex, position, u_LayerTexMatrix[1], u_LayerTexOffTurb[1]);
+	}
+
 	if ((u_ColorGen != CGEN_IDENTITY || u_AlphaGen != AGEN_IDENTITY) && int(u_LightType.x) == LIGHT_NONE)
 	{
 		v_color0 = CalcColor(u_VertColor, u_BaseColor, a_color0, position, normal);
@@ -136,11 +157,25 @@ void main()
 		v_color0 = u_VertColor * a_color0 + u_BaseColor;
 	}
 
+	// Layers apply their own fog color mask in the fragment shader.
+	float fog = 0.0;
+
 	if (int(u_FogEnabled.x) != 0)
 	{
-		v_color0 *= vec4_splat(1.0) - u_FogColorMask * sqrt(saturate(CalcFog(position, u_FogDepth, u_FogDistance, u_FogEyeT.x)));
+		fog = sqrt(saturate(CalcFog(position, u_FogDepth, u_FogDistance, u_FogEyeT.x)));
+		v_color0 *= vec4_splat(1.0) - u_FogColorMask * fog;
 	}
 
+	// The fog pass blend factor, if the fragment shader applies it instead of a separate pass.
+	float fogPass = 0.0;
+
+	if (int(u_FogEnabled.y) != 0)
+	{
+		fogPass = CalcFog(position, u_FogDepth, u_FogDistance, u_FogEyeT.x) * u_FogColor.a * u_FogColor.a;
+	}
+
+	v_texcoord3 = vec4(fog, fogPass, 0.0, 0.0);
+
 	vec3 wsPosition = mul(u_model[0], vec4(position, 1.0)).xyz;
 	v_texcoord1 = a_texcoord0.zw;
 	v_position = wsPosition;
@@ -0,0 +1,30 @@
+SAMPLER3D(s_LightGridAmbient, 11); // TU_LIGHT_GRID_AMBIENT
+SAMPLER3D(s_LightGridDirected, 12); // TU_LIGHT_GRID_DIRECTED
+SAMPLER3D(s_LightGridDirection, 13); // TU_LIGHT_GRID_DIRECTION
+
+uniform vec4 u_LightGridOrigin_Enabled; // w is 1 if the light grid textures are bound
+uniform vec4 u_LightGridInverseSize_MinAmbient; // w is the minimum ambient light, in gamma space
+uniform vec4 u_LightGridBounds; // w not used
+
+// Entities divide light that would take them past full brightness, keeping the hue.
+vec3 ClampEntityLight(vec3 light)
+{
+	return light / max(1.0, max(light.r, max(light.g, light.b)));
+}
+
+// Per pixel version of world::SampleLightGrid.
+vec3 CalculateLightGrid(vec3 position, vec3 normal)
+{
+	// Grid points are at texel centers.
+	vec3 uvw = ((position - u_LightGridOrigin_Enabled.xyz) * u_LightGridInverseSize_MinAmbient.xyz + 0.5) / u_LightGridBounds.xyz;
+	vec4 ambient = texture3D(s_LightGridAmbient, uvw);
+	vec3 directed = texture3D(s_LightGridDirected, uvw).rgb;
+	vec3 dir = texture3D(s_LightGridDirection, uvw).xyz * 2.0 - 1.0;
+
+	// Alpha is 0 for samples in walls. Dividing by the filtered alpha ignores them.
+	float totalFactor = max(ambient.a, 1.0 / 255.0);
+	vec3 ambientLight = ClampEntityLight(ambient.rgb / totalFactor + u_LightGridInverseSize_MinAmbient.w);
+	vec3 directedLight = ClampEntityLight(directed / totalFactor);
+	dir = dot(dir, dir) > 0.0001 ? normalize(dir) : vec3(0.0, 0.0, 1.0);
+	return ToLinear(ambientLight) + ToLinear(directedLight) * Lambert(normal, dir);
+}
@@ -0,0 +1,51 @@
+$input v_texcoord0
+
+#include <bgfx_shader.sh>
+#include "Common.sh"
+#include "SharedDefines.sh"
+
+SAMPLER2D(s_Texture, 0);
+SAMPLER2D(s_Luminance, 1); // the previous frame's adapted luminance
+
+uniform vec4 u_LuminanceTapOffset_Pass; // xy is the tap offset in texture coordinates, z is LUMINANCE_PASS_*, w is the adaptation fraction
+
+float LogLuminance(vec3 color)
+{
+	return log2(max(dot(ToLinear(color), vec3(0.2126, 0.7152, 0.0722)), 0.0001));
+}
+
+void main()
+{
+	// Four bilinear taps, which cover 4x4 texels when downsampling by 4.
+	vec2 offset = u_LuminanceTapOffset_Pass.xy;
+	vec3 s0 = texture2D(s_Texture, v_texcoord0 + vec2(-offset.x, -offset.y)).rgb;
+	vec3 s1 = texture2D(s_Texture, v_texcoord0 + vec2( offset.x, -offset.y)).rgb;
+	vec3 s2 = texture2D(s_Texture, v_texcoord0 + vec2(-offset.x,  offset.y)).rgb;
+	vec3 s3 = texture2D(s_Texture, v_texcoord0 + vec2( offset.x,  offset.y)).rgb;
+	int pass = int(u_LuminanceTapOffset_Pass.z);
+	float result;
+
+	// Average log luminance, so the final pass gives the geometric mean.
+	if (pass == LUMINANCE_PASS_SCENE)
+	{
+		result = (LogLuminance(s0) + LogLuminance(s1) + LogLuminance(s2) + LogLuminance(s3)) * 0.25;
+	}
+	else
+	{
+		result = (s0.r + s1.r + s2.r + s3.r) * 0.25;
+
+		// Blended with the previous frame's luminance by the adaptation fraction. A fraction of 1 resets, ignoring the previous frame.
+		if (pass == LUMINANCE_PASS_ADAPT)
+		{
+			result = exp2(result);
+			float adaptation = u_LuminanceTapOffset_Pass.w;
+
+			if (adaptation < 1.0)
+			{
+				result = mix(texture2D(s_Luminance, vec2(0.5, 0.5)).r, result, adaptation);
+			}
+		}
+	}
+
+	gl_FragColor = vec4(result, 0.0, 0.0, 1.0);
+}
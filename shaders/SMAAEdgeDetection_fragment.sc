@@ -8,11 +8,14 @@ $input v_texcoord0, v_texcoord2, v_texcoord3, v_texcoord4
 
 SAMPLER2D(s_SmaaColor, 0);
 
+uniform vec4 u_TexCoordClamp; // xy is the minimum, zw is the maximum
+
 void main()
 {
+	// offset[1] holds the right and bottom neighbors, which are outside the scaled rect on its edges.
 	vec4 offset[3];
 	offset[0] = v_texcoord2;
-	offset[1] = v_texcoord3;
+	offset[1] = clamp(v_texcoord3, u_TexCoordClamp.xyxy, u_TexCoordClamp.zwzw);
 	offset[2] = v_texcoord4;
 #if BGFX_SHADER_LANGUAGE_GLSL
 	vec2 rg = SMAALumaEdgeDetectionPS(v_texcoord0, offset, s_SmaaColor);
@@ -1,6 +1,7 @@
 $input v_texcoord0, v_texcoord2
 
 #include <bgfx_shader.sh>
+#include "Common.sh"
 
 #define SMAA_INCLUDE_VS 0
 #define SMAA_INCLUDE_PS 1
@@ -9,11 +10,18 @@ $input v_texcoord0, v_texcoord2
 SAMPLER2D(s_SmaaColor, 0);
 SAMPLER2D(s_SmaaBlend, 1);
 
+#if defined(USE_BLOOM)
+SAMPLER2D(s_Bloom, 2);
+#endif
+
+#include "Composite.sh"
+
 void main()
 {
 #if BGFX_SHADER_LANGUAGE_GLSL
-	gl_FragColor = SMAANeighborhoodBlendingPS(v_texcoord0, v_texcoord2, s_SmaaColor, s_SmaaBlend);
+	vec4 color = SMAANeighborhoodBlendingPS(v_texcoord0, v_texcoord2, s_SmaaColor, s_SmaaBlend);
 #else
-	gl_FragColor = SMAANeighborhoodBlendingPS(v_texcoord0, v_texcoord2, s_SmaaColor.m_texture, s_SmaaBlend.m_texture);
+	vec4 color = SMAANeighborhoodBlendingPS(v_texcoord0, v_texcoord2, s_SmaaColor.m_texture, s_SmaaBlend.m_texture);
 #endif
+	gl_FragColor = vec4(Composite(color.rgb, v_texcoord0), color.a);
 }
@@ -27,16 +27,29 @@
 #define DLIGHT_CAPSULE 0
 #define DLIGHT_POINT   1
 
+#define DLIGHT_CLUSTER_SLICES  24
+#define DLIGHT_CLUSTER_TILES_X 16
+#define DLIGHT_CLUSTER_TILES_Y 8
+
+#define LAYER_BLEND_ADD      1
+#define LAYER_BLEND_MODULATE 2
+#define LAYER_BLEND_LERP     3
+
 #define LIGHT_NONE   0
 #define LIGHT_MAP    1
 #define LIGHT_VERTEX 3
 #define LIGHT_VECTOR 4
 
+#define LUMINANCE_PASS_SCENE      0
+#define LUMINANCE_PASS_DOWNSAMPLE 1
+#define LUMINANCE_PASS_ADAPT      2
+
 #define GEN_ALPHA    0
 #define GEN_COLOR    1
 #define GEN_TEXCOORD 2
 
 #define MAX_DEFORMS 3
+#define MAX_STAGE_LAYERS 2
 
 #define RENDER_MODE_NONE     0
 #define RENDER_MODE_LIT      1
@@ -67,5 +80,12 @@
 #define TU_DYNAMIC_LIGHTS        6
 #define TU_SHADOWMAP             7
 #define TU_NOISE                 8
+#define TU_LAYER0                9
+#define TU_LAYER1                10
+#define TU_LIGHT_GRID_AMBIENT    11
+#define TU_LIGHT_GRID_DIRECTED   12
+#define TU_LIGHT_GRID_DIRECTION  13
+#define TU_GBUFFER_ALBEDO        14
+#define TU_GBUFFER_NORMAL        15
 
 #define USE_HALF_LAMBERT
\ No newline at end of file
@@ -0,0 +1,37 @@
+$input v_texcoord0
+
+#include <bgfx_shader.sh>
+
+SAMPLER2D(s_Texture, 0);
+
+uniform vec4 u_SharpenTexelSize_Amount; // xy is the source texel size, z is the sharpening amount, w not used
+uniform vec4 u_TexCoordClamp; // xy is the minimum, zw is the maximum
+
+vec3 SampleClamped(vec2 texcoord)
+{
+	return texture2D(s_Texture, clamp(texcoord, u_TexCoordClamp.xy, u_TexCoordClamp.zw)).rgb;
+}
+
+void main()
+{
+	// Bilinear upscale, sharpened by the difference from the four neighboring source texels. The neighbors aren't sampled if sharpening is disabled.
+	vec3 center = SampleClamped(v_texcoord0);
+	vec3 color = center;
+
+	if (u_SharpenTexelSize_Amount.z > 0.0)
+	{
+		vec2 texelSize = u_SharpenTexelSize_Amount.xy;
+		vec3 left = SampleClamped(v_texcoord0 - vec2(texelSize.x, 0.0));
+		vec3 right = SampleClamped(v_texcoord0 + vec2(texelSize.x, 0.0));
+		vec3 up = SampleClamped(v_texcoord0 - vec2(0.0, texelSize.y));
+		vec3 down = SampleClamped(v_texcoord0 + vec2(0.0, texelSize.y));
+		vec3 sharpened = center + (center - (left + right + up + down) * 0.25) * u_SharpenTexelSize_Amount.z;
+
+		// Clamped to the neighborhood, so high contrast edges don't ring.
+		vec3 minColor = min(center, min(min(left, right), min(up, down)));
+		vec3 maxColor = max(center, max(max(left, right), max(up, down)));
+		color = clamp(sharpened, minColor, maxColor);
+	}
+
+	gl_FragColor = vec4(color, 1.0);
+}
@@ -15,6 +15,7 @@ uniform vec4 u_Bloom_Write_Scale;
 #define u_BloomWrite int(u_Bloom_Write_Scale.x)
 
 uniform vec4 u_RenderMode; // only x used
+uniform vec4 u_SceneScale; // only xy used
 
 uniform vec4 u_Generators;
 #define u_TexCoordGen int(u_Generators[GEN_TEXCOORD])
@@ -71,7 +72,7 @@ void main()
 
 	if (u_TexCoordGen == TCGEN_FRAGMENT)
 	{
-		texCoord0 = gl_FragCoord.xy * u_viewTexel.xy;
+		texCoord0 = gl_FragCoord.xy * u_viewTexel.xy * u_SceneScale.xy;
 	}
 
 	vec4 diffuse = textureNoTile_4weights(texCoord0);
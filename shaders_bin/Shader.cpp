@@ -1,9 +1,14 @@
-#include "Bloom_fragment.h"
+#include "BloomDownsample_fragment.h"
+#include "BloomUpsample_fragment.h"
 #include "Color_fragment.h"
+#include "Composite_fragment.h"
+#include "DeferredLight_fragment.h"
 #include "Depth_fragment.h"
 #include "Fog_fragment.h"
-#include "GaussianBlur_fragment.h"
+#include "GBuffer_fragment.h"
 #include "Generic_fragment.h"
+#include "Luminance_fragment.h"
+#include "Sharpen_fragment.h"
 #include "SMAABlendingWeightCalculation_fragment.h"
 #include "SMAAEdgeDetection_fragment.h"
 #include "SMAANeighborhoodBlending_fragment.h"
@@ -25,10 +30,22 @@ struct ShaderSourceMem { const uint8_t *mem; size_t size; };
 static std::array<ShaderSourceMem, FragmentShaderId::Num> GetFragmentShaderSourceMap_gl()
 {
 	std::array<ShaderSourceMem, FragmentShaderId::Num> mem;
-	mem[FragmentShaderId::Bloom].mem = Bloom_fragment_gl;
-	mem[FragmentShaderId::Bloom].size = sizeof(Bloom_fragment_gl);
+	mem[FragmentShaderId::BloomDownsample].mem = BloomDownsample_fragment_gl;
+	mem[FragmentShaderId::BloomDownsample].size = sizeof(BloomDownsample_fragment_gl);
+	mem[FragmentShaderId::BloomUpsample].mem = BloomUpsample_fragment_gl;
+	mem[FragmentShaderId::BloomUpsample].size = sizeof(BloomUpsample_fragment_gl);
 	mem[FragmentShaderId::Color].mem = Color_fragment_gl;
 	mem[FragmentShaderId::Color].size = sizeof(Color_fragment_gl);
+	mem[FragmentShaderId::Composite].mem = Composite_fragment_gl;
+	mem[FragmentShaderId::Composite].size = sizeof(Composite_fragment_gl);
+	mem[FragmentShaderId::Composite_Bloom].mem = Composite_Bloom_fragment_gl;
+	mem[FragmentShaderId::Composite_Bloom].size = sizeof(Composite_Bloom_fragment_gl);
+	mem[FragmentShaderId::Composite_ToneMap].mem = Composite_ToneMap_fragment_gl;
+	mem[FragmentShaderId::Composite_ToneMap].size = sizeof(Composite_ToneMap_fragment_gl);
+	mem[FragmentShaderId::Composite_BloomToneMap].mem = Composite_BloomToneMap_fragment_gl;
+	mem[FragmentShaderId::Composite_BloomToneMap].size = sizeof(Composite_BloomToneMap_fragment_gl);
+	mem[FragmentShaderId::DeferredLight].mem = DeferredLight_fragment_gl;
+	mem[FragmentShaderId::DeferredLight].size = sizeof(DeferredLight_fragment_gl);
 	mem[FragmentShaderId::Depth].mem = Depth_fragment_gl;
 	mem[FragmentShaderId::Depth].size = sizeof(Depth_fragment_gl);
 	mem[FragmentShaderId::Depth_AlphaTest].mem = Depth_AlphaTest_fragment_gl;
@@ -37,8 +54,8 @@ static std::array<ShaderSourceMem, FragmentShaderId::Num> GetFragmentShaderSourc
 	mem[FragmentShaderId::Fog].size = sizeof(Fog_fragment_gl);
 	mem[FragmentShaderId::Fog_Bloom].mem = Fog_Bloom_fragment_gl;
 	mem[FragmentShaderId::Fog_Bloom].size = sizeof(Fog_Bloom_fragment_gl);
-	mem[FragmentShaderId::GaussianBlur].mem = GaussianBlur_fragment_gl;
-	mem[FragmentShaderId::GaussianBlur].size = sizeof(GaussianBlur_fragment_gl);
+	mem[FragmentShaderId::GBuffer].mem = GBuffer_fragment_gl;
+	mem[FragmentShaderId::GBuffer].size = sizeof(GBuffer_fragment_gl);
 	mem[FragmentShaderId::Generic].mem = Generic_fragment_gl;
 	mem[FragmentShaderId::Generic].size = sizeof(Generic_fragment_gl);
 	mem[FragmentShaderId::Generic_AlphaTest].mem = Generic_AlphaTest_fragment_gl;
@@ -103,12 +120,66 @@ static std::array<ShaderSourceMem, FragmentShaderId::Num> GetFragmentShaderSourc
 	mem[FragmentShaderId::Generic_BloomDynamicLightsSoftSpriteSunLight].size = sizeof(Generic_BloomDynamicLightsSoftSpriteSunLight_fragment_gl);
 	mem[FragmentShaderId::Generic_AlphaTestBloomDynamicLightsSoftSpriteSunLight].mem = Generic_AlphaTestBloomDynamicLightsSoftSpriteSunLight_fragment_gl;
 	mem[FragmentShaderId::Generic_AlphaTestBloomDynamicLightsSoftSpriteSunLight].size = sizeof(Generic_AlphaTestBloomDynamicLightsSoftSpriteSunLight_fragment_gl);
+	mem[FragmentShaderId::Generic_ShapeMap].mem = Generic_ShapeMap_fragment_gl;
+	mem[FragmentShaderId::Generic_ShapeMap].size = sizeof(Generic_ShapeMap_fragment_gl);
+	mem[FragmentShaderId::Generic_ShapeMapBloom].mem = Generic_ShapeMapBloom_fragment_gl;
+	mem[FragmentShaderId::Generic_ShapeMapBloom].size = sizeof(Generic_ShapeMapBloom_fragment_gl);
+	mem[FragmentShaderId::Generic_ShapeMapDynamicLights].mem = Generic_ShapeMapDynamicLights_fragment_gl;
+	mem[FragmentShaderId::Generic_ShapeMapDynamicLights].size = sizeof(Generic_ShapeMapDynamicLights_fragment_gl);
+	mem[FragmentShaderId::Generic_ShapeMapBloomDynamicLights].mem = Generic_ShapeMapBloomDynamicLights_fragment_gl;
+	mem[FragmentShaderId::Generic_ShapeMapBloomDynamicLights].size = sizeof(Generic_ShapeMapBloomDynamicLights_fragment_gl);
+	mem[FragmentShaderId::Generic_ShapeMapAdd].mem = Generic_ShapeMapAdd_fragment_gl;
+	mem[FragmentShaderId::Generic_ShapeMapAdd].size = sizeof(Generic_ShapeMapAdd_fragment_gl);
+	mem[FragmentShaderId::Generic_ShapeMapAddBloom].mem = Generic_ShapeMapAddBloom_fragment_gl;
+	mem[FragmentShaderId::Generic_ShapeMapAddBloom].size = sizeof(Generic_ShapeMapAddBloom_fragment_gl);
+	mem[FragmentShaderId::Generic_ShapeMapAddDynamicLights].mem = Generic_ShapeMapAddDynamicLights_fragment_gl;
+	mem[FragmentShaderId::Generic_ShapeMapAddDynamicLights].size = sizeof(Generic_ShapeMapAddDynamicLights_fragment_gl);
+	mem[FragmentShaderId::Generic_ShapeMapAddBloomDynamicLights].mem = Generic_ShapeMapAddBloomDynamicLights_fragment_gl;
+	mem[FragmentShaderId::Generic_ShapeMapAddBloomDynamicLights].size = sizeof(Generic_ShapeMapAddBloomDynamicLights_fragment_gl);
+	mem[FragmentShaderId::Generic_ShapeUnlit].mem = Generic_ShapeUnlit_fragment_gl;
+	mem[FragmentShaderId::Generic_ShapeUnlit].size = sizeof(Generic_ShapeUnlit_fragment_gl);
+	mem[FragmentShaderId::Generic_ShapeUnlitBloom].mem = Generic_ShapeUnlitBloom_fragment_gl;
+	mem[FragmentShaderId::Generic_ShapeUnlitBloom].size = sizeof(Generic_ShapeUnlitBloom_fragment_gl);
+	mem[FragmentShaderId::Generic_ShapeUnlitDynamicLights].mem = Generic_ShapeUnlitDynamicLights_fragment_gl;
+	mem[FragmentShaderId::Generic_ShapeUnlitDynamicLights].size = sizeof(Generic_ShapeUnlitDynamicLights_fragment_gl);
+	mem[FragmentShaderId::Generic_ShapeUnlitBloomDynamicLights].mem = Generic_ShapeUnlitBloomDynamicLights_fragment_gl;
+	mem[FragmentShaderId::Generic_ShapeUnlitBloomDynamicLights].size = sizeof(Generic_ShapeUnlitBloomDynamicLights_fragment_gl);
+	mem[FragmentShaderId::Generic_ShapeVector].mem = Generic_ShapeVector_fragment_gl;
+	mem[FragmentShaderId::Generic_ShapeVector].size = sizeof(Generic_ShapeVector_fragment_gl);
+	mem[FragmentShaderId::Generic_ShapeVectorBloom].mem = Generic_ShapeVectorBloom_fragment_gl;
+	mem[FragmentShaderId::Generic_ShapeVectorBloom].size = sizeof(Generic_ShapeVectorBloom_fragment_gl);
+	mem[FragmentShaderId::Generic_ShapeVectorDynamicLights].mem = Generic_ShapeVectorDynamicLights_fragment_gl;
+	mem[FragmentShaderId::Generic_ShapeVectorDynamicLights].size = sizeof(Generic_ShapeVectorDynamicLights_fragment_gl);
+	mem[FragmentShaderId::Generic_ShapeVectorBloomDynamicLights].mem = Generic_ShapeVectorBloomDynamicLights_fragment_gl;
+	mem[FragmentShaderId::Generic_ShapeVectorBloomDynamicLights].size = sizeof(Generic_ShapeVectorBloomDynamicLights_fragment_gl);
+	mem[FragmentShaderId::Generic_ShapeVectorAdd].mem = Generic_ShapeVectorAdd_fragment_gl;
+	mem[FragmentShaderId::Generic_ShapeVectorAdd].size = sizeof(Generic_ShapeVectorAdd_fragment_gl);
+	mem[FragmentShaderId::Generic_ShapeVectorAddBloom].mem = Generic_ShapeVectorAddBloom_fragment_gl;
+	mem[FragmentShaderId::Generic_ShapeVectorAddBloom].size = sizeof(Generic_ShapeVectorAddBloom_fragment_gl);
+	mem[FragmentShaderId::Generic_ShapeVectorAddDynamicLights].mem = Generic_ShapeVectorAddDynamicLights_fragment_gl;
+	mem[FragmentShaderId::Generic_ShapeVectorAddDynamicLights].size = sizeof(Generic_ShapeVectorAddDynamicLights_fragment_gl);
+	mem[FragmentShaderId::Generic_ShapeVectorAddBloomDynamicLights].mem = Generic_ShapeVectorAddBloomDynamicLights_fragment_gl;
+	mem[FragmentShaderId::Generic_ShapeVectorAddBloomDynamicLights].size = sizeof(Generic_ShapeVectorAddBloomDynamicLights_fragment_gl);
+	mem[FragmentShaderId::Generic_ShapeVertex].mem = Generic_ShapeVertex_fragment_gl;
+	mem[FragmentShaderId::Generic_ShapeVertex].size = sizeof(Generic_ShapeVertex_fragment_gl);
+	mem[FragmentShaderId::Generic_ShapeVertexBloom].mem = Generic_ShapeVertexBloom_fragment_gl;
+	mem[FragmentShaderId::Generic_ShapeVertexBloom].size = sizeof(Generic_ShapeVertexBloom_fragment_gl);
+	mem[FragmentShaderId::Generic_ShapeVertexDynamicLights].mem = Generic_ShapeVertexDynamicLights_fragment_gl;
+	mem[FragmentShaderId::Generic_ShapeVertexDynamicLights].size = sizeof(Generic_ShapeVertexDynamicLights_fragment_gl);
+	mem[FragmentShaderId::Generic_ShapeVertexBloomDynamicLights].mem = Generic_ShapeVertexBloomDynamicLights_fragment_gl;
+	mem[FragmentShaderId::Generic_ShapeVertexBloomDynamicLights].size = sizeof(Generic_ShapeVertexBloomDynamicLights_fragment_gl);
+	mem[FragmentShaderId::Luminance].mem = Luminance_fragment_gl;
+	mem[FragmentShaderId::Luminance].size = sizeof(Luminance_fragment_gl);
+	mem[FragmentShaderId::Sharpen].mem = Sharpen_fragment_gl;
+	mem[FragmentShaderId::Sharpen].size = sizeof(Sharpen_fragment_gl);
 	mem[FragmentShaderId::SMAABlendingWeightCalculation].mem = SMAABlendingWeightCalculation_fragment_gl;
 	mem[FragmentShaderId::SMAABlendingWeightCalculation].size = sizeof(SMAABlendingWeightCalculation_fragment_gl);
 	mem[FragmentShaderId::SMAAEdgeDetection].mem = SMAAEdgeDetection_fragment_gl;
 	mem[FragmentShaderId::SMAAEdgeDetection].size = sizeof(SMAAEdgeDetection_fragment_gl);
 	mem[FragmentShaderId::SMAANeighborhoodBlending].mem = SMAANeighborhoodBlending_fragment_gl;
 	mem[FragmentShaderId::SMAANeighborhoodBlending].size = sizeof(SMAANeighborhoodBlending_fragment_gl);
+	mem[FragmentShaderId::SMAANeighborhoodBlending_Bloom].mem = SMAANeighborhoodBlending_Bloom_fragment_gl;
+	mem[FragmentShaderId::SMAANeighborhoodBlending_Bloom].size = sizeof(SMAANeighborhoodBlending_Bloom_fragment_gl);
 	mem[FragmentShaderId::Texture].mem = Texture_fragment_gl;
 	mem[FragmentShaderId::Texture].size = sizeof(Texture_fragment_gl);
 	mem[FragmentShaderId::TextureColor].mem = TextureColor_fragment_gl;
@@ -155,10 +226,22 @@ static std::array<ShaderSourceMem, VertexShaderId::Num> GetVertexShaderSourceMap
 static std::array<ShaderSourceMem, FragmentShaderId::Num> GetFragmentShaderSourceMap_d3d11()
 {
 	std::array<ShaderSourceMem, FragmentShaderId::Num> mem;
-	mem[FragmentShaderId::Bloom].mem = Bloom_fragment_d3d11;
-	mem[FragmentShaderId::Bloom].size = sizeof(Bloom_fragment_d3d11);
+	mem[FragmentShaderId::BloomDownsample].mem = BloomDownsample_fragment_d3d11;
+	mem[FragmentShaderId::BloomDownsample].size = sizeof(BloomDownsample_fragment_d3d11);
+	mem[FragmentShaderId::BloomUpsample].mem = BloomUpsample_fragment_d3d11;
+	mem[FragmentShaderId::BloomUpsample].size = sizeof(BloomUpsample_fragment_d3d11);
 	mem[FragmentShaderId::Color].mem = Color_fragment_d3d11;
 	mem[FragmentShaderId::Color].size = sizeof(Color_fragment_d3d11);
+	mem[FragmentShaderId::Composite].mem = Composite_fragment_d3d11;
+	mem[FragmentShaderId::Composite].size = sizeof(Composite_fragment_d3d11);
+	mem[FragmentShaderId::Composite_Bloom].mem = Composite_Bloom_fragment_d3d11;
+	mem[FragmentShaderId::Composite_Bloom].size = sizeof(Composite_Bloom_fragment_d3d11);
+	mem[FragmentShaderId::Composite_ToneMap].mem = Composite_ToneMap_fragment_d3d11;
+	mem[FragmentShaderId::Composite_ToneMap].size = sizeof(Composite_ToneMap_fragment_d3d11);
+	mem[FragmentShaderId::Composite_BloomToneMap].mem = Composite_BloomToneMap_fragment_d3d11;
+	mem[FragmentShaderId::Composite_BloomToneMap].size = sizeof(Composite_BloomToneMap_fragment_d3d11);
+	mem[FragmentShaderId::DeferredLight].mem = DeferredLight_fragment_d3d11;
+	mem[FragmentShaderId::DeferredLight].size = sizeof(DeferredLight_fragment_d3d11);
 	mem[FragmentShaderId::Depth].mem = Depth_fragment_d3d11;
 	mem[FragmentShaderId::Depth].size = sizeof(Depth_fragment_d3d11);
 	mem[FragmentShaderId::Depth_AlphaTest].mem = Depth_AlphaTest_fragment_d3d11;
@@ -167,8 +250,8 @@ static std::array<ShaderSourceMem, FragmentShaderId::Num> GetFragmentShaderSourc
 	mem[FragmentShaderId::Fog].size = sizeof(Fog_fragment_d3d11);
 	mem[FragmentShaderId::Fog_Bloom].mem = Fog_Bloom_fragment_d3d11;
 	mem[FragmentShaderId::Fog_Bloom].size = sizeof(Fog_Bloom_fragment_d3d11);
-	mem[FragmentShaderId::GaussianBlur].mem = GaussianBlur_fragment_d3d11;
-	mem[FragmentShaderId::GaussianBlur].size = sizeof(GaussianBlur_fragment_d3d11);
+	mem[FragmentShaderId::GBuffer].mem = GBuffer_fragment_d3d11;
+	mem[FragmentShaderId::GBuffer].size = sizeof(GBuffer_fragment_d3d11);
 	mem[FragmentShaderId::Generic].mem = Generic_fragment_d3d11;
 	mem[FragmentShaderId::Generic].size = sizeof(Generic_fragment_d3d11);
 	mem[FragmentShaderId::Generic_AlphaTest].mem = Generic_AlphaTest_fragment_d3d11;
@@ -233,12 +316,66 @@ static std::array<ShaderSourceMem, FragmentShaderId::Num> GetFragmentShaderSourc
 	mem[FragmentShaderId::Generic_BloomDynamicLightsSoftSpriteSunLight].size = sizeof(Generic_BloomDynamicLightsSoftSpriteSunLight_fragment_d3d11);
 	mem[FragmentShaderId::Generic_AlphaTestBloomDynamicLightsSoftSpriteSunLight].mem = Generic_AlphaTestBloomDynamicLightsSoftSpriteSunLight_fragment_d3d11;
 	mem[FragmentShaderId::Generic_AlphaTestBloomDynamicLightsSoftSpriteSunLight].size = sizeof(Generic_AlphaTestBloomDynamicLightsSoftSpriteSunLight_fragment_d3d11);
+	mem[FragmentShaderId::Generic_ShapeMap].mem = Generic_ShapeMap_fragment_d3d11;
+	mem[FragmentShaderId::Generic_ShapeMap].size = sizeof(Generic_ShapeMap_fragment_d3d11);
+	mem[FragmentShaderId::Generic_ShapeMapBloom].mem = Generic_ShapeMapBloom_fragment_d3d11;
+	mem[FragmentShaderId::Generic_ShapeMapBloom].size = sizeof(Generic_ShapeMapBloom_fragment_d3d11);
+	mem[FragmentShaderId::Generic_ShapeMapDynamicLights].mem = Generic_ShapeMapDynamicLights_fragment_d3d11;
+	mem[FragmentShaderId::Generic_ShapeMapDynamicLights].size = sizeof(Generic_ShapeMapDynamicLights_fragment_d3d11);
+	mem[FragmentShaderId::Generic_ShapeMapBloomDynamicLights].mem = Generic_ShapeMapBloomDynamicLights_fragment_d3d11;
+	mem[FragmentShaderId::Generic_ShapeMapBloomDynamicLights].size = sizeof(Generic_ShapeMapBloomDynamicLights_fragment_d3d11);
+	mem[FragmentShaderId::Generic_ShapeMapAdd].mem = Generic_ShapeMapAdd_fragment_d3d11;
+	mem[FragmentShaderId::Generic_ShapeMapAdd].size = sizeof(Generic_ShapeMapAdd_fragment_d3d11);
+	mem[FragmentShaderId::Generic_ShapeMapAddBloom].mem = Generic_ShapeMapAddBloom_fragment_d3d11;
+	mem[FragmentShaderId::Generic_ShapeMapAddBloom].size = sizeof(Generic_ShapeMapAddBloom_fragment_d3d11);
+	mem[FragmentShaderId::Generic_ShapeMapAddDynamicLights].mem = Generic_ShapeMapAddDynamicLights_fragment_d3d11;
+	mem[FragmentShaderId::Generic_ShapeMapAddDynamicLights].size = sizeof(Generic_ShapeMapAddDynamicLights_fragment_d3d11);
+	mem[FragmentShaderId::Generic_ShapeMapAddBloomDynamicLights].mem = Generic_ShapeMapAddBloomDynamicLights_fragment_d3d11;
+	mem[FragmentShaderId::Generic_ShapeMapAddBloomDynamicLights].size = sizeof(Generic_ShapeMapAddBloomDynamicLights_fragment_d3d11);
+	mem[FragmentShaderId::Generic_ShapeUnlit].mem = Generic_ShapeUnlit_fragment_d3d11;
+	mem[FragmentShaderId::Generic_ShapeUnlit].size = sizeof(Generic_ShapeUnlit_fragment_d3d11);
+	mem[FragmentShaderId::Generic_ShapeUnlitBloom].mem = Generic_ShapeUnlitBloom_fragment_d3d11;
+	mem[FragmentShaderId::Generic_ShapeUnlitBloom].size = sizeof(Generic_ShapeUnlitBloom_fragment_d3d11);
+	mem[FragmentShaderId::Generic_ShapeUnlitDynamicLights].mem = Generic_ShapeUnlitDynamicLights_fragment_d3d11;
+	mem[FragmentShaderId::Generic_ShapeUnlitDynamicLights].size = sizeof(Generic_ShapeUnlitDynamicLights_fragment_d3d11);
+	mem[FragmentShaderId::Generic_ShapeUnlitBloomDynamicLights].mem = Generic_ShapeUnlitBloomDynamicLights_fragment_d3d11;
+	mem[FragmentShaderId::Generic_ShapeUnlitBloomDynamicLights].size = sizeof(Generic_ShapeUnlitBloomDynamicLights_fragment_d3d11);
+	mem[FragmentShaderId::Generic_ShapeVector].mem = Generic_ShapeVector_fragment_d3d11;
+	mem[FragmentShaderId::Generic_ShapeVector].size = sizeof(Generic_ShapeVector_fragment_d3d11);
+	mem[FragmentShaderId::Generic_ShapeVectorBloom].mem = Generic_ShapeVectorBloom_fragment_d3d11;
+	mem[FragmentShaderId::Generic_ShapeVectorBloom].size = sizeof(Generic_ShapeVectorBloom_fragment_d3d11);
+	mem[FragmentShaderId::Generic_ShapeVectorDynamicLights].mem = Generic_ShapeVectorDynamicLights_fragment_d3d11;
+	mem[FragmentShaderId::Generic_ShapeVectorDynamicLights].size = sizeof(Generic_ShapeVectorDynamicLights_fragment_d3d11);
+	mem[FragmentShaderId::Generic_ShapeVectorBloomDynamicLights].mem = Generic_ShapeVectorBloomDynamicLights_fragment_d3d11;
+	mem[FragmentShaderId::Generic_ShapeVectorBloomDynamicLights].size = sizeof(Generic_ShapeVectorBloomDynamicLights_fragment_d3d11);
+	mem[FragmentShaderId::Generic_ShapeVectorAdd].mem = Generic_ShapeVectorAdd_fragment_d3d11;
+	mem[FragmentShaderId::Generic_ShapeVectorAdd].size = sizeof(Generic_ShapeVectorAdd_fragment_d3d11);
+	mem[FragmentShaderId::Generic_ShapeVectorAddBloom].mem = Generic_ShapeVectorAddBloom_fragment_d3d11;
+	mem[FragmentShaderId::Generic_ShapeVectorAddBloom].size = sizeof(Generic_ShapeVectorAddBloom_fragment_d3d11);
+	mem[FragmentShaderId::Generic_ShapeVectorAddDynamicLights].mem = Generic_ShapeVectorAddDynamicLights_fragment_d3d11;
+	mem[FragmentShaderId::Generic_ShapeVectorAddDynamicLights].size = sizeof(Generic_ShapeVectorAddDynamicLights_fragment_d3d11);
+	mem[FragmentShaderId::Generic_ShapeVectorAddBloomDynamicLights].mem = Generic_ShapeVectorAddBloomDynamicLights_fragment_d3d11;
+	mem[FragmentShaderId::Generic_ShapeVectorAddBloomDynamicLights].size = sizeof(Generic_ShapeVectorAddBloomDynamicLights_fragment_d3d11);
+	mem[FragmentShaderId::Generic_ShapeVertex].mem = Generic_ShapeVertex_fragment_d3d11;
+	mem[FragmentShaderId::Generic_ShapeVertex].size = sizeof(Generic_ShapeVertex_fragment_d3d11);
+	mem[FragmentShaderId::Generic_ShapeVertexBloom].mem = Generic_ShapeVertexBloom_fragment_d3d11;
+	mem[FragmentShaderId::Generic_ShapeVertexBloom].size = sizeof(Generic_ShapeVertexBloom_fragment_d3d11);
+	mem[FragmentShaderId::Generic_ShapeVertexDynamicLights].mem = Generic_ShapeVertexDynamicLights_fragment_d3d11;
+	mem[FragmentShaderId::Generic_ShapeVertexDynamicLights].size = sizeof(Generic_ShapeVertexDynamicLights_fragment_d3d11);
+	mem[FragmentShaderId::Generic_ShapeVertexBloomDynamicLights].mem = Generic_ShapeVertexBloomDynamicLights_fragment_d3d11;
+	mem[FragmentShaderId::Generic_ShapeVertexBloomDynamicLights].size = sizeof(Generic_ShapeVertexBloomDynamicLights_fragment_d3d11);
+	mem[FragmentShaderId::Luminance].mem = Luminance_fragment_d3d11;
+	mem[FragmentShaderId::Luminance].size = sizeof(Luminance_fragment_d3d11);
+	mem[FragmentShaderId::Sharpen].mem = Sharpen_fragment_d3d11;
+	mem[FragmentShaderId::Sharpen].size = sizeof(Sharpen_fragment_d3d11);
 	mem[FragmentShaderId::SMAABlendingWeightCalculation].mem = SMAABlendingWeightCalculation_fragment_d3d11;
 	mem[FragmentShaderId::SMAABlendingWeightCalculation].size = sizeof(SMAABlendingWeightCalculation_fragment_d3d11);
 	mem[FragmentShaderId::SMAAEdgeDetection].mem = SMAAEdgeDetection_fragment_d3d11;
 	mem[FragmentShaderId::SMAAEdgeDetection].size = sizeof(SMAAEdgeDetection_fragment_d3d11);
 	mem[FragmentShaderId::SMAANeighborhoodBlending].mem = SMAANeighborhoodBlending_fragment_d3d11;
 	mem[FragmentShaderId::SMAANeighborhoodBlending].size = sizeof(SMAANeighborhoodBlending_fragment_d3d11);
+	mem[FragmentShaderId::SMAANeighborhoodBlending_Bloom].mem = SMAANeighborhoodBlending_Bloom_fragment_d3d11;
+	mem[FragmentShaderId::SMAANeighborhoodBlending_Bloom].size = sizeof(SMAANeighborhoodBlending_Bloom_fragment_d3d11);
 	mem[FragmentShaderId::Texture].mem = Texture_fragment_d3d11;
 	mem[FragmentShaderId::Texture].size = sizeof(Texture_fragment_d3d11);
 	mem[FragmentShaderId::TextureColor].mem = TextureColor_fragment_d3d11;
@@ -285,10 +422,22 @@ static std::array<ShaderSourceMem, VertexShaderId::Num> GetVertexShaderSourceMap
 static std::array<ShaderSourceMem, FragmentShaderId::Num> GetFragmentShaderSourceMap_vk()
 {
 	std::array<ShaderSourceMem, FragmentShaderId::Num> mem;
-	mem[FragmentShaderId::Bloom].mem = Bloom_fragment_vk;
-	mem[FragmentShaderId::Bloom].size = sizeof(Bloom_fragment_vk);
+	mem[FragmentShaderId::BloomDownsample].mem = BloomDownsample_fragment_vk;
+	mem[FragmentShaderId::BloomDownsample].size = sizeof(BloomDownsample_fragment_vk);
+	mem[FragmentShaderId::BloomUpsample].mem = BloomUpsample_fragment_vk;
+	mem[FragmentShaderId::BloomUpsample].size = sizeof(BloomUpsample_fragment_vk);
 	mem[FragmentShaderId::Color].mem = Color_fragment_vk;
 	mem[FragmentShaderId::Color].size = sizeof(Color_fragment_vk);
+	mem[FragmentShaderId::Composite].mem = Composite_fragment_vk;
+	mem[FragmentShaderId::Composite].size = sizeof(Composite_fragment_vk);
+	mem[FragmentShaderId::Composite_Bloom].mem = Composite_Bloom_fragment_vk;
+	mem[FragmentShaderId::Composite_Bloom].size = sizeof(Composite_Bloom_fragment_vk);
+	mem[FragmentShaderId::Composite_ToneMap].mem = Composite_ToneMap_fragment_vk;
+	mem[FragmentShaderId::Composite_ToneMap].size = sizeof(Composite_ToneMap_fragment_vk);
+	mem[FragmentShaderId::Composite_BloomToneMap].mem = Composite_BloomToneMap_fragment_vk;
+	mem[FragmentShaderId::Composite_BloomToneMap].size = sizeof(Composite_BloomToneMap_fragment_vk);
+	mem[FragmentShaderId::DeferredLight].mem = DeferredLight_fragment_vk;
+	mem[FragmentShaderId::DeferredLight].size = sizeof(DeferredLight_fragment_vk);
 	mem[FragmentShaderId::Depth].mem = Depth_fragment_vk;
 	mem[FragmentShaderId::Depth].size = sizeof(Depth_fragment_vk);
 	mem[FragmentShaderId::Depth_AlphaTest].mem = Depth_AlphaTest_fragment_vk;
@@ -297,8 +446,8 @@ static std::array<ShaderSourceMem, FragmentShaderId::Num> GetFragmentShaderSourc
 	mem[FragmentShaderId::Fog].size = sizeof(Fog_fragment_vk);
 	mem[FragmentShaderId::Fog_Bloom].mem = Fog_Bloom_fragment_vk;
 	mem[FragmentShaderId::Fog_Bloom].size = sizeof(Fog_Bloom_fragment_vk);
-	mem[FragmentShaderId::GaussianBlur].mem = GaussianBlur_fragment_vk;
-	mem[FragmentShaderId::GaussianBlur].size = sizeof(GaussianBlur_fragment_vk);
+	mem[FragmentShaderId::GBuffer].mem = GBuffer_fragment_vk;
+	mem[FragmentShaderId::GBuffer].size = sizeof(GBuffer_fragment_vk);
 	mem[FragmentShaderId::Generic].mem = Generic_fragment_vk;
 	mem[FragmentShaderId::Generic].size = sizeof(Generic_fragment_vk);
 	mem[FragmentShaderId::Generic_AlphaTest].mem = Generic_AlphaTest_fragment_vk;
@@ -363,12 +512,66 @@ static std::array<ShaderSourceMem, FragmentShaderId::Num> GetFragmentShaderSourc
 	mem[FragmentShaderId::Generic_BloomDynamicLightsSoftSpriteSunLight].size = sizeof(Generic_BloomDynamicLightsSoftSpriteSunLight_fragment_vk);
 	mem[FragmentShaderId::Generic_AlphaTestBloomDynamicLightsSoftSpriteSunLight].mem = Generic_AlphaTestBloomDynamicLightsSoftSpriteSunLight_fragment_vk;
 	mem[FragmentShaderId::Generic_AlphaTestBloomDynamicLightsSoftSpriteSunLight].size = sizeof(Generic_AlphaTestBloomDynamicLightsSoftSpriteSunLight_fragment_vk);
+	mem[FragmentShaderId::Generic_ShapeMap].mem = Generic_ShapeMap_fragment_vk;
+	mem[FragmentShaderId::Generic_ShapeMap].size = sizeof(Generic_ShapeMap_fragment_vk);
+	mem[FragmentShaderId::Generic_ShapeMapBloom].mem = Generic_ShapeMapBloom_fragment_vk;
+	mem[FragmentShaderId::Generic_ShapeMapBloom].size = sizeof(Generic_ShapeMapBloom_fragment_vk);
+	mem[FragmentShaderId::Generic_ShapeMapDynamicLights].mem = Generic_ShapeMapDynamicLights_fragment_vk;
+	mem[FragmentShaderId::Generic_ShapeMapDynamicLights].size = sizeof(Generic_ShapeMapDynamicLights_fragment_vk);
+	mem[FragmentShaderId::Generic_ShapeMapBloomDynamicLights].mem = Generic_ShapeMapBloomDynamicLights_fragment_vk;
+	mem[FragmentShaderId::Generic_ShapeMapBloomDynamicLights].size = sizeof(Generic_ShapeMapBloomDynamicLights_fragment_vk);
+	mem[FragmentShaderId::Generic_ShapeMapAdd].mem = Generic_ShapeMapAdd_fragment_vk;
+	mem[FragmentShaderId::Generic_ShapeMapAdd].size = sizeof(Generic_ShapeMapAdd_fragment_vk);
+	mem[FragmentShaderId::Generic_ShapeMapAddBloom].mem = Generic_ShapeMapAddBloom_fragment_vk;
+	mem[FragmentShaderId::Generic_ShapeMapAddBloom].size = sizeof(Generic_ShapeMapAddBloom_fragment_vk);
+	mem[FragmentShaderId::Generic_ShapeMapAddDynamicLights].mem = Generic_ShapeMapAddDynamicLights_fragment_vk;
+	mem[FragmentShaderId::Generic_ShapeMapAddDynamicLights].size = sizeof(Generic_ShapeMapAddDynamicLights_fragment_vk);
+	mem[FragmentShaderId::Generic_ShapeMapAddBloomDynamicLights].mem = Generic_ShapeMapAddBloomDynamicLights_fragment_vk;
+	mem[FragmentShaderId::Generic_ShapeMapAddBloomDynamicLights].size = sizeof(Generic_ShapeMapAddBloomDynamicLights_fragment_vk);
+	mem[FragmentShaderId::Generic_ShapeUnlit].mem = Generic_ShapeUnlit_fragment_vk;
+	mem[FragmentShaderId::Generic_ShapeUnlit].size = sizeof(Generic_ShapeUnlit_fragment_vk);
+	mem[FragmentShaderId::Generic_ShapeUnlitBloom].mem = Generic_ShapeUnlitBloom_fragment_vk;
+	mem[FragmentShaderId::Generic_ShapeUnlitBloom].size = sizeof(Generic_ShapeUnlitBloom_fragment_vk);
+	mem[FragmentShaderId::Generic_ShapeUnlitDynamicLights].mem = Generic_ShapeUnlitDynamicLights_fragment_vk;
+	mem[FragmentShaderId::Generic_ShapeUnlitDynamicLights].size = sizeof(Generic_ShapeUnlitDynamicLights_fragment_vk);
+	mem[FragmentShaderId::Generic_ShapeUnlitBloomDynamicLights].mem = Generic_ShapeUnlitBloomDynamicLights_fragment_vk;
+	mem[FragmentShaderId::Generic_ShapeUnlitBloomDynamicLights].size = sizeof(Generic_ShapeUnlitBloomDynamicLights_fragment_vk);
+	mem[FragmentShaderId::Generic_ShapeVector].mem = Generic_ShapeVector_fragment_vk;
+	mem[FragmentShaderId::Generic_ShapeVector].size = sizeof(Generic_ShapeVector_fragment_vk);
+	mem[FragmentShaderId::Generic_ShapeVectorBloom].mem = Generic_ShapeVectorBloom_fragment_vk;
+	mem[FragmentShaderId::Generic_ShapeVectorBloom].size = sizeof(Generic_ShapeVectorBloom_fragment_vk);
+	mem[FragmentShaderId::Generic_ShapeVectorDynamicLights].mem = Generic_ShapeVectorDynamicLights_fragment_vk;
+	mem[FragmentShaderId::Generic_ShapeVectorDynamicLights].size = sizeof(Generic_ShapeVectorDynamicLights_fragment_vk);
+	mem[FragmentShaderId::Generic_ShapeVectorBloomDynamicLights].mem = Generic_ShapeVectorBloomDynamicLights_fragment_vk;
+	mem[FragmentShaderId::Generic_ShapeVectorBloomDynamicLights].size = sizeof(Generic_ShapeVectorBloomDynamicLights_fragment_vk);
+	mem[FragmentShaderId::Generic_ShapeVectorAdd].mem = Generic_ShapeVectorAdd_fragment_vk;
+	mem[FragmentShaderId::Generic_ShapeVectorAdd].size = sizeof(Generic_ShapeVectorAdd_fragment_vk);
+	mem[FragmentShaderId::Generic_ShapeVectorAddBloom].mem = Generic_ShapeVectorAddBloom_fragment_vk;
+	mem[FragmentShaderId::Generic_ShapeVectorAddBloom].size = sizeof(Generic_ShapeVectorAddBloom_fragment_vk);
+	mem[FragmentShaderId::Generic_ShapeVectorAddDynamicLights].mem = Generic_ShapeVectorAddDynamicLights_fragment_vk;
+	mem[FragmentShaderId::Generic_ShapeVectorAddDynamicLights].size = sizeof(Generic_ShapeVectorAddDynamicLights_fragment_vk);
+	mem[FragmentShaderId::Generic_ShapeVectorAddBloomDynamicLights].mem = Generic_ShapeVectorAddBloomDynamicLights_fragment_vk;
+	mem[FragmentShaderId::Generic_ShapeVectorAddBloomDynamicLights].size = sizeof(Generic_ShapeVectorAddBloomDynamicLights_fragment_vk);
+	mem[FragmentShaderId::Generic_ShapeVertex].mem = Generic_ShapeVertex_fragment_vk;
+	mem[FragmentShaderId::Generic_ShapeVertex].size = sizeof(Generic_ShapeVertex_fragment_vk);
+	mem[FragmentShaderId::Generic_ShapeVertexBloom].mem = Generic_ShapeVertexBloom_fragment_vk;
+	mem[FragmentShaderId::Generic_ShapeVertexBloom].size = sizeof(Generic_ShapeVertexBloom_fragment_vk);
+	mem[FragmentShaderId::Generic_ShapeVertexDynamicLights].mem = Generic_ShapeVertexDynamicLights_fragment_vk;
+	mem[FragmentShaderId::Generic_ShapeVertexDynamicLights].size = sizeof(Generic_ShapeVertexDynamicLights_fragment_vk);
+	mem[FragmentShaderId::Generic_ShapeVertexBloomDynamicLights].mem = Generic_ShapeVertexBloomDynamicLights_fragment_vk;
+	mem[FragmentShaderId::Generic_ShapeVertexBloomDynamicLights].size = sizeof(Generic_ShapeVertexBloomDynamicLights_fragment_vk);
+	mem[FragmentShaderId::Luminance].mem = Luminance_fragment_vk;
+	mem[FragmentShaderId::Luminance].size = sizeof(Luminance_fragment_vk);
+	mem[FragmentShaderId::Sharpen].mem = Sharpen_fragment_vk;
+	mem[FragmentShaderId::Sharpen].size = sizeof(Sharpen_fragment_vk);
 	mem[FragmentShaderId::SMAABlendingWeightCalculation].mem = SMAABlendingWeightCalculation_fragment_vk;
 	mem[FragmentShaderId::SMAABlendingWeightCalculation].size = sizeof(SMAABlendingWeightCalculation_fragment_vk);
 	mem[FragmentShaderId::SMAAEdgeDetection].mem = SMAAEdgeDetection_fragment_vk;
 	mem[FragmentShaderId::SMAAEdgeDetection].size = sizeof(SMAAEdgeDetection_fragment_vk);
 	mem[FragmentShaderId::SMAANeighborhoodBlending].mem = SMAANeighborhoodBlending_fragment_vk;
 	mem[FragmentShaderId::SMAANeighborhoodBlending].size = sizeof(SMAANeighborhoodBlending_fragment_vk);
+	mem[FragmentShaderId::SMAANeighborhoodBlending_Bloom].mem = SMAANeighborhoodBlending_Bloom_fragment_vk;
+	mem[FragmentShaderId::SMAANeighborhoodBlending_Bloom].size = sizeof(SMAANeighborhoodBlending_Bloom_fragment_vk);
 	mem[FragmentShaderId::Texture].mem = Texture_fragment_vk;
 	mem[FragmentShaderId::Texture].size = sizeof(Texture_fragment_vk);
 	mem[FragmentShaderId::TextureColor].mem = TextureColor_fragment_vk;
@@ -2,13 +2,19 @@ struct FragmentShaderId
 {
 	enum Enum
 	{
-		Bloom,
+		BloomDownsample,
+		BloomUpsample,
 		Color,
+		Composite,
+		Composite_Bloom,
+		Composite_ToneMap,
+		Composite_BloomToneMap,
+		DeferredLight,
 		Depth,
 		Depth_AlphaTest,
 		Fog,
 		Fog_Bloom,
-		GaussianBlur,
+		GBuffer,
 		Generic,
 		Generic_AlphaTest,
 		Generic_Bloom,
@@ -41,9 +47,36 @@ struct FragmentShaderId
 		Generic_AlphaTestDynamicLightsSoftSpriteSunLight,
 		Generic_BloomDynamicLightsSoftSpriteSunLight,
 		Generic_AlphaTestBloomDynamicLightsSoftSpriteSunLight,
+		Generic_ShapeMap,
+		Generic_ShapeMapBloom,
+		Generic_ShapeMapDynamicLights,
+		Generic_ShapeMapBloomDynamicLights,
+		Generic_ShapeMapAdd,
+		Generic_ShapeMapAddBloom,
+		Generic_ShapeMapAddDynamicLights,
+		Generic_ShapeMapAddBloomDynamicLights,
+		Generic_ShapeUnlit,
+		Generic_ShapeUnlitBloom,
+		Generic_ShapeUnlitDynamicLights,
+		Generic_ShapeUnlitBloomDynamicLights,
+		Generic_ShapeVector,
+		Generic_ShapeVectorBloom,
+		Generic_ShapeVectorDynamicLights,
+		Generic_ShapeVectorBloomDynamicLights,
+		Generic_ShapeVectorAdd,
+		Generic_ShapeVectorAddBloom,
+		Generic_ShapeVectorAddDynamicLights,
+		Generic_ShapeVectorAddBloomDynamicLights,
+		Generic_ShapeVertex,
+		Generic_ShapeVertexBloom,
+		Generic_ShapeVertexDynamicLights,
+		Generic_ShapeVertexBloomDynamicLights,
+		Luminance,
+		Sharpen,
 		SMAABlendingWeightCalculation,
 		SMAAEdgeDetection,
 		SMAANeighborhoodBlending,
+		SMAANeighborhoodBlending_Bloom,
 		Texture,
 		TextureColor,
 		TextureDebug,
@@ -55,16 +88,21 @@ struct FragmentShaderId
 	};
 };
 
-#ifdef _DEBUG
-static const char *s_fragmentShaderNames[] =
+static const char * const s_fragmentShaderNames[] =
 {
-	"Bloom",
+	"BloomDownsample",
+	"BloomUpsample",
 	"Color",
+	"Composite",
+	"Composite_Bloom",
+	"Composite_ToneMap",
+	"Composite_BloomToneMap",
+	"DeferredLight",
 	"Depth",
 	"Depth_AlphaTest",
 	"Fog",
 	"Fog_Bloom",
-	"GaussianBlur",
+	"GBuffer",
 	"Generic",
 	"Generic_AlphaTest",
 	"Generic_Bloom",
@@ -97,9 +135,36 @@ static const char *s_fragmentShaderNames[] =
 	"Generic_AlphaTestDynamicLightsSoftSpriteSunLight",
 	"Generic_BloomDynamicLightsSoftSpriteSunLight",
 	"Generic_AlphaTestBloomDynamicLightsSoftSpriteSunLight",
+	"Generic_ShapeMap",
+	"Generic_ShapeMapBloom",
+	"Generic_ShapeMapDynamicLights",
+	"Generic_ShapeMapBloomDynamicLights",
+	"Generic_ShapeMapAdd",
+	"Generic_ShapeMapAddBloom",
+	"Generic_ShapeMapAddDynamicLights",
+	"Generic_ShapeMapAddBloomDynamicLights",
+	"Generic_ShapeUnlit",
+	"Generic_ShapeUnlitBloom",
+	"Generic_ShapeUnlitDynamicLights",
+	"Generic_ShapeUnlitBloomDynamicLights",
+	"Generic_ShapeVector",
+	"Generic_ShapeVectorBloom",
+	"Generic_ShapeVectorDynamicLights",
+	"Generic_ShapeVectorBloomDynamicLights",
+	"Generic_ShapeVectorAdd",
+	"Generic_ShapeVectorAddBloom",
+	"Generic_ShapeVectorAddDynamicLights",
+	"Generic_ShapeVectorAddBloomDynamicLights",
+	"Generic_ShapeVertex",
+	"Generic_ShapeVertexBloom",
+	"Generic_ShapeVertexDynamicLights",
+	"Generic_ShapeVertexBloomDynamicLights",
+	"Luminance",
+	"Sharpen",
 	"SMAABlendingWeightCalculation",
 	"SMAAEdgeDetection",
 	"SMAANeighborhoodBlending",
+	"SMAANeighborhoodBlending_Bloom",
 	"Texture",
 	"TextureColor",
 	"TextureDebug",
@@ -108,7 +173,6 @@ static const char *s_fragmentShaderNames[] =
 	"TextureVariation_SunLight",
 	"TextureVariation_BloomSunLight",
 };
-#endif
 
 struct VertexShaderId
 {
@@ -128,8 +192,7 @@ struct VertexShaderId
 	};
 };
 
-#ifdef _DEBUG
-static const char *s_vertexShaderNames[] =
+static const char * const s_vertexShaderNames[] =
 {
 	"Color",
 	"Depth",
@@ -142,7 +205,6 @@ static const char *s_vertexShaderNames[] =
 	"SMAANeighborhoodBlending",
 	"Texture",
 };
-#endif
 
 struct GenericFragmentShaderVariant
 {
@@ -194,3 +256,47 @@ struct TextureVariationFragmentShaderVariant
 	};
 };
 
+struct GenericShapeFragmentShaderVariant
+{
+	enum
+	{
+		Bloom = 1 << 0,
+		DynamicLights = 1 << 1,
+		Num = 1 << 2
+	};
+};
+
+struct MaterialShapeId
+{
+	enum Enum
+	{
+		Map,
+		MapAdd,
+		Unlit,
+		Vector,
+		VectorAdd,
+		Vertex,
+		Num
+	};
+};
+
+static const uint32_t s_materialShapeKeys[] =
+{
+	0x0001,
+	0x0111,
+	0x0000,
+	0x0004,
+	0x0114,
+	0x0003,
+};
+
+static const char * const s_materialShapeNames[] =
+{
+	"Map",
+	"MapAdd",
+	"Unlit",
+	"Vector",
+	"VectorAdd",
+	"Vertex",
+};
+